@@ -0,0 +1,1855 @@
+/*
+  Host benchmark for the vendored cJSON (main/cJSON.c).
+
+  Every *.json payload of the corpus directory, a few generated
+  reservation schedules and an array of 1000 random doubles are run
+  through parse, print, lookup, duplicate and delete, a parse into a
+  single arena block, plus the decode and push paths the HTTP task
+  uses and a parse into the read-only tape. Every member of flat
+  objects of 5, 50 and 500 members is looked up by the linear case
+  insensitive search and through the case sensitive hash index. The
+  response fields and one schedule entry are looked up by chained
+  cJSON_GetObjectItemCaseSensitive() calls and by queries compiled
+  once. The throughput of each scanning kernel shows in the parse,
+  push and print rows of about 64 KiB of whitespace between values, of
+  long plain strings and of strings dense with escapes. The typed
+  writer re-emits every payload, and the reservation request body is
+  built three ways: snprintf into a measured malloc, a tree printed
+  with cJSON, and the writer into a fixed buffer. Reading three fields
+  of each entry of a 1000 reservation schedule is timed with a full
+  parse against the on-demand cursor, and bringing a cached copy of it
+  up to date by parsing it again against a merge patch of one member.
+  Parsing and deleting one document at a time is timed through the
+  counting hooks and through a slab pool sized for that document in
+  front of them. Each row reports ns/op, document bytes/s, heap
+  allocations per op and the peak heap a single op needs on top of
+  what was live before it.
+
+  Before any of that, a few correctness checks run and a failing one
+  stops the benchmark: the offset every parse reports for invalid
+  escapes, keys given to arena items after the parse going with the
+  document, lookups through an object reference never using a stale
+  index, in a CJSON_BENCH_PROFILE build the profile counting every
+  allocation made on several threads at once, the push parser
+  building the same tree as cJSON_Parse for every corpus document
+  split at every byte offset and fed a byte at a time, the int64
+  limits printing as themselves, and random doubles printing as text
+  that reads back as the same double, the same text as before
+  wherever 15 digits read back too and no longer than the 17 digits
+  of before elsewhere. With -c only the checks run, which is what
+  ctest does.
+
+  At the end, the stack high-water mark of parse, print, duplicate,
+  compare and delete is taken on a painted thread stack, for a flat
+  response and for arrays and objects nested to CJSON_NESTING_LIMIT.
+
+  The allocations are counted through cJSON_InitHooks, which like any
+  custom hooks makes cJSON print without realloc. A CJSON_BENCH_PROFILE
+  build also prints cJSON's own per call site profile at the end.
+
+  usage: cjson_bench [-c] [-d corpus_dir] [-t milliseconds] [-o results.csv] [-b baseline.csv]
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <dirent.h>
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cJSON.h"
+
+#ifndef CJSON_BENCH_CORPUS
+#define CJSON_BENCH_CORPUS "corpus"
+#endif
+
+#define MAX_PAYLOADS 64
+#define MAX_RESULTS 512
+/* a timed batch never holds more than this many document bytes in trees */
+#define BATCH_BYTES (4UL << 20)
+/* bytes per string slot of the pool rows */
+#define POOL_STRING_SIZE 32
+/* chunk size handed to the push parser, about one small TCP segment */
+#define PUSH_CHUNK 64
+/* thread stack painted for the high-water marks, recursion at the nesting limit has to fit */
+/* doubles printed by the round trip check */
+#define ROUND_TRIP_NUMBERS 200000
+#define PROBE_STACK_SIZE (8UL << 20)
+#define PROBE_PAINT 0xA5
+
+typedef struct
+{
+    char name[64];
+    char *text;
+    size_t length;
+    cJSON *tree;
+    /* every (object, member name) pair of the tree, for the lookup op */
+    const cJSON **lookup_objects;
+    const char **lookup_names;
+    size_t lookups;
+} payload;
+
+typedef struct
+{
+    const char *name;
+    void (*setup)(payload *p, size_t count); /* untimed */
+    void (*run)(payload *p, size_t count);
+    void (*teardown)(payload *p, size_t count); /* untimed */
+} bench_op;
+
+typedef struct
+{
+    char payload[64];
+    char operation[16];
+    size_t bytes;
+    size_t ops;
+    double ns_per_op;
+    double bytes_per_s;
+    double allocs_per_op;
+    size_t peak_heap;
+} result;
+
+/* mirrors respData of httpTask.h */
+typedef struct
+{
+    int64_t serverTime;
+    int64_t unixStartTime;
+    int64_t unixEndTime;
+    int id;
+    int responseCode;
+    unsigned long fieldsFound;
+    char firstName[32];
+} response;
+
+static const cJSON_Field response_fields[] =
+{
+    {"id", cJSON_FieldInt, offsetof(response, id), 0},
+    {"responseCode", cJSON_FieldInt, offsetof(response, responseCode), 0},
+    {"serverTime", cJSON_FieldInt64, offsetof(response, serverTime), 0},
+    {"firstName", cJSON_FieldString, offsetof(response, firstName), 32},
+    {"unixStartTime", cJSON_FieldInt64, offsetof(response, unixStartTime), 0},
+    {"unixEndTime", cJSON_FieldInt64, offsetof(response, unixEndTime), 0},
+};
+
+/* counting allocator */
+
+typedef union
+{
+    size_t size;
+    long double align;
+    void *pointer;
+} allocation_header;
+
+static size_t heap_allocations;
+static size_t heap_live;
+static size_t heap_peak;
+/* set while several threads allocate, the timed runs don't pay for the mutex */
+static int heap_shared;
+static pthread_mutex_t heap_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void *bench_malloc(size_t size)
+{
+    allocation_header *header = (allocation_header*)malloc(sizeof(allocation_header) + size);
+    if (header == NULL)
+    {
+        return NULL;
+    }
+    header->size = size;
+
+    if (heap_shared)
+    {
+        pthread_mutex_lock(&heap_mutex);
+    }
+    heap_allocations++;
+    heap_live += size;
+    if (heap_live > heap_peak)
+    {
+        heap_peak = heap_live;
+    }
+    if (heap_shared)
+    {
+        pthread_mutex_unlock(&heap_mutex);
+    }
+
+    return header + 1;
+}
+
+static void bench_free(void *pointer)
+{
+    allocation_header *header = NULL;
+    if (pointer == NULL)
+    {
+        return;
+    }
+
+    header = (allocation_header*)pointer - 1;
+    if (heap_shared)
+    {
+        pthread_mutex_lock(&heap_mutex);
+    }
+    heap_live -= header->size;
+    if (heap_shared)
+    {
+        pthread_mutex_unlock(&heap_mutex);
+    }
+    free(header);
+}
+
+static cJSON_Hooks bench_hooks = { bench_malloc, bench_free };
+
+/* trees built or consumed by a batch, held with the plain allocator */
+static cJSON **trees;
+static cJSON_Tape **tapes;
+static size_t trees_size;
+static cJSON_PushParser *push_parser;
+static char *write_buffer;
+static size_t write_buffer_size;
+static volatile size_t sink;
+
+static void reserve_trees(size_t count)
+{
+    if (count > trees_size)
+    {
+        trees = (cJSON**)realloc(trees, count * sizeof(cJSON*));
+        tapes = (cJSON_Tape**)realloc(tapes, count * sizeof(cJSON_Tape*));
+        if ((trees == NULL) || (tapes == NULL))
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+        trees_size = count;
+    }
+}
+
+static void delete_trees(payload *p, size_t count)
+{
+    size_t i = 0;
+    (void)p;
+    for (i = 0; i < count; i++)
+    {
+        cJSON_Delete(trees[i]);
+    }
+}
+
+static void parse_trees(payload *p, size_t count)
+{
+    size_t i = 0;
+    reserve_trees(count);
+    for (i = 0; i < count; i++)
+    {
+        trees[i] = cJSON_ParseWithLength(p->text, p->length);
+    }
+}
+
+static void run_parse(payload *p, size_t count)
+{
+    parse_trees(p, count);
+}
+
+/* the whole document in one arena block sized by cJSON_ArenaSizeFor */
+static void run_arena(payload *p, size_t count)
+{
+    size_t i = 0;
+    reserve_trees(count);
+    for (i = 0; i < count; i++)
+    {
+        trees[i] = cJSON_ParseWithLengthArena(p->text, p->length, NULL, 0);
+    }
+}
+
+static void setup_duplicate(payload *p, size_t count)
+{
+    (void)p;
+    reserve_trees(count);
+}
+
+static void run_duplicate(payload *p, size_t count)
+{
+    size_t i = 0;
+    for (i = 0; i < count; i++)
+    {
+        trees[i] = cJSON_Duplicate(p->tree, 1);
+    }
+}
+
+/* parse and delete one document at a time, through the counting hooks or the pool in front of them */
+static void run_cycle(payload *p, size_t count)
+{
+    size_t i = 0;
+    for (i = 0; i < count; i++)
+    {
+        cJSON_Delete(cJSON_ParseWithLength(p->text, p->length));
+    }
+}
+
+static void count_slots(const cJSON *item, cJSON_PoolConfig *config)
+{
+    for (; item != NULL; item = item->next)
+    {
+        config->node_count++;
+        if ((item->string != NULL) && (strlen(item->string) < config->string_size))
+        {
+            config->string_count++;
+        }
+        if (cJSON_IsString(item) && (strlen(item->valuestring) < config->string_size))
+        {
+            config->string_count++;
+        }
+        count_slots(item->child, config);
+    }
+}
+
+/* a pool with a slot for every item and short string of one document, its memory taken outside the timed op */
+static void setup_pool(payload *p, size_t count)
+{
+    cJSON_PoolConfig config;
+
+    (void)count;
+    memset(&config, 0, sizeof(config));
+    config.string_size = POOL_STRING_SIZE;
+    count_slots(p->tree, &config);
+    /* the payload trees were allocated before, the pool hands them back to the counting hooks */
+    if (!cJSON_InitHooksWithPool(&bench_hooks, &config))
+    {
+        fprintf(stderr, "no pool for %s, the pool row is without it\n", p->name);
+    }
+}
+
+static void remove_pool(payload *p, size_t count)
+{
+    (void)p;
+    (void)count;
+    cJSON_InitHooks(&bench_hooks);
+}
+
+static void run_delete(payload *p, size_t count)
+{
+    delete_trees(p, count);
+}
+
+static void run_tape(payload *p, size_t count)
+{
+    size_t i = 0;
+    reserve_trees(count);
+    for (i = 0; i < count; i++)
+    {
+        tapes[i] = cJSON_ParseTape(p->text, p->length);
+    }
+}
+
+static void delete_tapes(payload *p, size_t count)
+{
+    size_t i = 0;
+    (void)p;
+    for (i = 0; i < count; i++)
+    {
+        cJSON_DeleteTape(tapes[i]);
+    }
+}
+
+static void run_print(payload *p, size_t count)
+{
+    size_t i = 0;
+    for (i = 0; i < count; i++)
+    {
+        char *printed = cJSON_PrintUnformatted(p->tree);
+        sink += (printed != NULL);
+        cJSON_free(printed);
+    }
+}
+
+static void run_lookup(payload *p, size_t count)
+{
+    size_t i = 0;
+    size_t j = 0;
+    for (i = 0; i < count; i++)
+    {
+        for (j = 0; j < p->lookups; j++)
+        {
+            sink += (cJSON_GetObjectItemCaseSensitive(p->lookup_objects[j], p->lookup_names[j]) != NULL);
+        }
+    }
+}
+
+static void run_decode(payload *p, size_t count)
+{
+    size_t i = 0;
+    response decoded;
+    for (i = 0; i < count; i++)
+    {
+        sink += (size_t)cJSON_DecodeObject(p->text, p->length, response_fields,
+            sizeof(response_fields) / sizeof(response_fields[0]), &decoded, &decoded.fieldsFound);
+    }
+}
+
+/* the response fields plus one schedule entry, by chained lookups and by compiled queries */
+
+static const char * const query_paths[] =
+{
+    "/id", "/responseCode", "/serverTime", "/firstName", "/unixStartTime", "/unixEndTime",
+    "/schedule/50/accessCode"
+};
+#define QUERY_COUNT (sizeof(query_paths) / sizeof(query_paths[0]))
+
+static cJSON_Query queries[QUERY_COUNT];
+
+static void run_chained(payload *p, size_t count)
+{
+    size_t i = 0;
+    size_t j = 0;
+    for (i = 0; i < count; i++)
+    {
+        for (j = 0; j < (sizeof(response_fields) / sizeof(response_fields[0])); j++)
+        {
+            sink += (cJSON_GetObjectItemCaseSensitive(p->tree, response_fields[j].name) != NULL);
+        }
+        sink += (cJSON_GetObjectItemCaseSensitive(cJSON_GetArrayItem(cJSON_GetObjectItemCaseSensitive(p->tree, "schedule"), 50), "accessCode") != NULL);
+    }
+}
+
+static void run_query(payload *p, size_t count)
+{
+    size_t i = 0;
+    size_t j = 0;
+    for (i = 0; i < count; i++)
+    {
+        for (j = 0; j < QUERY_COUNT; j++)
+        {
+            sink += (cJSON_GetQueryItem(p->tree, &queries[j]) != NULL);
+        }
+    }
+}
+
+static void run_push(payload *p, size_t count)
+{
+    size_t i = 0;
+    size_t offset = 0;
+    for (i = 0; i < count; i++)
+    {
+        for (offset = 0; offset < p->length; offset += PUSH_CHUNK)
+        {
+            size_t length = ((p->length - offset) < PUSH_CHUNK) ? (p->length - offset) : PUSH_CHUNK;
+            cJSON_PushParserFeed(push_parser, p->text + offset, length);
+        }
+        cJSON_Delete(cJSON_PushParserFinish(push_parser));
+    }
+}
+
+static cJSON_bool write_item(cJSON_Writer *writer, const cJSON *item)
+{
+    const cJSON *child = NULL;
+
+    if (item->string != NULL)
+    {
+        cJSON_WriteKey(writer, item->string);
+    }
+    if (cJSON_IsObject(item) || cJSON_IsArray(item))
+    {
+        if (cJSON_IsObject(item) ? !cJSON_WriteBeginObject(writer) : !cJSON_WriteBeginArray(writer))
+        {
+            return 0;
+        }
+        for (child = item->child; child != NULL; child = child->next)
+        {
+            if (!write_item(writer, child))
+            {
+                return 0;
+            }
+        }
+        return cJSON_IsObject(item) ? cJSON_WriteEndObject(writer) : cJSON_WriteEndArray(writer);
+    }
+    if (cJSON_IsString(item))
+    {
+        return cJSON_WriteString(writer, item->valuestring);
+    }
+    if (cJSON_IsNumber(item))
+    {
+        return cJSON_WriteNumber(writer, item->valuedouble);
+    }
+    if (cJSON_IsBool(item))
+    {
+        return cJSON_WriteBool(writer, cJSON_IsTrue(item));
+    }
+
+    return cJSON_WriteNull(writer);
+}
+
+static void setup_write(payload *p, size_t count)
+{
+    (void)count;
+    /* the compact text is never longer than the payload plus its escapes */
+    if (write_buffer_size < (2 * p->length) + 64)
+    {
+        write_buffer_size = (2 * p->length) + 64;
+        write_buffer = (char*)realloc(write_buffer, write_buffer_size);
+    }
+}
+
+static void run_write(payload *p, size_t count)
+{
+    size_t i = 0;
+    cJSON_Writer writer;
+    for (i = 0; i < count; i++)
+    {
+        cJSON_WriterInit(&writer, write_buffer, write_buffer_size);
+        write_item(&writer, p->tree);
+        sink += cJSON_WriterFinish(&writer);
+    }
+}
+
+/* the reservation request body of parsingTask.c */
+
+#define BODY_KEY "unixStartTime"
+#define BODY_TIME ((int64_t)1700000000)
+#define BODY_TEXT "{\"" BODY_KEY "\":\"1700000000\"}"
+
+static void run_body_snprintf(payload *p, size_t count)
+{
+    size_t i = 0;
+    (void)p;
+    for (i = 0; i < count; i++)
+    {
+        size_t length = (size_t)snprintf(NULL, 0, "{\"" BODY_KEY "\": \"%lld\"}", (long long)BODY_TIME) + 1;
+        char *body = (char*)cJSON_malloc(length);
+        if (body != NULL)
+        {
+            sink += (size_t)snprintf(body, length, "{\"" BODY_KEY "\": \"%lld\"}", (long long)BODY_TIME);
+        }
+        cJSON_free(body);
+    }
+}
+
+static void run_body_tree(payload *p, size_t count)
+{
+    size_t i = 0;
+    char number[24];
+    (void)p;
+    for (i = 0; i < count; i++)
+    {
+        cJSON *body = cJSON_CreateObject();
+        char *printed = NULL;
+        snprintf(number, sizeof(number), "%lld", (long long)BODY_TIME);
+        cJSON_AddStringToObject(body, BODY_KEY, number);
+        printed = cJSON_PrintUnformatted(body);
+        sink += (printed != NULL);
+        cJSON_free(printed);
+        cJSON_Delete(body);
+    }
+}
+
+static void run_body_writer(payload *p, size_t count)
+{
+    size_t i = 0;
+    char body[48];
+    cJSON_Writer writer;
+    (void)p;
+    for (i = 0; i < count; i++)
+    {
+        cJSON_WriterInit(&writer, body, sizeof(body));
+        cJSON_WriteBeginObject(&writer);
+        cJSON_WriteKey(&writer, BODY_KEY);
+        cJSON_WriteInt64String(&writer, BODY_TIME);
+        cJSON_WriteEndObject(&writer);
+        sink += cJSON_WriterFinish(&writer);
+    }
+}
+
+static const bench_op body_operations[] =
+{
+    {"snprintf", NULL, run_body_snprintf, NULL},
+    {"tree", NULL, run_body_tree, NULL},
+    {"writer", NULL, run_body_writer, NULL},
+};
+
+/* three fields of every reservation in a schedule, the way a whole-day list is read */
+
+static void run_extract_tree(payload *p, size_t count)
+{
+    size_t i = 0;
+    for (i = 0; i < count; i++)
+    {
+        cJSON *root = cJSON_ParseWithLength(p->text, p->length);
+        const cJSON *entry = NULL;
+        cJSON_ArrayForEach(entry, cJSON_GetObjectItemCaseSensitive(root, "schedule"))
+        {
+            const char *code = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(entry, "accessCode"));
+            sink += (size_t)cJSON_GetInt64Value(cJSON_GetObjectItemCaseSensitive(entry, "unixStartTime"));
+            sink += (size_t)cJSON_GetInt64Value(cJSON_GetObjectItemCaseSensitive(entry, "unixEndTime"));
+            sink += (code != NULL) ? (size_t)code[0] : 0;
+        }
+        cJSON_Delete(root);
+    }
+}
+
+static void run_extract_cursor(payload *p, size_t count)
+{
+    size_t i = 0;
+    char code[8];
+    for (i = 0; i < count; i++)
+    {
+        cJSON_Cursor root = cJSON_CursorRoot(p->text, p->length);
+        cJSON_Cursor entry = cJSON_CursorChild(cJSON_CursorGetObjectItemCaseSensitive(root, "schedule"));
+        for (; entry.json != NULL; entry = cJSON_CursorNext(entry))
+        {
+            /* the members are searched in the order the server sends them */
+            cJSON_Cursor member = cJSON_CursorGetObjectItemCaseSensitive(entry, "unixStartTime");
+            sink += (size_t)cJSON_CursorGetInt64Value(member);
+            member = cJSON_CursorFindCaseSensitive(member, "unixEndTime");
+            sink += (size_t)cJSON_CursorGetInt64Value(member);
+            member = cJSON_CursorFindCaseSensitive(member, "accessCode");
+            sink += (cJSON_CursorGetString(member, code, sizeof(code)) != NULL) ? (size_t)code[0] : 0;
+        }
+    }
+}
+
+/* every member of a flat object looked up by name, by the linear search and through the object's hash index */
+
+static void run_lookup_linear(payload *p, size_t count)
+{
+    size_t i = 0;
+    size_t j = 0;
+    for (i = 0; i < count; i++)
+    {
+        for (j = 0; j < p->lookups; j++)
+        {
+            /* case insensitive lookups never use the index */
+            sink += (cJSON_GetObjectItem(p->lookup_objects[j], p->lookup_names[j]) != NULL);
+        }
+    }
+}
+
+static const bench_op key_operations[] =
+{
+    {"linear", NULL, run_lookup_linear, NULL},
+    {"indexed", NULL, run_lookup, NULL},
+};
+
+static const bench_op extract_operations[] =
+{
+    {"tree", NULL, run_extract_tree, NULL},
+    {"cursor", NULL, run_extract_cursor, NULL},
+};
+
+/* a cached schedule brought up to date by fetching it again, or by a merge patch of the one member that changed */
+
+static cJSON *merge_patches[2];
+static size_t merge_changes;
+
+static void count_change(const char *path, int change, void *context)
+{
+    (void)path;
+    (void)context;
+    merge_changes += (size_t)change;
+}
+
+static void run_refetch(payload *p, size_t count)
+{
+    size_t i = 0;
+    for (i = 0; i < count; i++)
+    {
+        cJSON_Delete(cJSON_ParseWithLength(p->text, p->length));
+    }
+}
+
+static void run_merge(payload *p, size_t count)
+{
+    size_t i = 0;
+    for (i = 0; i < count; i++)
+    {
+        /* the patches alternate, so every one of them changes the tree */
+        sink += (size_t)cJSON_ApplyMergePatch(&p->tree, merge_patches[i & 1], count_change, NULL);
+    }
+}
+
+static const bench_op patch_operations[] =
+{
+    {"refetch", NULL, run_refetch, NULL},
+    {"merge", NULL, run_merge, NULL},
+};
+
+/* the paths through the scanning kernels: whitespace and string bodies on parse, escapes on print */
+static const bench_op scan_operations[] =
+{
+    {"parse", NULL, run_parse, delete_trees},
+    {"push", NULL, run_push, NULL},
+    {"print", NULL, run_print, NULL},
+};
+
+static const bench_op operations[] =
+{
+    {"parse", NULL, run_parse, delete_trees},
+    {"arena", NULL, run_arena, delete_trees},
+    {"print", NULL, run_print, NULL},
+    {"lookup", NULL, run_lookup, NULL},
+    {"chained", NULL, run_chained, NULL},
+    {"query", NULL, run_query, NULL},
+    {"duplicate", setup_duplicate, run_duplicate, delete_trees},
+    {"delete", parse_trees, run_delete, NULL},
+    {"decode", NULL, run_decode, NULL},
+    {"push", NULL, run_push, NULL},
+    {"tape", NULL, run_tape, delete_tapes},
+    {"write", setup_write, run_write, NULL},
+    {"cycle", NULL, run_cycle, NULL},
+    {"pool", setup_pool, run_cycle, remove_pool},
+};
+
+static double now_ns(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return ((double)time.tv_sec * 1e9) + (double)time.tv_nsec;
+}
+
+static void measure(payload *p, const bench_op *op, double min_ns, result *r)
+{
+    size_t batch = 1;
+    size_t max_batch = BATCH_BYTES / (p->length + 1);
+    size_t allocations = 0;
+    size_t allocations_before = 0;
+    size_t live = 0;
+    double elapsed = 0;
+    double start = 0;
+    double batch_ns = 0;
+
+    memset(r, 0, sizeof(result));
+    snprintf(r->payload, sizeof(r->payload), "%s", p->name);
+    snprintf(r->operation, sizeof(r->operation), "%s", op->name);
+    r->bytes = p->length;
+    if (max_batch == 0)
+    {
+        max_batch = 1;
+    }
+
+    /* a single untimed op for the peak heap, which also warms the caches */
+    if (op->setup != NULL)
+    {
+        op->setup(p, 1);
+    }
+    live = heap_live;
+    heap_peak = heap_live;
+    op->run(p, 1);
+    r->peak_heap = heap_peak - live;
+    if (op->teardown != NULL)
+    {
+        op->teardown(p, 1);
+    }
+
+    while (elapsed < min_ns)
+    {
+        if (op->setup != NULL)
+        {
+            op->setup(p, batch);
+        }
+        allocations_before = heap_allocations;
+        start = now_ns();
+        op->run(p, batch);
+        batch_ns = now_ns() - start;
+        allocations += heap_allocations - allocations_before;
+        if (op->teardown != NULL)
+        {
+            op->teardown(p, batch);
+        }
+
+        elapsed += batch_ns;
+        r->ops += batch;
+        if ((batch_ns < (min_ns / 20)) && (batch < max_batch))
+        {
+            batch *= 2;
+        }
+    }
+
+    r->ns_per_op = elapsed / (double)r->ops;
+    r->bytes_per_s = (double)p->length * 1e9 / r->ns_per_op;
+    r->allocs_per_op = (double)allocations / (double)r->ops;
+}
+
+/* payloads */
+
+/* objects big enough for it get their hash index here, the lookups only read it */
+static void collect_lookups(payload *p, cJSON *item)
+{
+    cJSON *child = NULL;
+
+    cJSON_IndexObject(item);
+    for (child = item->child; child != NULL; child = child->next)
+    {
+        if (cJSON_IsObject(item))
+        {
+            p->lookup_objects = (const cJSON**)realloc((void*)p->lookup_objects, (p->lookups + 1) * sizeof(cJSON*));
+            p->lookup_names = (const char**)realloc((void*)p->lookup_names, (p->lookups + 1) * sizeof(char*));
+            p->lookup_objects[p->lookups] = item;
+            p->lookup_names[p->lookups] = child->string;
+            p->lookups++;
+        }
+        collect_lookups(p, child);
+    }
+}
+
+static int add_payload(payload *payloads, size_t *count, const char *name, char *text, size_t length)
+{
+    payload *p = &payloads[*count];
+
+    if (*count >= MAX_PAYLOADS)
+    {
+        fprintf(stderr, "too many payloads, skipping %s\n", name);
+        free(text);
+        return 0;
+    }
+
+    memset(p, 0, sizeof(payload));
+    snprintf(p->name, sizeof(p->name), "%s", name);
+    p->text = text;
+    p->length = length;
+    p->tree = cJSON_ParseWithLength(text, length);
+    if (p->tree == NULL)
+    {
+        fprintf(stderr, "%s is not valid JSON, skipping it\n", name);
+        free(text);
+        return 0;
+    }
+    collect_lookups(p, p->tree);
+    (*count)++;
+
+    return 1;
+}
+
+static int compare_names(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+static void load_corpus(const char *directory, payload *payloads, size_t *count)
+{
+    char *names[MAX_PAYLOADS];
+    size_t name_count = 0;
+    size_t i = 0;
+    struct dirent *entry = NULL;
+    DIR *dir = opendir(directory);
+
+    if (dir == NULL)
+    {
+        fprintf(stderr, "can't open corpus directory %s\n", directory);
+        return;
+    }
+    while (((entry = readdir(dir)) != NULL) && (name_count < MAX_PAYLOADS))
+    {
+        size_t length = strlen(entry->d_name);
+        if ((length > 5) && (strcmp(entry->d_name + length - 5, ".json") == 0))
+        {
+            names[name_count++] = strdup(entry->d_name);
+        }
+    }
+    closedir(dir);
+    qsort(names, name_count, sizeof(char*), compare_names);
+
+    for (i = 0; i < name_count; i++)
+    {
+        char path[1024];
+        char *text = NULL;
+        long length = 0;
+        FILE *file = NULL;
+
+        snprintf(path, sizeof(path), "%s/%s", directory, names[i]);
+        file = fopen(path, "rb");
+        if ((file != NULL) && (fseek(file, 0, SEEK_END) == 0) && ((length = ftell(file)) >= 0) && (fseek(file, 0, SEEK_SET) == 0))
+        {
+            text = (char*)malloc((size_t)length + 1);
+            if ((text != NULL) && (fread(text, 1, (size_t)length, file) == (size_t)length))
+            {
+                text[length] = '\0';
+                names[i][strlen(names[i]) - 5] = '\0';
+                add_payload(payloads, count, names[i], text, (size_t)length);
+                text = NULL;
+            }
+            free(text);
+        }
+        else
+        {
+            fprintf(stderr, "can't read %s\n", path);
+        }
+        if (file != NULL)
+        {
+            fclose(file);
+        }
+        free(names[i]);
+    }
+}
+
+/* a reserve/ style response carrying a whole schedule of reservations */
+static void add_schedule(payload *payloads, size_t *count, unsigned int reservations)
+{
+    size_t size = 64 + ((size_t)reservations * 128);
+    size_t length = 0;
+    unsigned int i = 0;
+    char name[32];
+    char *text = (char*)malloc(size);
+
+    if (text == NULL)
+    {
+        return;
+    }
+
+    length += (size_t)sprintf(text, "{\"id\": 1, \"responseCode\": 1, \"schedule\": [");
+    for (i = 0; i < reservations; i++)
+    {
+        unsigned long start = 1712347200UL + (i * 3600UL);
+        length += (size_t)sprintf(text + length,
+            "%s{\"firstName\": \"Guest%04u\", \"room\": %u, \"unixStartTime\": %lu, \"unixEndTime\": %lu, \"accessCode\": \"%06u\"}",
+            (i > 0) ? ", " : "", i, 100 + (i % 40), start, start + 3000UL, (i * 7919U) % 1000000U);
+    }
+    length += (size_t)sprintf(text + length, "]}");
+
+    snprintf(name, sizeof(name), "schedule_%u", reservations);
+    add_payload(payloads, count, name, text, length);
+}
+
+/* a flat object of numbered members */
+static void add_object(payload *payloads, size_t *count, unsigned int members)
+{
+    size_t size = 16 + ((size_t)members * 24);
+    size_t length = 0;
+    unsigned int i = 0;
+    char name[32];
+    char *text = (char*)malloc(size);
+
+    if (text == NULL)
+    {
+        return;
+    }
+
+    length += (size_t)sprintf(text, "{");
+    for (i = 0; i < members; i++)
+    {
+        length += (size_t)sprintf(text + length, "%s\"member%04u\": %u", (i > 0) ? ", " : "", i, i);
+    }
+    length += (size_t)sprintf(text + length, "}");
+
+    snprintf(name, sizeof(name), "keys_%u", members);
+    add_payload(payloads, count, name, text, length);
+}
+
+/* xorshift64, the generated doubles are the same on every run */
+static uint64_t random_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t next_random(void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return random_state;
+}
+
+/* every other one a random bit pattern, the rest readings with up to six decimals, never inf or nan */
+static double next_double(void)
+{
+    static const double scales[] = { 1, 10, 100, 1000, 1e4, 1e5, 1e6 };
+    uint64_t bits = next_random();
+    double number = 0;
+
+    if (bits & 1)
+    {
+        memcpy(&number, &bits, sizeof(number));
+        if (isfinite(number))
+        {
+            return number;
+        }
+    }
+    return (double)((long)(bits >> 40) - 8388608L) / scales[(bits >> 8) % 7];
+}
+
+/* an array of doubles written with %.17g */
+static void add_doubles(payload *payloads, size_t *count, unsigned int numbers)
+{
+    size_t size = 16 + ((size_t)numbers * 28);
+    size_t length = 0;
+    unsigned int i = 0;
+    char name[32];
+    char *text = (char*)malloc(size);
+
+    if (text == NULL)
+    {
+        return;
+    }
+
+    length += (size_t)sprintf(text, "[");
+    for (i = 0; i < numbers; i++)
+    {
+        length += (size_t)sprintf(text + length, "%s%.17g", (i > 0) ? ", " : "", next_double());
+    }
+    length += (size_t)sprintf(text + length, "]");
+
+    snprintf(name, sizeof(name), "doubles_%u", numbers);
+    add_payload(payloads, count, name, text, length);
+}
+
+/* about 64 KiB that keeps one of cJSON's scanning kernels busy: values apart by runs of
+   whitespace, long plain strings, or strings with an escape every few bytes */
+static void add_scan(payload *payloads, size_t *count, const char *name)
+{
+    static const char whitespace[] = " \t\r\n        \n\t\t\t\t        \r\n                        \n";
+    static const char plain[] = "The quick brown fox jumps over the lazy dog, room 214 at 10:30. ";
+    static const char escaped[] = "a\\\"b\\nc\\td\\\\e\\u00e9f\\/g\\rh\\bij";
+    size_t size = 70000;
+    size_t length = 0;
+    size_t i = 0;
+    char *text = (char*)malloc(size);
+
+    if (text == NULL)
+    {
+        return;
+    }
+
+    text[length++] = '[';
+    for (i = 0; length < (size - 2048); i++)
+    {
+        size_t run = 0;
+        if (strcmp(name, "whitespace") == 0)
+        {
+            length += (size_t)sprintf(text + length, "%s%lu", (i > 0) ? "," : "", (unsigned long)i);
+            for (run = 0; run < 4; run++)
+            {
+                length += (size_t)sprintf(text + length, "%s", whitespace);
+            }
+        }
+        else
+        {
+            length += (size_t)sprintf(text + length, "%s\"", (i > 0) ? "," : "");
+            for (run = 0; run < 16; run++)
+            {
+                length += (size_t)sprintf(text + length, "%s", (strcmp(name, "strings") == 0) ? plain : escaped);
+            }
+            text[length++] = '"';
+        }
+    }
+    text[length++] = ']';
+    text[length] = '\0';
+
+    add_payload(payloads, count, name, text, length);
+}
+
+/* stack high-water marks */
+
+typedef struct
+{
+    const char *text;
+    size_t length;
+    cJSON *tree;
+    cJSON *copy; /* equal to tree but not the same items, for compare */
+    cJSON *victim; /* tree handed to delete */
+    int operation;
+} probe;
+
+static const char * const probe_operations[] = { "parse", "print", "format", "duplicate", "compare", "delete" };
+#define PROBE_OPERATIONS (sizeof(probe_operations) / sizeof(probe_operations[0]))
+
+static void *run_probe(void *argument)
+{
+    probe *p = (probe*)argument;
+    char *printed = NULL;
+
+    switch (p->operation)
+    {
+        case 0:
+            cJSON_Delete(cJSON_ParseWithLength(p->text, p->length));
+            break;
+        case 1:
+        case 2:
+            printed = (p->operation == 1) ? cJSON_PrintUnformatted(p->tree) : cJSON_Print(p->tree);
+            sink += (printed != NULL);
+            cJSON_free(printed);
+            break;
+        case 3:
+            cJSON_Delete(cJSON_Duplicate(p->tree, 1));
+            break;
+        case 4:
+            sink += (size_t)cJSON_Compare(p->tree, p->copy, 1);
+            break;
+        case 5:
+            cJSON_Delete(p->victim);
+            p->victim = NULL;
+            break;
+        default:
+            break;
+    }
+
+    return NULL;
+}
+
+/* bytes of a fresh thread stack touched by run_probe, -1 if no thread could be started */
+static long stack_high_water(probe *p)
+{
+    unsigned char *stack = NULL;
+    pthread_attr_t attributes;
+    pthread_t thread;
+    size_t i = 0;
+    int started = 0;
+
+    if (posix_memalign((void**)&stack, 4096, PROBE_STACK_SIZE) != 0)
+    {
+        return -1;
+    }
+    memset(stack, PROBE_PAINT, PROBE_STACK_SIZE);
+
+    pthread_attr_init(&attributes);
+    if ((pthread_attr_setstack(&attributes, stack, PROBE_STACK_SIZE) == 0) && (pthread_create(&thread, &attributes, run_probe, p) == 0))
+    {
+        pthread_join(thread, NULL);
+        started = 1;
+    }
+    pthread_attr_destroy(&attributes);
+
+    /* the stack grows down from the end of the block */
+    while ((i < PROBE_STACK_SIZE) && (stack[i] == PROBE_PAINT))
+    {
+        i++;
+    }
+    free(stack);
+
+    return started ? (long)(PROBE_STACK_SIZE - i) : -1;
+}
+
+static void print_stack_row(const char *name, const char *text, size_t length, long idle)
+{
+    probe p;
+    size_t i = 0;
+
+    memset(&p, 0, sizeof(p));
+    p.text = text;
+    p.length = length;
+    p.tree = cJSON_ParseWithLength(text, length);
+    p.copy = cJSON_ParseWithLength(text, length);
+    if ((p.tree == NULL) || (p.copy == NULL))
+    {
+        fprintf(stderr, "%s doesn't parse, no stack row\n", name);
+    }
+    else
+    {
+        printf("%-16s", name);
+        for (i = 0; i < PROBE_OPERATIONS; i++)
+        {
+            p.operation = (int)i;
+            p.victim = (i == 5) ? cJSON_ParseWithLength(text, length) : NULL;
+            printf(" %9ld", stack_high_water(&p) - idle);
+            cJSON_Delete(p.victim);
+        }
+        printf("\n");
+    }
+    cJSON_Delete(p.tree);
+    cJSON_Delete(p.copy);
+}
+
+/* text of depth arrays or single member objects nested in each other */
+static char *nested_text(size_t depth, int objects, size_t *length)
+{
+    const char *open = objects ? "{\"a\":" : "[";
+    const char *close = objects ? "}" : "]";
+    size_t open_length = strlen(open);
+    char *text = (char*)malloc((depth * (open_length + 1)) + 2);
+    size_t i = 0;
+
+    if (text == NULL)
+    {
+        return NULL;
+    }
+    *length = 0;
+    for (i = 0; i < depth; i++)
+    {
+        memcpy(text + *length, open, open_length);
+        *length += open_length;
+    }
+    text[(*length)++] = '1';
+    for (i = 0; i < depth; i++)
+    {
+        text[(*length)++] = close[0];
+    }
+    text[*length] = '\0';
+
+    return text;
+}
+
+static void print_stack_usage(const payload *payloads, size_t count)
+{
+    probe idle_probe;
+    long idle = 0;
+    size_t i = 0;
+    size_t length = 0;
+    char name[32];
+    char *text = NULL;
+    int objects = 0;
+
+    memset(&idle_probe, 0, sizeof(idle_probe));
+    idle_probe.operation = -1;
+    idle = stack_high_water(&idle_probe);
+
+    printf("\nstack high-water mark, bytes above an idle thread (%ld)\n%-16s", idle, "payload");
+    for (i = 0; i < PROBE_OPERATIONS; i++)
+    {
+        printf(" %9s", probe_operations[i]);
+    }
+    printf("\n");
+
+    for (i = 0; i < count; i++)
+    {
+        if (strncmp(payloads[i].name, "reserve", 7) == 0)
+        {
+            print_stack_row(payloads[i].name, payloads[i].text, payloads[i].length, idle);
+        }
+    }
+    for (objects = 0; objects < 2; objects++)
+    {
+        text = nested_text(CJSON_NESTING_LIMIT, objects, &length);
+        if (text != NULL)
+        {
+            snprintf(name, sizeof(name), "%s_%d", objects ? "objects" : "arrays", CJSON_NESTING_LIMIT);
+            print_stack_row(name, text, length, idle);
+            free(text);
+        }
+    }
+}
+
+/* correctness checks */
+
+typedef struct
+{
+    const char *json;
+    size_t offset;
+} error_case;
+
+/* the backslash of the invalid escape is reported, not the start of its string */
+static const error_case error_cases[] =
+{
+    {"\"xyy\\e\"", 4},
+    {"[\"abc\\q\"]", 5},
+    {"{\"k\\x\":1}", 3},
+};
+
+static size_t check_error_offsets(void)
+{
+    size_t failures = 0;
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(error_cases) / sizeof(error_cases[0])); i++)
+    {
+        const char *json = error_cases[i].json;
+        const char *end = NULL;
+        char in_situ[32];
+        cJSON_ParseError error;
+        cJSON_ParseError arena_error;
+        cJSON_ParseError in_situ_error;
+        cJSON *item = cJSON_ParseWithOpts(json, &end, 0);
+        cJSON *reentrant = cJSON_ParseWithError(json, strlen(json), 0, &error);
+        cJSON *arena = cJSON_ParseWithLengthArenaWithError(json, strlen(json), NULL, 0, &arena_error);
+        cJSON *in_place = NULL;
+
+        snprintf(in_situ, sizeof(in_situ), "%s", json);
+        in_place = cJSON_ParseInSituWithError(in_situ, strlen(in_situ), &in_situ_error);
+        if ((item != NULL) || (reentrant != NULL) || (arena != NULL) || (in_place != NULL) || (end != json + error_cases[i].offset)
+            || (cJSON_GetErrorPtr() != json + error_cases[i].offset) || (error.position != error_cases[i].offset)
+            || (arena_error.position != error_cases[i].offset) || (in_situ_error.position != error_cases[i].offset))
+        {
+            fprintf(stderr, "check failed: %s should fail at offset %lu, return_parse_end %ld, cJSON_ParseWithError %lu, arena %lu, in situ %lu\n",
+                json, (unsigned long)error_cases[i].offset, (end != NULL) ? (long)(end - json) : -1L, (unsigned long)error.position,
+                (unsigned long)arena_error.position, (unsigned long)in_situ_error.position);
+            failures++;
+        }
+        cJSON_Delete(item);
+        cJSON_Delete(reentrant);
+        cJSON_Delete(arena);
+        cJSON_Delete(in_place);
+    }
+
+    return failures;
+}
+
+/* keys given to arena items after the parse are on the heap, and cJSON_Delete frees them */
+static size_t check_arena_keys(void)
+{
+    static const char json[] = "{\"a\": 1, \"b\": {\"c\": 2}, \"d\": \"x\"}";
+    size_t live = heap_live;
+    cJSON *arena = cJSON_ParseWithLengthArena(json, sizeof(json) - 1, NULL, 0);
+    cJSON *moved = NULL;
+    cJSON_bool changed = 0;
+
+    if (arena == NULL)
+    {
+        fprintf(stderr, "check failed: no arena parse\n");
+        return 1;
+    }
+    moved = cJSON_DetachItemFromObjectCaseSensitive(arena, "a");
+    changed = cJSON_AddItemToObject(arena, "renamed", moved)
+        && cJSON_AddItemToObject(arena, "again", cJSON_DetachItemFromObjectCaseSensitive(arena, "renamed"))
+        && cJSON_ReplaceItemInObjectCaseSensitive(arena, "b", cJSON_DetachItemFromObjectCaseSensitive(arena, "d"));
+    if (!changed || (cJSON_GetObjectItemCaseSensitive(arena, "again") != moved) || !cJSON_IsString(cJSON_GetObjectItemCaseSensitive(arena, "b")))
+    {
+        fprintf(stderr, "check failed: arena items didn't move under their new keys\n");
+        cJSON_Delete(arena);
+        return 1;
+    }
+    cJSON_Delete(arena);
+    if (heap_live != live)
+    {
+        fprintf(stderr, "check failed: %lu heap bytes left after deleting an arena document with new keys\n", (unsigned long)(heap_live - live));
+        return 1;
+    }
+
+    return 0;
+}
+
+/* a lookup through a reference never sees an index of members the referenced object has since let go of */
+static size_t check_reference_lookups(void)
+{
+    size_t failures = 0;
+    char name[16];
+    int i = 0;
+    cJSON *object = cJSON_CreateObject();
+    cJSON *holder = cJSON_CreateObject();
+    cJSON *reference = NULL;
+
+    for (i = 0; i < 16; i++)
+    {
+        snprintf(name, sizeof(name), "member%d", i);
+        cJSON_AddNumberToObject(object, name, i);
+    }
+    /* the reference copies the object as it is now, members included */
+    cJSON_AddItemReferenceToObject(holder, "reference", object);
+    reference = cJSON_GetObjectItemCaseSensitive(holder, "reference");
+    if ((reference == NULL) || !cJSON_IndexObject(object) || cJSON_IndexObject(reference)
+        || (cJSON_GetObjectItemCaseSensitive(reference, "member7") != cJSON_GetObjectItemCaseSensitive(object, "member7")))
+    {
+        fprintf(stderr, "check failed: an object reference doesn't look up like the object it refers to\n");
+        failures++;
+    }
+    cJSON_DeleteItemFromObjectCaseSensitive(object, "member7");
+    if ((cJSON_GetObjectItemCaseSensitive(reference, "member7") != NULL) || (cJSON_GetObjectItemCaseSensitive(object, "member7") != NULL))
+    {
+        fprintf(stderr, "check failed: a deleted member is still found through an object reference\n");
+        failures++;
+    }
+    cJSON_Delete(holder);
+    cJSON_Delete(object);
+
+    return failures;
+}
+
+#define PROFILE_THREADS 4
+#define PROFILE_THREAD_ITEMS 100000
+
+static void lock_mutex(void *mutex)
+{
+    pthread_mutex_lock((pthread_mutex_t*)mutex);
+}
+
+static void unlock_mutex(void *mutex)
+{
+    pthread_mutex_unlock((pthread_mutex_t*)mutex);
+}
+
+static void *profile_thread(void *unused)
+{
+    int i = 0;
+
+    (void)unused;
+    for (i = 0; i < PROFILE_THREAD_ITEMS; i++)
+    {
+        cJSON_Delete(cJSON_CreateString("profiled"));
+    }
+
+    return NULL;
+}
+
+/* items and strings created on several threads at once are all counted, and charged to their own sites */
+static size_t check_profile_threads(void)
+{
+    static pthread_mutex_t profile_mutex = PTHREAD_MUTEX_INITIALIZER;
+    cJSON_AllocationSite before[CJSON_PROFILE_SITES];
+    cJSON_AllocationSite after[CJSON_PROFILE_SITES];
+    pthread_t threads[PROFILE_THREADS];
+    size_t started = 0;
+    size_t i = 0;
+    size_t failures = 0;
+    unsigned long expected = 0;
+
+    if (cJSON_GetAllocationProfile(before, CJSON_PROFILE_SITES) == 0)
+    {
+        return 0; /* not a CJSON_BENCH_PROFILE build */
+    }
+    cJSON_SetAllocationProfileLock(lock_mutex, unlock_mutex, &profile_mutex);
+    heap_shared = 1;
+    for (started = 0; (started < PROFILE_THREADS) && (pthread_create(&threads[started], NULL, profile_thread, NULL) == 0); started++)
+    {
+    }
+    for (i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    heap_shared = 0;
+    cJSON_SetAllocationProfileLock(NULL, NULL, NULL);
+    cJSON_GetAllocationProfile(after, CJSON_PROFILE_SITES);
+
+    expected = (unsigned long)started * PROFILE_THREAD_ITEMS;
+    for (i = 0; i < CJSON_PROFILE_SITES; i++)
+    {
+        const unsigned long made = ((i == cJSON_SiteItem) || (i == cJSON_SiteString)) ? expected : 0;
+
+        if (((after[i].allocations - before[i].allocations) != made) || ((after[i].frees - before[i].frees) != made)
+            || (after[i].live_bytes != before[i].live_bytes))
+        {
+            fprintf(stderr, "check failed: %lu items made on %lu threads show up as %lu %s allocations, %lu frees\n", expected,
+                (unsigned long)started, after[i].allocations - before[i].allocations, after[i].name, after[i].frees - before[i].frees);
+            failures++;
+        }
+    }
+
+    return failures;
+}
+
+/* text fed to the push parser in the given chunks, the tree it built if that equals the payload's */
+static int push_matches(cJSON_PushParser *parser, const payload *p, size_t split, size_t chunk)
+{
+    size_t offset = 0;
+    cJSON *pushed = NULL;
+    int matches = 0;
+
+    cJSON_PushParserFeed(parser, p->text, split);
+    for (offset = split; offset < p->length; offset += chunk)
+    {
+        cJSON_PushParserFeed(parser, p->text + offset, ((p->length - offset) < chunk) ? (p->length - offset) : chunk);
+    }
+    pushed = cJSON_PushParserFinish(parser);
+    matches = (pushed != NULL) && cJSON_Compare(pushed, p->tree, 1);
+    cJSON_Delete(pushed);
+
+    return matches;
+}
+
+static size_t check_push_splits(const payload *payloads, size_t count)
+{
+    size_t failures = 0;
+    size_t i = 0;
+    size_t split = 0;
+    cJSON_PushParser *parser = cJSON_PushParserCreate();
+
+    if (parser == NULL)
+    {
+        fprintf(stderr, "check failed: no push parser\n");
+        return 1;
+    }
+    for (i = 0; i < count; i++)
+    {
+        const payload *p = &payloads[i];
+
+        for (split = 0; split <= p->length; split++)
+        {
+            /* the rest in one chunk */
+            if (!push_matches(parser, p, split, p->length + 1))
+            {
+                fprintf(stderr, "check failed: %s split at byte %lu doesn't push parse like cJSON_Parse\n", p->name, (unsigned long)split);
+                failures++;
+                break;
+            }
+        }
+        if (!push_matches(parser, p, 0, 1))
+        {
+            fprintf(stderr, "check failed: %s fed a byte at a time doesn't push parse like cJSON_Parse\n", p->name);
+            failures++;
+        }
+    }
+    cJSON_PushParserDelete(parser);
+
+    return failures;
+}
+
+/* the text cJSON printed a number as before the Grisu printer, %d, %1.15g or %1.17g, whether that was %1.17g */
+static int old_number_text(double number, char *buffer)
+{
+    double test = 0;
+    double difference = 0;
+    int integer = (number >= INT_MAX) ? INT_MAX : ((number <= (double)INT_MIN) ? INT_MIN : (int)number);
+
+    if (number == (double)integer)
+    {
+        sprintf(buffer, "%d", integer);
+        return 0;
+    }
+    sprintf(buffer, "%1.15g", number);
+    test = strtod(buffer, NULL);
+    difference = (test > number) ? (test - number) : (number - test);
+    if (difference > (((fabs(test) > fabs(number)) ? fabs(test) : fabs(number)) * DBL_EPSILON))
+    {
+        sprintf(buffer, "%1.17g", number);
+        return 1;
+    }
+
+    return 0;
+}
+
+/* every printed double reads back as itself, as the same text as before whenever 15 digits did too,
+ * and otherwise at most as long as the %1.17g text */
+static size_t check_round_trip(void)
+{
+    size_t failures = 0;
+    size_t i = 0;
+    char printed[64];
+    char old[64];
+    int seventeen = 0;
+    cJSON *item = cJSON_CreateNumber(0);
+
+    if (item == NULL)
+    {
+        fprintf(stderr, "check failed: no number item\n");
+        return 1;
+    }
+    for (i = 0; (i < ROUND_TRIP_NUMBERS) && (failures < 10); i++)
+    {
+        double number = next_double();
+
+        cJSON_SetNumberValue(item, number);
+        seventeen = old_number_text(number, old);
+        if (!cJSON_PrintPreallocated(item, printed, (int)sizeof(printed), 0) || (strtod(printed, NULL) != number))
+        {
+            fprintf(stderr, "check failed: %.17g printed as %s doesn't read back\n", number, printed);
+            failures++;
+        }
+        /* integers from 1e15 on are printed in full now */
+        else if (seventeen && (strlen(printed) > strlen(old)))
+        {
+            fprintf(stderr, "check failed: %.17g printed as %s, longer than %s\n", number, printed, old);
+            failures++;
+        }
+        else if (!seventeen && (strtod(old, NULL) == number) && ((number != floor(number)) || (fabs(number) < 1e15)) && (strcmp(printed, old) != 0))
+        {
+            fprintf(stderr, "check failed: %.17g printed as %s, it used to be %s\n", number, printed, old);
+            failures++;
+        }
+    }
+    cJSON_Delete(item);
+
+    return failures;
+}
+
+/* the int64 limits print as the integers they are, whether parsed, created or set */
+static size_t check_int64_limits(void)
+{
+    static const char * const texts[] = { "9223372036854775807", "-9223372036854775808" };
+    static const int64_t limits[] = { INT64_MAX, INT64_MIN };
+    size_t failures = 0;
+    size_t i = 0;
+    char printed[64];
+
+    for (i = 0; i < (sizeof(limits) / sizeof(limits[0])); i++)
+    {
+        cJSON *parsed = cJSON_Parse(texts[i]);
+        cJSON *created = cJSON_CreateInt64(limits[i]);
+        cJSON *set = cJSON_CreateNumber(0);
+
+        cJSON_SetIntValue(set, limits[i]);
+        if ((parsed == NULL) || (parsed->valueint64 != limits[i])
+            || !cJSON_PrintPreallocated(parsed, printed, (int)sizeof(printed), 0) || (strcmp(printed, texts[i]) != 0))
+        {
+            fprintf(stderr, "check failed: %s doesn't parse and print back as itself\n", texts[i]);
+            failures++;
+        }
+        if ((created == NULL) || !cJSON_PrintPreallocated(created, printed, (int)sizeof(printed), 0) || (strcmp(printed, texts[i]) != 0))
+        {
+            fprintf(stderr, "check failed: cJSON_CreateInt64(%s) doesn't print as itself\n", texts[i]);
+            failures++;
+        }
+        if ((set == NULL) || (set->valueint64 != limits[i]) || (set->valueint != ((limits[i] > 0) ? INT_MAX : INT_MIN))
+            || !cJSON_PrintPreallocated(set, printed, (int)sizeof(printed), 0) || (strcmp(printed, texts[i]) != 0))
+        {
+            fprintf(stderr, "check failed: cJSON_SetIntValue(%s) doesn't keep the number\n", texts[i]);
+            failures++;
+        }
+        cJSON_Delete(parsed);
+        cJSON_Delete(created);
+        cJSON_Delete(set);
+    }
+
+    return failures;
+}
+
+/* number of failed checks */
+static size_t run_checks(const payload *payloads, size_t count)
+{
+    return check_error_offsets() + check_arena_keys() + check_reference_lookups() + check_profile_threads() + check_push_splits(payloads, count) + check_int64_limits() + check_round_trip();
+}
+
+/* results */
+
+static void write_csv(const char *path, const result *results, size_t count)
+{
+    size_t i = 0;
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "can't write %s\n", path);
+        return;
+    }
+    fprintf(file, "payload,operation,bytes,ops,ns_per_op,bytes_per_s,allocs_per_op,peak_heap_bytes\n");
+    for (i = 0; i < count; i++)
+    {
+        fprintf(file, "%s,%s,%lu,%lu,%.1f,%.0f,%.2f,%lu\n", results[i].payload, results[i].operation,
+            (unsigned long)results[i].bytes, (unsigned long)results[i].ops, results[i].ns_per_op,
+            results[i].bytes_per_s, results[i].allocs_per_op, (unsigned long)results[i].peak_heap);
+    }
+    fclose(file);
+}
+
+/* ns/op of the same row in a csv written by an earlier run, 0 if there is none */
+static double baseline_ns(const char *path, const result *r)
+{
+    char line[256];
+    char name[64];
+    char operation[16];
+    double ns = 0;
+    FILE *file = NULL;
+
+    if (path == NULL)
+    {
+        return 0;
+    }
+    file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return 0;
+    }
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if ((sscanf(line, "%63[^,],%15[^,],%*[^,],%*[^,],%lf", name, operation, &ns) == 3)
+            && (strcmp(name, r->payload) == 0) && (strcmp(operation, r->operation) == 0))
+        {
+            fclose(file);
+            return ns;
+        }
+    }
+    fclose(file);
+
+    return 0;
+}
+
+/* the per call site totals of the whole run, only filled in a CJSON_BENCH_PROFILE build */
+static void print_profile(void)
+{
+    cJSON_AllocationSite sites[CJSON_PROFILE_SITES];
+    size_t count = cJSON_GetAllocationProfile(sites, CJSON_PROFILE_SITES);
+    size_t i = 0;
+    size_t bucket = 0;
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    printf("\n%-8s %12s %10s %12s %14s %10s  sizes <=16,32,..1024,more\n", "site", "allocs", "reallocs", "frees", "bytes", "lifetime");
+    for (i = 0; i < count; i++)
+    {
+        printf("%-8s %12lu %10lu %12lu %14lu %10.1f ", sites[i].name, sites[i].allocations, sites[i].reallocations,
+            sites[i].frees, (unsigned long)sites[i].bytes, sites[i].frees ? ((double)sites[i].lifetime / (double)sites[i].frees) : 0.0);
+        for (bucket = 0; bucket < CJSON_PROFILE_BUCKETS; bucket++)
+        {
+            printf(" %lu", sites[i].histogram[bucket]);
+        }
+        printf("\n");
+    }
+}
+
+static void print_result(const result *r, const char *baseline)
+{
+    double base = 0;
+
+    printf("%-16s %-10s %8lu %12.1f %10.1f %9.2f %10lu", r->payload, r->operation, (unsigned long)r->bytes,
+        r->ns_per_op, r->bytes_per_s / 1e6, r->allocs_per_op, (unsigned long)r->peak_heap);
+    base = baseline_ns(baseline, r);
+    if (base > 0)
+    {
+        printf(" %+7.1f%%", ((r->ns_per_op - base) * 100.0) / base);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    static payload payloads[MAX_PAYLOADS];
+    static result results[MAX_RESULTS];
+    const char *corpus = CJSON_BENCH_CORPUS;
+    const char *output = NULL;
+    const char *baseline = NULL;
+    double min_ns = 200e6;
+    size_t payload_count = 0;
+    size_t result_count = 0;
+    size_t i = 0;
+    size_t j = 0;
+    int argument = 0;
+    int checks_only = 0;
+    char *body_text = NULL;
+
+    for (argument = 1; argument < argc; argument++)
+    {
+        if (strcmp(argv[argument], "-c") == 0)
+        {
+            checks_only = 1;
+        }
+        else if ((strcmp(argv[argument], "-d") == 0) && (argument + 1 < argc))
+        {
+            corpus = argv[++argument];
+        }
+        else if ((strcmp(argv[argument], "-t") == 0) && (argument + 1 < argc))
+        {
+            min_ns = atof(argv[++argument]) * 1e6;
+        }
+        else if ((strcmp(argv[argument], "-o") == 0) && (argument + 1 < argc))
+        {
+            output = argv[++argument];
+        }
+        else if ((strcmp(argv[argument], "-b") == 0) && (argument + 1 < argc))
+        {
+            baseline = argv[++argument];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-c] [-d corpus_dir] [-t milliseconds] [-o results.csv] [-b baseline.csv]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    cJSON_InitHooks(&bench_hooks);
+    for (i = 0; i < QUERY_COUNT; i++)
+    {
+        if (!cJSON_CompileQuery(&queries[i], query_paths[i]))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    push_parser = cJSON_PushParserCreate();
+    if (push_parser == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+
+    load_corpus(corpus, payloads, &payload_count);
+    if (run_checks(payloads, payload_count) > 0)
+    {
+        return EXIT_FAILURE;
+    }
+    if (checks_only)
+    {
+        printf("all checks passed\n");
+        return EXIT_SUCCESS;
+    }
+    add_schedule(payloads, &payload_count, 100);
+    add_schedule(payloads, &payload_count, 2000);
+    add_doubles(payloads, &payload_count, 1000);
+
+    printf("%-16s %-10s %8s %12s %10s %9s %10s %8s\n", "payload", "operation", "bytes", "ns/op", "MB/s", "allocs", "peak heap", "vs base");
+    for (i = 0; i < payload_count; i++)
+    {
+        for (j = 0; j < (sizeof(operations) / sizeof(operations[0])); j++)
+        {
+            result *r = &results[result_count];
+
+            if (result_count >= MAX_RESULTS)
+            {
+                break;
+            }
+            measure(&payloads[i], &operations[j], min_ns, r);
+            result_count++;
+            print_result(r, baseline);
+        }
+    }
+
+    /* the body ops ignore their payload, it only names the rows and carries the body length */
+    body_text = (char*)malloc(sizeof(BODY_TEXT));
+    if ((body_text != NULL) && (result_count < MAX_RESULTS))
+    {
+        memcpy(body_text, BODY_TEXT, sizeof(BODY_TEXT));
+        if (add_payload(payloads, &payload_count, "request_body", body_text, sizeof(BODY_TEXT) - 1))
+        {
+            for (j = 0; (j < (sizeof(body_operations) / sizeof(body_operations[0]))) && (result_count < MAX_RESULTS); j++)
+            {
+                measure(&payloads[payload_count - 1], &body_operations[j], min_ns, &results[result_count]);
+                print_result(&results[result_count], baseline);
+                result_count++;
+            }
+        }
+    }
+
+    /* added after the main loop so these only get the lookup ops, each op looks up every member once */
+    i = payload_count;
+    add_object(payloads, &payload_count, 5);
+    add_object(payloads, &payload_count, 50);
+    add_object(payloads, &payload_count, 500);
+    for (; i < payload_count; i++)
+    {
+        for (j = 0; (j < (sizeof(key_operations) / sizeof(key_operations[0]))) && (result_count < MAX_RESULTS); j++)
+        {
+            measure(&payloads[i], &key_operations[j], min_ns, &results[result_count]);
+            print_result(&results[result_count], baseline);
+            result_count++;
+        }
+    }
+
+    /* added after the main loop so these only get the scan ops */
+    i = payload_count;
+    add_scan(payloads, &payload_count, "whitespace");
+    add_scan(payloads, &payload_count, "strings");
+    add_scan(payloads, &payload_count, "escapes");
+    for (; i < payload_count; i++)
+    {
+        for (j = 0; (j < (sizeof(scan_operations) / sizeof(scan_operations[0]))) && (result_count < MAX_RESULTS); j++)
+        {
+            measure(&payloads[i], &scan_operations[j], min_ns, &results[result_count]);
+            print_result(&results[result_count], baseline);
+            result_count++;
+        }
+    }
+
+    /* added after the main loop so the schedule only gets the extract ops */
+    i = payload_count;
+    add_schedule(payloads, &payload_count, 1000);
+    for (j = 0; (payload_count > i) && (j < (sizeof(extract_operations) / sizeof(extract_operations[0]))) && (result_count < MAX_RESULTS); j++)
+    {
+        measure(&payloads[i], &extract_operations[j], min_ns, &results[result_count]);
+        print_result(&results[result_count], baseline);
+        result_count++;
+    }
+    merge_patches[0] = cJSON_Parse("{\"responseCode\": 2}");
+    merge_patches[1] = cJSON_Parse("{\"responseCode\": 1}");
+    for (j = 0; (payload_count > i) && (merge_patches[1] != NULL) && (j < (sizeof(patch_operations) / sizeof(patch_operations[0]))) && (result_count < MAX_RESULTS); j++)
+    {
+        measure(&payloads[i], &patch_operations[j], min_ns, &results[result_count]);
+        print_result(&results[result_count], baseline);
+        result_count++;
+    }
+
+    if (output != NULL)
+    {
+        write_csv(output, results, result_count);
+    }
+
+    print_stack_usage(payloads, payload_count);
+    print_profile();
+
+    for (i = 0; i < payload_count; i++)
+    {
+        cJSON_Delete(payloads[i].tree);
+        free(payloads[i].text);
+        free((void*)payloads[i].lookup_objects);
+        free((void*)payloads[i].lookup_names);
+    }
+    cJSON_Delete(merge_patches[0]);
+    cJSON_Delete(merge_patches[1]);
+    cJSON_PushParserDelete(push_parser);
+    free(trees);
+    free(tapes);
+    free(write_buffer);
+
+    return EXIT_SUCCESS;
+}
@@ -49,6 +49,12 @@
 #include <locale.h>
 #endif
 
+/* scan 16 bytes at a time with SSE2 where it is available, define CJSON_DISABLE_SSE2 to use the portable code only */
+#if !defined(CJSON_DISABLE_SSE2) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#define CJSON_SCAN_SSE2
+#include <emmintrin.h>
+#endif
+
 #if defined(_MSC_VER)
 #pragma warning (pop)
 #endif
@@ -116,6 +122,16 @@ CJSON_PUBLIC(double) cJSON_GetNumberValue(const cJSON * const item)
     return item->valuedouble;
 }
 
+CJSON_PUBLIC(int64_t) cJSON_GetInt64Value(const cJSON * const item)
+{
+    if (!cJSON_IsNumber(item))
+    {
+        return 0;
+    }
+
+    return item->valueint64;
+}
+
 /* This is a safeguard to prevent copy-pasters from using incompatible C and header files */
 #if (CJSON_VERSION_MAJOR != 1) || (CJSON_VERSION_MINOR != 7) || (CJSON_VERSION_PATCH != 17)
     #error cJSON.h and cJSON.c have different versions. Make sure that both have the same.
@@ -153,6 +169,21 @@ static int case_insensitive_strcmp(const unsigned char *string1, const unsigned
     return tolower(*string1) - tolower(*string2);
 }
 
+#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
+    #pragma GCC diagnostic push
+#endif
+#ifdef __GNUC__
+#pragma GCC diagnostic ignored "-Wcast-qual"
+#endif
+/* helper function to cast away const */
+static void* cast_away_const(const void* string)
+{
+    return (void*)string;
+}
+#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
+    #pragma GCC diagnostic pop
+#endif
+
 typedef struct internal_hooks
 {
     void *(CJSON_CDECL *allocate)(size_t size);
@@ -183,7 +214,236 @@ static void * CJSON_CDECL internal_realloc(void *pointer, size_t size)
 /* strlen of character literals resolved at compile time */
 #define static_strlen(string_literal) (sizeof(string_literal) - sizeof(""))
 
+#ifdef CJSON_PROFILE_ALLOCATIONS
+/* Every block carries the site that asked for it, its size and the allocation
+ * clock at its birth, so frees are attributed without a lookup table. */
+typedef union
+{
+    struct
+    {
+        size_t size;
+        unsigned long born;
+        int site;
+    } block;
+    double align_double;
+    void *align_pointer;
+} profile_header;
+
+static struct
+{
+    internal_hooks hooks; /* the hooks behind the profiler */
+    unsigned long clock; /* allocations made so far */
+    cJSON_AllocationSite sites[CJSON_PROFILE_SITES];
+    /* set by cJSON_SetAllocationProfileLock, held only while the counters are updated or copied */
+    void (*lock)(void *context);
+    void (*unlock)(void *context);
+    void *lock_context;
+} profile = { { internal_malloc, internal_free, internal_realloc }, 0, { { 0, 0, 0, 0, 0, 0, 0, { 0 }, 0 } }, NULL, NULL, NULL };
+
+static const char * const profile_site_names[CJSON_PROFILE_SITES] = { "other", "item", "string", "arena", "index", "print", "push", "pool", "tape", "walk" };
+
+/* The site is set right in front of an allocation by the same thread, so each thread keeps its own
+ * where the compiler can. Elsewhere allocations on several threads can be charged to each other's sites. */
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#define CJSON_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#define CJSON_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define CJSON_THREAD_LOCAL __declspec(thread)
+#else
+#define CJSON_THREAD_LOCAL
+#endif
+
+/* the site the next allocation is charged to, set right in front of it */
+static CJSON_THREAD_LOCAL int allocation_site = cJSON_SiteOther;
+#define profile_at(site) (allocation_site = (site))
+
+static void profile_lock(void)
+{
+    if (profile.lock != NULL)
+    {
+        profile.lock(profile.lock_context);
+    }
+}
+
+static void profile_unlock(void)
+{
+    if (profile.unlock != NULL)
+    {
+        profile.unlock(profile.lock_context);
+    }
+}
+
+static void profile_live_bytes(cJSON_AllocationSite * const site, size_t freed, size_t allocated)
+{
+    site->live_bytes = site->live_bytes - freed + allocated;
+    if (site->live_bytes > site->peak_live_bytes)
+    {
+        site->peak_live_bytes = site->live_bytes;
+    }
+}
+
+static void * CJSON_CDECL profile_allocate(size_t size)
+{
+    cJSON_AllocationSite *site = &profile.sites[allocation_site];
+    profile_header *header = (profile_header*)profile.hooks.allocate(sizeof(profile_header) + size);
+    size_t bucket = 0;
+
+    if (header == NULL)
+    {
+        allocation_site = cJSON_SiteOther;
+        return NULL;
+    }
+    header->block.size = size;
+    header->block.site = allocation_site;
+    allocation_site = cJSON_SiteOther;
+    while ((bucket < (CJSON_PROFILE_BUCKETS - 1)) && (size > ((size_t)16 << bucket)))
+    {
+        bucket++;
+    }
+
+    profile_lock();
+    header->block.born = profile.clock++;
+    site->allocations++;
+    site->bytes += size;
+    profile_live_bytes(site, 0, size);
+    site->histogram[bucket]++;
+    profile_unlock();
+
+    return header + 1;
+}
+
+static void CJSON_CDECL profile_deallocate(void *pointer)
+{
+    profile_header *header = NULL;
+    cJSON_AllocationSite *site = NULL;
+
+    if (pointer == NULL)
+    {
+        return;
+    }
+    header = (profile_header*)pointer - 1;
+    site = &profile.sites[header->block.site];
+
+    profile_lock();
+    site->frees++;
+    site->lifetime += profile.clock - header->block.born;
+    profile_live_bytes(site, header->block.size, 0);
+    profile_unlock();
+    profile.hooks.deallocate(header);
+}
+
+/* a resized block stays charged to the site that allocated it */
+static void * CJSON_CDECL profile_reallocate(void *pointer, size_t size)
+{
+    profile_header *header = NULL;
+    cJSON_AllocationSite *site = NULL;
+    size_t old_size = 0;
+
+    if (pointer == NULL)
+    {
+        return profile_allocate(size);
+    }
+    allocation_site = cJSON_SiteOther;
+    header = (profile_header*)pointer - 1;
+    old_size = header->block.size;
+
+    header = (profile_header*)profile.hooks.reallocate(header, sizeof(profile_header) + size);
+    if (header == NULL)
+    {
+        return NULL;
+    }
+    site = &profile.sites[header->block.site];
+    header->block.size = size;
+
+    profile_lock();
+    site->reallocations++;
+    if (size > old_size)
+    {
+        site->bytes += size - old_size;
+    }
+    profile_live_bytes(site, old_size, size);
+    profile_unlock();
+
+    return header + 1;
+}
+
+static internal_hooks global_hooks = { profile_allocate, profile_deallocate, profile_reallocate };
+
+/* put the profiler in front of freshly set hooks */
+static void profile_install(void)
+{
+    profile.hooks = global_hooks;
+    global_hooks.allocate = profile_allocate;
+    global_hooks.deallocate = profile_deallocate;
+    global_hooks.reallocate = (profile.hooks.reallocate != NULL) ? profile_reallocate : NULL;
+}
+#else
+#define profile_at(site) ((void)0)
+#define profile_install() ((void)0)
+
 static internal_hooks global_hooks = { internal_malloc, internal_free, internal_realloc };
+#endif
+
+CJSON_PUBLIC(size_t) cJSON_GetAllocationProfile(cJSON_AllocationSite *sites, size_t count)
+{
+#ifdef CJSON_PROFILE_ALLOCATIONS
+    size_t i = 0;
+
+    if (sites == NULL)
+    {
+        return 0;
+    }
+    if (count > CJSON_PROFILE_SITES)
+    {
+        count = CJSON_PROFILE_SITES;
+    }
+    profile_lock();
+    for (i = 0; i < count; i++)
+    {
+        sites[i] = profile.sites[i];
+        sites[i].name = profile_site_names[i];
+    }
+    profile_unlock();
+
+    return count;
+#else
+    (void)sites;
+    (void)count;
+    return 0;
+#endif
+}
+
+CJSON_PUBLIC(void) cJSON_ResetAllocationProfile(void)
+{
+#ifdef CJSON_PROFILE_ALLOCATIONS
+    size_t i = 0;
+    size_t live_bytes = 0;
+
+    profile_lock();
+    for (i = 0; i < CJSON_PROFILE_SITES; i++)
+    {
+        live_bytes = profile.sites[i].live_bytes;
+        memset(&profile.sites[i], '\0', sizeof(cJSON_AllocationSite));
+        profile.sites[i].live_bytes = live_bytes;
+        profile.sites[i].peak_live_bytes = live_bytes;
+    }
+    profile_unlock();
+#endif
+}
+
+CJSON_PUBLIC(void) cJSON_SetAllocationProfileLock(void (*lock)(void *context), void (*unlock)(void *context), void *context)
+{
+#ifdef CJSON_PROFILE_ALLOCATIONS
+    profile.lock = lock;
+    profile.unlock = unlock;
+    profile.lock_context = context;
+#else
+    (void)lock;
+    (void)unlock;
+    (void)context;
+#endif
+}
 
 static unsigned char* cJSON_strdup(const unsigned char* string, const internal_hooks * const hooks)
 {
@@ -196,6 +456,7 @@ static unsigned char* cJSON_strdup(const unsigned char* string, const internal_h
     }
 
     length = strlen((const char*)string) + sizeof("");
+    profile_at(cJSON_SiteString);
     copy = (unsigned char*)hooks->allocate(length);
     if (copy == NULL)
     {
@@ -206,14 +467,19 @@ static unsigned char* cJSON_strdup(const unsigned char* string, const internal_h
     return copy;
 }
 
+static void pool_release(void);
+
 CJSON_PUBLIC(void) cJSON_InitHooks(cJSON_Hooks* hooks)
 {
+    pool_release();
+
     if (hooks == NULL)
     {
         /* Reset hooks */
         global_hooks.allocate = malloc;
         global_hooks.deallocate = free;
         global_hooks.reallocate = realloc;
+        profile_install();
         return;
     }
 
@@ -235,12 +501,16 @@ CJSON_PUBLIC(void) cJSON_InitHooks(cJSON_Hooks* hooks)
     {
         global_hooks.reallocate = realloc;
     }
+    profile_install();
 }
 
 /* Internal constructor. */
 static cJSON *cJSON_New_Item(const internal_hooks * const hooks)
 {
-    cJSON* node = (cJSON*)hooks->allocate(sizeof(cJSON));
+    cJSON* node = NULL;
+
+    profile_at(cJSON_SiteItem);
+    node = (cJSON*)hooks->allocate(sizeof(cJSON));
     if (node)
     {
         memset(node, '\0', sizeof(cJSON));
@@ -249,942 +519,4663 @@ static cJSON *cJSON_New_Item(const internal_hooks * const hooks)
     return node;
 }
 
-/* Delete a cJSON structure. */
-CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
+#ifndef CJSON_ARENA_ALIGNMENT
+#define CJSON_ARENA_ALIGNMENT 8
+#endif
+#define arena_align(size) (((size) + (CJSON_ARENA_ALIGNMENT - 1)) & ~((size_t)CJSON_ARENA_ALIGNMENT - 1))
+
+/* Header at the start of every arena block. Only the first block of a document
+ * tracks the block that is currently being filled. */
+typedef struct arena_block
 {
-    cJSON *next = NULL;
-    while (item != NULL)
+    struct arena_block *next;
+    struct arena_block *current;
+    size_t size; /* usable bytes behind the header */
+    size_t used;
+    void *memory; /* start of the allocation that holds this block */
+    void (CJSON_CDECL *deallocate)(void *pointer); /* NULL if the block belongs to the caller */
+} arena_block;
+
+#define arena_header_size arena_align(sizeof(arena_block))
+#define arena_data(block) ((unsigned char*)(block) + arena_header_size)
+/* the root item is always the first allocation of the first block */
+#define arena_of_root(root) ((arena_block*)(void*)((unsigned char*)(root) - arena_header_size))
+
+static arena_block *arena_init(unsigned char *memory, size_t size, void (CJSON_CDECL *deallocate)(void *pointer))
+{
+    size_t padding = 0;
+    arena_block *block = NULL;
+
+    if (memory == NULL)
     {
-        next = item->next;
-        if (!(item->type & cJSON_IsReference) && (item->child != NULL))
-        {
-            cJSON_Delete(item->child);
-        }
-        if (!(item->type & cJSON_IsReference) && (item->valuestring != NULL))
-        {
-            global_hooks.deallocate(item->valuestring);
-        }
-        if (!(item->type & cJSON_StringIsConst) && (item->string != NULL))
-        {
-            global_hooks.deallocate(item->string);
-        }
-        global_hooks.deallocate(item);
-        item = next;
+        return NULL;
+    }
+
+    padding = (CJSON_ARENA_ALIGNMENT - ((size_t)memory % CJSON_ARENA_ALIGNMENT)) % CJSON_ARENA_ALIGNMENT;
+    if (size < (padding + arena_header_size))
+    {
+        return NULL;
     }
+
+    block = (arena_block*)(void*)(memory + padding);
+    block->next = NULL;
+    block->current = block;
+    block->size = size - padding - arena_header_size;
+    block->used = 0;
+    block->memory = memory;
+    block->deallocate = deallocate;
+
+    return block;
 }
 
-/* get the decimal point character of the current locale */
-static unsigned char get_decimal_point(void)
+static void arena_release(arena_block *block)
 {
-#ifdef ENABLE_LOCALES
-    struct lconv *lconv = localeconv();
-    return (unsigned char) lconv->decimal_point[0];
-#else
-    return '.';
-#endif
+    arena_block *next = NULL;
+    while (block != NULL)
+    {
+        next = block->next;
+        if (block->deallocate != NULL)
+        {
+            block->deallocate(block->memory);
+        }
+        block = next;
+    }
 }
 
+/* One slab of equally sized slots, free slots are linked through their first bytes */
 typedef struct
 {
-    const unsigned char *content;
-    size_t length;
-    size_t offset;
-    size_t depth; /* How deeply nested (in arrays/objects) is the input at the current offset. */
-    internal_hooks hooks;
-} parse_buffer;
+    unsigned char *start;
+    unsigned char *end;
+    size_t slot_size;
+    void *free_list;
+    cJSON_PoolStats stats;
+} pool_slab;
+
+/* the pool installed by cJSON_InitHooksWithPool, all zero while there is none */
+static struct
+{
+    pool_slab nodes;
+    pool_slab strings;
+    void *memory; /* pool memory to give back to deallocate, NULL if it belongs to the caller */
+    /* the hooks behind the pool */
+    void *(CJSON_CDECL *allocate)(size_t size);
+    void (CJSON_CDECL *deallocate)(void *pointer);
+    void *(CJSON_CDECL *reallocate)(void *pointer, size_t size);
+    void (*lock)(void *context);
+    void (*unlock)(void *context);
+    void *lock_context;
+} pool;
 
-/* check if the given size is left to read in a given parse buffer (starting with 1) */
-#define can_read(buffer, size) ((buffer != NULL) && (((buffer)->offset + size) <= (buffer)->length))
-/* check if the buffer can be accessed at the given index (starting with 0) */
-#define can_access_at_index(buffer, index) ((buffer != NULL) && (((buffer)->offset + index) < (buffer)->length))
-#define cannot_access_at_index(buffer, index) (!can_access_at_index(buffer, index))
-/* get a pointer to the buffer at the position */
-#define buffer_at_offset(buffer) ((buffer)->content + (buffer)->offset)
+#define pool_slot_size(size) arena_align(((size) < sizeof(void*)) ? sizeof(void*) : (size))
+#define pool_owns(slab, pointer) (((const unsigned char*)(pointer) >= (slab)->start) && ((const unsigned char*)(pointer) < (slab)->end))
 
-/* Parse the input text to generate a number, and populate the result into item. */
-static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_buffer)
+static void pool_lock(void)
 {
-    double number = 0;
-    unsigned char *after_end = NULL;
-    unsigned char number_c_string[64];
-    unsigned char decimal_point = get_decimal_point();
-    size_t i = 0;
-
-    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    if (pool.lock != NULL)
     {
-        return false;
+        pool.lock(pool.lock_context);
     }
+}
 
-    /* copy the number into a temporary buffer and replace '.' with the decimal point
-     * of the current locale (for strtod)
-     * This also takes care of '\0' not necessarily being available for marking the end of the input */
-    for (i = 0; (i < (sizeof(number_c_string) - 1)) && can_access_at_index(input_buffer, i); i++)
+static void pool_unlock(void)
+{
+    if (pool.unlock != NULL)
     {
-        switch (buffer_at_offset(input_buffer)[i])
-        {
-            case '0':
-            case '1':
-            case '2':
-            case '3':
-            case '4':
-            case '5':
-            case '6':
-            case '7':
-            case '8':
-            case '9':
-            case '+':
-            case '-':
-            case 'e':
-            case 'E':
-                number_c_string[i] = buffer_at_offset(input_buffer)[i];
-                break;
+        pool.unlock(pool.lock_context);
+    }
+}
 
-            case '.':
-                number_c_string[i] = decimal_point;
-                break;
+/* carve count slots out of memory and return the end of the slab */
+static unsigned char *pool_slab_init(pool_slab * const slab, unsigned char *memory, size_t count, size_t slot_size)
+{
+    size_t i = 0;
 
-            default:
-                goto loop_end;
-        }
-    }
-loop_end:
-    number_c_string[i] = '\0';
+    memset(slab, '\0', sizeof(pool_slab));
+    slab->start = memory;
+    slab->end = memory + (count * slot_size);
+    slab->slot_size = slot_size;
 
-    number = strtod((const char*)number_c_string, (char**)&after_end);
-    if (number_c_string == after_end)
+    /* link the slots back to front so they are handed out in address order */
+    for (i = count; i > 0; i--)
     {
-        return false; /* parse_error */
+        void **slot = (void**)(void*)(memory + ((i - 1) * slot_size));
+        *slot = slab->free_list;
+        slab->free_list = slot;
     }
 
-    item->valuedouble = number;
+    return slab->end;
+}
 
-    /* use saturation in case of overflow */
-    if (number >= INT_MAX)
-    {
-        item->valueint = INT_MAX;
-    }
-    else if (number <= (double)INT_MIN)
+static pool_slab *pool_slab_of(const void *pointer)
+{
+    if (pool_owns(&pool.nodes, pointer))
     {
-        item->valueint = INT_MIN;
+        return &pool.nodes;
     }
-    else
+    if (pool_owns(&pool.strings, pointer))
     {
-        item->valueint = (int)number;
+        return &pool.strings;
     }
 
-    item->type = cJSON_Number;
-
-    input_buffer->offset += (size_t)(after_end - number_c_string);
-    return true;
+    return NULL;
 }
 
-/* don't ask me, but the original cJSON_SetNumberValue returns an integer or double */
-CJSON_PUBLIC(double) cJSON_SetNumberHelper(cJSON *object, double number)
+static void * CJSON_CDECL pool_allocate(size_t size)
 {
-    if (number >= INT_MAX)
+    pool_slab *slab = NULL;
+    void *slot = NULL;
+
+    if (size == sizeof(cJSON))
     {
-        object->valueint = INT_MAX;
+        slab = &pool.nodes;
     }
-    else if (number <= (double)INT_MIN)
+    else if (size <= pool.strings.slot_size)
     {
-        object->valueint = INT_MIN;
+        slab = &pool.strings;
     }
     else
     {
-        object->valueint = (int)number;
+        return pool.allocate(size);
     }
 
-    return object->valuedouble = number;
+    pool_lock();
+    slot = slab->free_list;
+    if (slot != NULL)
+    {
+        slab->free_list = *(void**)slot;
+        slab->stats.total++;
+        slab->stats.live++;
+        if (slab->stats.live > slab->stats.peak)
+        {
+            slab->stats.peak = slab->stats.live;
+        }
+    }
+    else
+    {
+        slab->stats.fallback++;
+    }
+    pool_unlock();
+
+    if (slot == NULL)
+    {
+        return pool.allocate(size);
+    }
+
+    return slot;
 }
 
-CJSON_PUBLIC(char*) cJSON_SetValuestring(cJSON *object, const char *valuestring)
+static void CJSON_CDECL pool_deallocate(void *pointer)
 {
-    char *copy = NULL;
-    /* if object's type is not cJSON_String or is cJSON_IsReference, it should not set valuestring */
-    if ((object == NULL) || !(object->type & cJSON_String) || (object->type & cJSON_IsReference))
+    /* the range check keeps pointers from the hooks off the free lists */
+    pool_slab *slab = pool_slab_of(pointer);
+
+    if (slab == NULL)
     {
-        return NULL;
+        pool.deallocate(pointer);
+        return;
     }
-    /* return NULL if the object is corrupted */
-    if (object->valuestring == NULL)
+
+    pool_lock();
+    *(void**)pointer = slab->free_list;
+    slab->free_list = pointer;
+    slab->stats.live--;
+    pool_unlock();
+}
+
+static void * CJSON_CDECL pool_reallocate(void *pointer, size_t size)
+{
+    pool_slab *slab = pool_slab_of(pointer);
+    void *moved = NULL;
+
+    if (slab == NULL)
     {
-        return NULL;
+        return pool.reallocate(pointer, size);
     }
-    if (strlen(valuestring) <= strlen(object->valuestring))
+    if (size <= slab->slot_size)
     {
-        strcpy(object->valuestring, valuestring);
-        return object->valuestring;
+        return pointer;
     }
-    copy = (char*) cJSON_strdup((const unsigned char*)valuestring, &global_hooks);
-    if (copy == NULL)
+
+    /* grown out of its slot */
+    moved = pool.allocate(size);
+    if (moved == NULL)
     {
         return NULL;
     }
-    if (object->valuestring != NULL)
+    memcpy(moved, pointer, slab->slot_size);
+    pool_deallocate(pointer);
+
+    return moved;
+}
+
+/* uninstall the pool, the caller guarantees no item still lives in it */
+static void pool_release(void)
+{
+    if (pool.memory != NULL)
     {
-        cJSON_free(object->valuestring);
+        pool.deallocate(pool.memory);
     }
-    object->valuestring = copy;
-
-    return copy;
+    memset(&pool, '\0', sizeof(pool));
 }
 
-typedef struct
+CJSON_PUBLIC(size_t) cJSON_PoolMemorySize(const cJSON_PoolConfig *config)
 {
-    unsigned char *buffer;
-    size_t length;
-    size_t offset;
-    size_t depth; /* current nesting depth (for formatted printing) */
-    cJSON_bool noalloc;
-    cJSON_bool format; /* is this print a formatted print */
-    internal_hooks hooks;
-} printbuffer;
+    if (config == NULL)
+    {
+        return 0;
+    }
 
-/* realloc printbuffer if necessary to have at least "needed" bytes more */
-static unsigned char* ensure(printbuffer * const p, size_t needed)
+    return (CJSON_ARENA_ALIGNMENT - 1)
+        + (config->node_count * pool_slot_size(sizeof(cJSON)))
+        + (config->string_count * pool_slot_size(config->string_size));
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_InitHooksWithPool(cJSON_Hooks* hooks, const cJSON_PoolConfig *config)
 {
-    unsigned char *newbuffer = NULL;
-    size_t newsize = 0;
+    unsigned char *memory = NULL;
+    size_t padding = 0;
 
-    if ((p == NULL) || (p->buffer == NULL))
+    cJSON_InitHooks(hooks);
+    if (config == NULL)
     {
-        return NULL;
+        return false;
     }
 
-    if ((p->length > 0) && (p->offset >= p->length))
+    pool.allocate = global_hooks.allocate;
+    pool.deallocate = global_hooks.deallocate;
+    pool.reallocate = global_hooks.reallocate;
+
+    memory = (unsigned char*)config->memory;
+    if (memory == NULL)
     {
-        /* make sure that offset is valid */
-        return NULL;
+        profile_at(cJSON_SitePool);
+        memory = (unsigned char*)pool.allocate(cJSON_PoolMemorySize(config));
+        if (memory == NULL)
+        {
+            return false;
+        }
+        pool.memory = memory;
     }
 
-    if (needed > INT_MAX)
+    padding = (CJSON_ARENA_ALIGNMENT - ((size_t)memory % CJSON_ARENA_ALIGNMENT)) % CJSON_ARENA_ALIGNMENT;
+    memory = pool_slab_init(&pool.nodes, memory + padding, config->node_count, pool_slot_size(sizeof(cJSON)));
+    (void)pool_slab_init(&pool.strings, memory, config->string_count, pool_slot_size(config->string_size));
+    if (config->string_count == 0)
     {
-        /* sizes bigger than INT_MAX are currently not supported */
-        return NULL;
+        /* don't route small blocks to an empty slab */
+        pool.strings.slot_size = 0;
     }
 
-    needed += p->offset + 1;
-    if (needed <= p->length)
+    pool.lock = config->lock;
+    pool.unlock = config->unlock;
+    pool.lock_context = config->lock_context;
+
+    global_hooks.allocate = pool_allocate;
+    global_hooks.deallocate = pool_deallocate;
+    if (pool.reallocate != NULL)
     {
-        return p->buffer + p->offset;
+        global_hooks.reallocate = pool_reallocate;
     }
 
-    if (p->noalloc) {
-        return NULL;
+    return true;
+}
+
+CJSON_PUBLIC(void) cJSON_GetPoolStats(cJSON_PoolStats *nodes, cJSON_PoolStats *strings)
+{
+    pool_lock();
+    if (nodes != NULL)
+    {
+        *nodes = pool.nodes.stats;
+    }
+    if (strings != NULL)
+    {
+        *strings = pool.strings.stats;
     }
+    pool_unlock();
+}
 
-    /* calculate new buffer size */
-    if (needed > (INT_MAX / 2))
+#ifndef CJSON_OBJECT_INDEX_THRESHOLD
+/* objects with at least this many members get a hash index for case sensitive lookups, 0 disables it */
+#define CJSON_OBJECT_INDEX_THRESHOLD 8
+#endif
+
+typedef struct
+{
+    unsigned long hash;
+    cJSON *item;
+} object_index_slot;
+
+typedef struct
+{
+    size_t mask; /* number of slots - 1, the number of slots is a power of two */
+    object_index_slot *slots;
+} object_index;
+
+static void object_index_invalidate(cJSON * const object);
+
+/* whether the key of an item was allocated for it alone, so it goes when the item does */
+static cJSON_bool owns_key(const cJSON * const item)
+{
+    if (item->string == NULL)
     {
-        /* overflow of int, use INT_MAX if possible */
-        if (needed <= INT_MAX)
-        {
-            newsize = INT_MAX;
-        }
-        else
-        {
-            return NULL;
-        }
+        return false;
     }
-    else
+    if (item->type & cJSON_IsArena)
     {
-        newsize = needed * 2;
+        return (item->type & cJSON_ArenaKeyIsHeap) != 0;
     }
 
-    if (p->hooks.reallocate != NULL)
+    return !(item->type & cJSON_StringIsConst);
+}
+
+/* Delete a cJSON structure. */
+CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
+{
+    cJSON *next = NULL;
+    cJSON *last = NULL;
+    while (item != NULL)
     {
-        /* reallocate with realloc if available */
-        newbuffer = (unsigned char*)p->hooks.reallocate(p->buffer, newsize);
-        if (newbuffer == NULL)
+        next = item->next;
+        object_index_invalidate(item);
+        if (!(item->type & cJSON_IsReference) && (item->child != NULL))
         {
-            p->hooks.deallocate(p->buffer);
-            p->length = 0;
-            p->buffer = NULL;
-
-            return NULL;
+            /* instead of recursing, the members are queued in front of the rest of the chain */
+            for (last = item->child; last->next != NULL; last = last->next)
+            {
+            }
+            if (item->type & cJSON_IsArenaRoot)
+            {
+                /* the block holds the members, so the root comes around again to release it after them */
+                last->next = item;
+                next = item->child;
+                item->child = NULL;
+                item = next;
+                continue;
+            }
+            last->next = next;
+            next = item->child;
+        }
+        if (item->type & cJSON_IsArena)
+        {
+            /* arena items are released together with the block that holds them, a key added later is not in it */
+            if (owns_key(item))
+            {
+                global_hooks.deallocate(item->string);
+            }
+            if (item->type & cJSON_IsArenaRoot)
+            {
+                arena_release(arena_of_root(item));
+            }
+            item = next;
+            continue;
+        }
+        if (!(item->type & cJSON_IsReference) && (item->valuestring != NULL))
+        {
+            global_hooks.deallocate(item->valuestring);
+        }
+        if (owns_key(item))
+        {
+            global_hooks.deallocate(item->string);
         }
+        global_hooks.deallocate(item);
+        item = next;
     }
-    else
+}
+
+#ifndef CJSON_WALK_INLINE_DEPTH
+/* nesting levels parse, print, duplicate and compare track on the C stack, deeper documents move to a heap block */
+#define CJSON_WALK_INLINE_DEPTH 8
+#endif
+
+/* Explicit stack of fixed size frames for walking nested items without recursion, innermost last.
+ * It starts out in the caller's inline_frames and doubles into heap blocks from hooks. */
+typedef struct
+{
+    unsigned char *frames;
+    unsigned char *inline_frames;
+    size_t frame_size;
+    size_t depth; /* frames in use */
+    size_t size; /* frames that fit */
+    const internal_hooks *hooks;
+} walk_stack;
+
+#define walk_top(stack) ((void*)((stack)->frames + (((stack)->depth - 1) * (stack)->frame_size)))
+
+static void walk_init(walk_stack * const stack, void *inline_frames, size_t frame_size, const internal_hooks * const hooks)
+{
+    stack->frames = (unsigned char*)inline_frames;
+    stack->inline_frames = (unsigned char*)inline_frames;
+    stack->frame_size = frame_size;
+    stack->depth = 0;
+    stack->size = CJSON_WALK_INLINE_DEPTH;
+    stack->hooks = hooks;
+}
+
+/* returns the new top frame, NULL if the stack can't grow */
+static void *walk_push(walk_stack * const stack)
+{
+    if (stack->depth == stack->size)
     {
-        /* otherwise reallocate manually */
-        newbuffer = (unsigned char*)p->hooks.allocate(newsize);
-        if (!newbuffer)
-        {
-            p->hooks.deallocate(p->buffer);
-            p->length = 0;
-            p->buffer = NULL;
+        unsigned char *frames = NULL;
 
+        profile_at(cJSON_SiteWalk);
+        frames = (unsigned char*)stack->hooks->allocate(stack->size * 2 * stack->frame_size);
+        if (frames == NULL)
+        {
             return NULL;
         }
-
-        memcpy(newbuffer, p->buffer, p->offset + 1);
-        p->hooks.deallocate(p->buffer);
+        memcpy(frames, stack->frames, stack->depth * stack->frame_size);
+        if (stack->frames != stack->inline_frames)
+        {
+            stack->hooks->deallocate(stack->frames);
+        }
+        stack->frames = frames;
+        stack->size *= 2;
     }
-    p->length = newsize;
-    p->buffer = newbuffer;
+    stack->depth++;
 
-    return newbuffer + p->offset;
+    return walk_top(stack);
 }
 
-/* calculate the new length of the string in a printbuffer and update the offset */
-static void update_offset(printbuffer * const buffer)
+static void walk_release(walk_stack * const stack)
 {
-    const unsigned char *buffer_pointer = NULL;
-    if ((buffer == NULL) || (buffer->buffer == NULL))
+    if (stack->frames != stack->inline_frames)
     {
-        return;
+        stack->hooks->deallocate(stack->frames);
     }
-    buffer_pointer = buffer->buffer + buffer->offset;
-
-    buffer->offset += strlen((const char*)buffer_pointer);
+    stack->frames = stack->inline_frames;
+    stack->depth = 0;
 }
 
-/* securely comparison of floating-point variables */
-static cJSON_bool compare_double(double a, double b)
+/* get the decimal point character of the current locale */
+static unsigned char get_decimal_point(void)
 {
-    double maxVal = fabs(a) > fabs(b) ? fabs(a) : fabs(b);
-    return (fabs(a - b) <= maxVal * DBL_EPSILON);
+#ifdef ENABLE_LOCALES
+    struct lconv *lconv = localeconv();
+    return (unsigned char) lconv->decimal_point[0];
+#else
+    return '.';
+#endif
 }
 
-/* Render the number nicely from the given item into a string. */
-static cJSON_bool print_number(const cJSON * const item, printbuffer * const output_buffer)
+typedef struct
 {
-    unsigned char *output_pointer = NULL;
-    double d = item->valuedouble;
-    int length = 0;
+    const unsigned char *content;
+    size_t length;
+    size_t offset;
+    size_t depth; /* How deeply nested (in arrays/objects) is the input at the current offset. */
+    internal_hooks hooks;
+    arena_block *arena; /* NULL unless parsing into an arena */
+    cJSON_bool in_situ; /* unescape strings in place, content is writable */
+    int error; /* cJSON_Error* of a failure that isn't a syntax error */
+} parse_buffer;
+
+/* check if the given size is left to read in a given parse buffer (starting with 1) */
+#define can_read(buffer, size) ((buffer != NULL) && (((buffer)->offset + size) <= (buffer)->length))
+/* check if the buffer can be accessed at the given index (starting with 0) */
+#define can_access_at_index(buffer, index) ((buffer != NULL) && (((buffer)->offset + index) < (buffer)->length))
+#define cannot_access_at_index(buffer, index) (!can_access_at_index(buffer, index))
+/* get a pointer to the buffer at the position */
+#define buffer_at_offset(buffer) ((buffer)->content + (buffer)->offset)
+
+CJSON_PUBLIC(size_t) cJSON_ArenaSizeFor(const char *value, size_t buffer_length)
+{
+    /* every item is introduced by the start of the document, '[', '{' or ','
+     * and no string needs more than its quoted length in the input */
+    size_t items = 1;
+    size_t quotes = 0;
     size_t i = 0;
-    unsigned char number_buffer[26] = {0}; /* temporary buffer to print the number into */
-    unsigned char decimal_point = get_decimal_point();
-    double test = 0.0;
 
-    if (output_buffer == NULL)
+    if (value == NULL)
     {
-        return false;
+        return 0;
     }
 
-    /* This checks for NaN and Infinity */
-    if (isnan(d) || isinf(d))
-    {
-        length = sprintf((char*)number_buffer, "null");
-    }
-	else if(d == (double)item->valueint)
-	{
-		length = sprintf((char*)number_buffer, "%d", item->valueint);
-	}
-    else
+    for (i = 0; i < buffer_length; i++)
     {
-        /* Try 15 decimal places of precision to avoid nonsignificant nonzero digits */
-        length = sprintf((char*)number_buffer, "%1.15g", d);
-
-        /* Check whether the original double can be recovered */
-        if ((sscanf((char*)number_buffer, "%lg", &test) != 1) || !compare_double((double)test, d))
+        switch (value[i])
         {
-            /* If not, print with 17 decimal places of precision */
-            length = sprintf((char*)number_buffer, "%1.17g", d);
+            case '[':
+            case '{':
+            case ',':
+                items++;
+                break;
+
+            case '\"':
+                quotes++;
+                break;
+
+            default:
+                break;
         }
     }
 
-    /* sprintf failed or buffer overrun occurred */
-    if ((length < 0) || (length > (int)(sizeof(number_buffer) - 1)))
-    {
-        return false;
-    }
+    return (CJSON_ARENA_ALIGNMENT - 1) + arena_header_size
+        + (items * arena_align(sizeof(cJSON)))
+        + buffer_length + (((quotes / 2) + 1) * CJSON_ARENA_ALIGNMENT);
+}
 
-    /* reserve appropriate space in the output */
-    output_pointer = ensure(output_buffer, (size_t)length + sizeof(""));
-    if (output_pointer == NULL)
-    {
-        return false;
-    }
+/* take size bytes from the arena of the parse buffer, chaining a heap block when it runs out */
+static void *arena_allocate(parse_buffer * const input_buffer, size_t size)
+{
+    arena_block *block = input_buffer->arena->current;
+    unsigned char *memory = NULL;
 
-    /* copy the printed number to the output and replace locale
-     * dependent decimal point with '.' */
-    for (i = 0; i < ((size_t)length); i++)
+    size = arena_align(size);
+    if ((block->size - block->used) < size)
     {
-        if (number_buffer[i] == decimal_point)
+        /* only a caller provided block can run out, so chain one that fits the whole document */
+        size_t block_size = cJSON_ArenaSizeFor((const char*)input_buffer->content, input_buffer->length);
+        arena_block *new_block = NULL;
+
+        if (block_size < (size + arena_header_size + CJSON_ARENA_ALIGNMENT))
         {
-            output_pointer[i] = '.';
-            continue;
+            block_size = size + arena_header_size + CJSON_ARENA_ALIGNMENT;
+        }
+
+        profile_at(cJSON_SiteArena);
+        memory = (unsigned char*)input_buffer->hooks.allocate(block_size);
+        new_block = arena_init(memory, block_size, input_buffer->hooks.deallocate);
+        if (new_block == NULL)
+        {
+            if (memory != NULL)
+            {
+                input_buffer->hooks.deallocate(memory);
+            }
+            return NULL;
         }
 
-        output_pointer[i] = number_buffer[i];
+        block->next = new_block;
+        input_buffer->arena->current = new_block;
+        block = new_block;
     }
-    output_pointer[i] = '\0';
 
-    output_buffer->offset += (size_t)length;
+    memory = arena_data(block) + block->used;
+    block->used += size;
 
-    return true;
+    return memory;
 }
 
-/* parse 4 digit hexadecimal number */
-static unsigned parse_hex4(const unsigned char * const input)
+/* Parsed items are created with their ownership flags already set,
+ * which is why the parser only ever ORs the type into item->type. */
+static cJSON *parse_new_item(parse_buffer * const input_buffer)
 {
-    unsigned int h = 0;
-    size_t i = 0;
+    cJSON *node = NULL;
 
-    for (i = 0; i < 4; i++)
+    if (input_buffer->arena == NULL)
     {
-        /* parse digit */
-        if ((input[i] >= '0') && (input[i] <= '9'))
-        {
-            h += (unsigned int) input[i] - '0';
+        node = cJSON_New_Item(&(input_buffer->hooks));
+    }
+    else
+    {
+        node = (cJSON*)arena_allocate(input_buffer, sizeof(cJSON));
+        if (node)
+        {
+            memset(node, '\0', sizeof(cJSON));
+            node->type = cJSON_IsArena;
+        }
+    }
+
+    if (node == NULL)
+    {
+        input_buffer->error = cJSON_ErrorMemory;
+    }
+
+    return node;
+}
+
+static void *parse_allocate(parse_buffer * const input_buffer, size_t size)
+{
+    void *memory = NULL;
+
+    if (input_buffer->arena != NULL)
+    {
+        memory = arena_allocate(input_buffer, size);
+    }
+    else
+    {
+        memory = input_buffer->hooks.allocate(size);
+    }
+
+    if (memory == NULL)
+    {
+        input_buffer->error = cJSON_ErrorMemory;
+    }
+
+    return memory;
+}
+
+static void parse_deallocate(parse_buffer * const input_buffer, void *pointer)
+{
+    /* arena memory is only ever released as a whole */
+    if (input_buffer->arena == NULL)
+    {
+        input_buffer->hooks.deallocate(pointer);
+    }
+}
+
+/* saturating conversions of a parsed number for valueint and valueint64 */
+static int int_from_double(double number)
+{
+    if (number >= INT_MAX)
+    {
+        return INT_MAX;
+    }
+    else if (number <= (double)INT_MIN)
+    {
+        return INT_MIN;
+    }
+
+    return (int)number;
+}
+
+static int int_from_int64(int64_t number)
+{
+    if (number >= INT_MAX)
+    {
+        return INT_MAX;
+    }
+    else if (number <= INT_MIN)
+    {
+        return INT_MIN;
+    }
+
+    return (int)number;
+}
+
+static int64_t int64_from_double(double number)
+{
+    if (number >= 9223372036854775807.0)
+    {
+        return INT64_MAX;
+    }
+    else if (number <= -9223372036854775808.0)
+    {
+        return INT64_MIN;
+    }
+
+    return (int64_t)number;
+}
+
+/* Fast path for tokens that are plain integers: no scratch copy, no locale and no strtod.
+ * Returns false without consuming anything if the token has a fraction or an exponent or doesn't fit in 64 bits. */
+static cJSON_bool parse_integer(cJSON * const item, parse_buffer * const input_buffer)
+{
+    const unsigned char *number = buffer_at_offset(input_buffer);
+    size_t length = input_buffer->length - input_buffer->offset;
+    cJSON_bool negative = false;
+    uint64_t magnitude = 0;
+    size_t i = 0;
+
+    if (number[0] == '-')
+    {
+        negative = true;
+        i++;
+    }
+
+    if ((i >= length) || (number[i] < '0') || (number[i] > '9'))
+    {
+        return false;
+    }
+
+    for (; (i < length) && (number[i] >= '0') && (number[i] <= '9'); i++)
+    {
+        unsigned int digit = (unsigned int)(number[i] - '0');
+        if (magnitude > ((UINT64_MAX - digit) / 10))
+        {
+            return false; /* leave big numbers to strtod */
+        }
+        magnitude = (magnitude * 10) + digit;
+    }
+
+    if ((i < length) && ((number[i] == '.') || (number[i] == 'e') || (number[i] == 'E')))
+    {
+        return false;
+    }
+
+    if (negative)
+    {
+        if (magnitude > ((uint64_t)INT64_MAX + 1))
+        {
+            return false;
+        }
+        item->valueint64 = (magnitude == ((uint64_t)INT64_MAX + 1)) ? INT64_MIN : -(int64_t)magnitude;
+    }
+    else
+    {
+        if (magnitude > (uint64_t)INT64_MAX)
+        {
+            return false;
+        }
+        item->valueint64 = (int64_t)magnitude;
+    }
+
+    item->valuedouble = (double)item->valueint64;
+    item->valueint = int_from_int64(item->valueint64);
+
+    item->type |= cJSON_Number | cJSON_NumberIsInt64;
+
+    input_buffer->offset += i;
+    return true;
+}
+
+/* Parse the input text to generate a number, and populate the result into item. */
+static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_buffer)
+{
+    double number = 0;
+    unsigned char *after_end = NULL;
+    unsigned char number_c_string[64];
+    unsigned char decimal_point = '.';
+    size_t i = 0;
+
+    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    {
+        return false;
+    }
+
+    if (parse_integer(item, input_buffer))
+    {
+        return true;
+    }
+
+    decimal_point = get_decimal_point();
+
+    /* copy the number into a temporary buffer and replace '.' with the decimal point
+     * of the current locale (for strtod)
+     * This also takes care of '\0' not necessarily being available for marking the end of the input */
+    for (i = 0; (i < (sizeof(number_c_string) - 1)) && can_access_at_index(input_buffer, i); i++)
+    {
+        switch (buffer_at_offset(input_buffer)[i])
+        {
+            case '0':
+            case '1':
+            case '2':
+            case '3':
+            case '4':
+            case '5':
+            case '6':
+            case '7':
+            case '8':
+            case '9':
+            case '+':
+            case '-':
+            case 'e':
+            case 'E':
+                number_c_string[i] = buffer_at_offset(input_buffer)[i];
+                break;
+
+            case '.':
+                number_c_string[i] = decimal_point;
+                break;
+
+            default:
+                goto loop_end;
+        }
+    }
+loop_end:
+    number_c_string[i] = '\0';
+
+    number = strtod((const char*)number_c_string, (char**)&after_end);
+    if (number_c_string == after_end)
+    {
+        return false; /* parse_error */
+    }
+
+    item->valuedouble = number;
+
+    /* use saturation in case of overflow */
+    item->valueint = int_from_double(number);
+    item->valueint64 = int64_from_double(number);
+
+    item->type |= cJSON_Number;
+
+    input_buffer->offset += (size_t)(after_end - number_c_string);
+    return true;
+}
+
+/* don't ask me, but the original cJSON_SetNumberValue returns an integer or double */
+CJSON_PUBLIC(double) cJSON_SetNumberHelper(cJSON *object, double number)
+{
+    object->valueint = int_from_double(number);
+    object->valueint64 = int64_from_double(number);
+    object->type &= ~cJSON_NumberIsInt64;
+
+    return object->valuedouble = number;
+}
+
+CJSON_PUBLIC(int64_t) cJSON_SetIntHelper(cJSON *object, int64_t number)
+{
+    object->valueint = int_from_int64(number);
+    object->valuedouble = (double)number;
+    object->type |= cJSON_NumberIsInt64;
+
+    return object->valueint64 = number;
+}
+
+CJSON_PUBLIC(char*) cJSON_SetValuestring(cJSON *object, const char *valuestring)
+{
+    char *copy = NULL;
+    /* if object's type is not cJSON_String or is cJSON_IsReference, it should not set valuestring */
+    if ((object == NULL) || !(object->type & cJSON_String) || (object->type & cJSON_IsReference))
+    {
+        return NULL;
+    }
+    /* return NULL if the object is corrupted */
+    if (object->valuestring == NULL)
+    {
+        return NULL;
+    }
+    if (strlen(valuestring) <= strlen(object->valuestring))
+    {
+        strcpy(object->valuestring, valuestring);
+        return object->valuestring;
+    }
+    if (object->type & cJSON_IsArena)
+    {
+        /* arena strings can't be reallocated */
+        return NULL;
+    }
+    copy = (char*) cJSON_strdup((const unsigned char*)valuestring, &global_hooks);
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    if (object->valuestring != NULL)
+    {
+        cJSON_free(object->valuestring);
+    }
+    object->valuestring = copy;
+
+    return copy;
+}
+
+typedef struct
+{
+    unsigned char *buffer;
+    size_t length;
+    size_t offset;
+    size_t depth; /* current nesting depth (for formatted printing) */
+    cJSON_bool noalloc;
+    cJSON_bool format; /* is this print a formatted print */
+    internal_hooks hooks;
+    cJSON_PrintSink sink; /* when set, full buffers are handed to it instead of growing */
+    void *sink_context;
+} printbuffer;
+
+/* hand everything printed so far to the sink and start over at the beginning of the buffer */
+static cJSON_bool flush_print_buffer(printbuffer * const p)
+{
+    if ((p->offset > 0) && !p->sink((const char*)p->buffer, p->offset, p->sink_context))
+    {
+        return false;
+    }
+    p->offset = 0;
+    p->buffer[0] = '\0';
+
+    return true;
+}
+
+/* realloc printbuffer if necessary to have at least "needed" bytes more */
+static unsigned char* ensure(printbuffer * const p, size_t needed)
+{
+    unsigned char *newbuffer = NULL;
+    size_t newsize = 0;
+
+    if ((p == NULL) || (p->buffer == NULL))
+    {
+        return NULL;
+    }
+
+    if ((p->length > 0) && (p->offset >= p->length))
+    {
+        /* make sure that offset is valid */
+        return NULL;
+    }
+
+    if (needed > INT_MAX)
+    {
+        /* sizes bigger than INT_MAX are currently not supported */
+        return NULL;
+    }
+
+    needed += p->offset + 1;
+    if (needed <= p->length)
+    {
+        return p->buffer + p->offset;
+    }
+
+    if (p->sink != NULL)
+    {
+        /* make room by flushing, the buffer itself never grows */
+        if ((needed - p->offset > p->length) || !flush_print_buffer(p))
+        {
+            return NULL;
+        }
+
+        return p->buffer;
+    }
+
+    if (p->noalloc) {
+        return NULL;
+    }
+
+    /* calculate new buffer size */
+    if (needed > (INT_MAX / 2))
+    {
+        /* overflow of int, use INT_MAX if possible */
+        if (needed <= INT_MAX)
+        {
+            newsize = INT_MAX;
+        }
+        else
+        {
+            return NULL;
+        }
+    }
+    else
+    {
+        newsize = needed * 2;
+    }
+
+    if (p->hooks.reallocate != NULL)
+    {
+        /* reallocate with realloc if available */
+        newbuffer = (unsigned char*)p->hooks.reallocate(p->buffer, newsize);
+        if (newbuffer == NULL)
+        {
+            p->hooks.deallocate(p->buffer);
+            p->length = 0;
+            p->buffer = NULL;
+
+            return NULL;
+        }
+    }
+    else
+    {
+        /* otherwise reallocate manually */
+        profile_at(cJSON_SitePrint);
+        newbuffer = (unsigned char*)p->hooks.allocate(newsize);
+        if (!newbuffer)
+        {
+            p->hooks.deallocate(p->buffer);
+            p->length = 0;
+            p->buffer = NULL;
+
+            return NULL;
+        }
+
+        memcpy(newbuffer, p->buffer, p->offset + 1);
+        p->hooks.deallocate(p->buffer);
+    }
+    p->length = newsize;
+    p->buffer = newbuffer;
+
+    return newbuffer + p->offset;
+}
+
+/* calculate the new length of the string in a printbuffer and update the offset */
+static void update_offset(printbuffer * const buffer)
+{
+    const unsigned char *buffer_pointer = NULL;
+    if ((buffer == NULL) || (buffer->buffer == NULL))
+    {
+        return;
+    }
+    buffer_pointer = buffer->buffer + buffer->offset;
+
+    buffer->offset += strlen((const char*)buffer_pointer);
+}
+
+/* append length bytes, piece by piece when printing to a sink so they don't have to fit the buffer at once */
+static cJSON_bool print_bytes(printbuffer * const output_buffer, const unsigned char *bytes, size_t length)
+{
+    unsigned char *output = NULL;
+    size_t piece = 0;
+
+    if (output_buffer->sink == NULL)
+    {
+        output = ensure(output_buffer, length + sizeof(""));
+        if (output == NULL)
+        {
+            return false;
+        }
+        memcpy(output, bytes, length);
+        output[length] = '\0';
+        output_buffer->offset += length;
+
+        return true;
+    }
+
+    while (length > 0)
+    {
+        piece = output_buffer->length - output_buffer->offset - 1;
+        if (piece == 0)
+        {
+            if (!flush_print_buffer(output_buffer))
+            {
+                return false;
+            }
+            continue;
+        }
+        if (piece > length)
+        {
+            piece = length;
+        }
+        memcpy(output_buffer->buffer + output_buffer->offset, bytes, piece);
+        output_buffer->offset += piece;
+        bytes += piece;
+        length -= piece;
+    }
+    output_buffer->buffer[output_buffer->offset] = '\0';
+
+    return true;
+}
+
+/* print count tabs of indentation */
+static cJSON_bool print_indentation(printbuffer * const output_buffer, size_t count)
+{
+    static const unsigned char tabs[] = "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+    unsigned char *output = NULL;
+
+    if (output_buffer->sink == NULL)
+    {
+        output = ensure(output_buffer, count + sizeof(""));
+        if (output == NULL)
+        {
+            return false;
+        }
+        memset(output, '\t', count);
+        output[count] = '\0';
+        output_buffer->offset += count;
+
+        return true;
+    }
+
+    for (; count > sizeof(tabs) - 1; count -= sizeof(tabs) - 1)
+    {
+        if (!print_bytes(output_buffer, tabs, sizeof(tabs) - 1))
+        {
+            return false;
+        }
+    }
+
+    return print_bytes(output_buffer, tabs, count);
+}
+
+/* securely comparison of floating-point variables */
+static cJSON_bool compare_double(double a, double b)
+{
+    double maxVal = fabs(a) > fabs(b) ? fabs(a) : fabs(b);
+    return (fabs(a - b) <= maxVal * DBL_EPSILON);
+}
+
+/* Shortest round-trip formatting of doubles using the Grisu2 algorithm by Florian Loitsch
+ * ("Printing Floating-Point Numbers Quickly and Accurately with Integers").
+ * A number is a 64 bit significand f and a binary exponent e, i.e. f * 2^e. */
+typedef struct
+{
+    uint64_t f;
+    int e;
+} diy_fp;
+
+/* significands of 10^k for k = -300, -292, ..., 324, normalized so bit 63 is set, split into 32 bit halves */
+typedef struct
+{
+    unsigned long high;
+    unsigned long low;
+    int binary_exponent;
+    int decimal_exponent;
+} cached_power;
+
+#define CACHED_POWERS_MIN_DECIMAL_EXPONENT (-300)
+#define CACHED_POWERS_DECIMAL_STEP 8
+/* target range of the binary exponent of the scaled boundaries */
+#define GRISU_ALPHA (-60)
+
+static const cached_power cached_powers[] =
+{
+    { 0xAB70FE17UL, 0xC79AC6CAUL, -1060, -300 },
+    { 0xFF77B1FCUL, 0xBEBCDC4FUL, -1034, -292 },
+    { 0xBE5691EFUL, 0x416BD60CUL, -1007, -284 },
+    { 0x8DD01FADUL, 0x907FFC3CUL, -980, -276 },
+    { 0xD3515C28UL, 0x31559A83UL, -954, -268 },
+    { 0x9D71AC8FUL, 0xADA6C9B5UL, -927, -260 },
+    { 0xEA9C2277UL, 0x23EE8BCBUL, -901, -252 },
+    { 0xAECC4991UL, 0x4078536DUL, -874, -244 },
+    { 0x823C1279UL, 0x5DB6CE57UL, -847, -236 },
+    { 0xC2109436UL, 0x4DFB5637UL, -821, -228 },
+    { 0x9096EA6FUL, 0x3848984FUL, -794, -220 },
+    { 0xD77485CBUL, 0x25823AC7UL, -768, -212 },
+    { 0xA086CFCDUL, 0x97BF97F4UL, -741, -204 },
+    { 0xEF340A98UL, 0x172AACE5UL, -715, -196 },
+    { 0xB23867FBUL, 0x2A35B28EUL, -688, -188 },
+    { 0x84C8D4DFUL, 0xD2C63F3BUL, -661, -180 },
+    { 0xC5DD4427UL, 0x1AD3CDBAUL, -635, -172 },
+    { 0x936B9FCEUL, 0xBB25C996UL, -608, -164 },
+    { 0xDBAC6C24UL, 0x7D62A584UL, -582, -156 },
+    { 0xA3AB6658UL, 0x0D5FDAF6UL, -555, -148 },
+    { 0xF3E2F893UL, 0xDEC3F126UL, -529, -140 },
+    { 0xB5B5ADA8UL, 0xAAFF80B8UL, -502, -132 },
+    { 0x87625F05UL, 0x6C7C4A8BUL, -475, -124 },
+    { 0xC9BCFF60UL, 0x34C13053UL, -449, -116 },
+    { 0x964E858CUL, 0x91BA2655UL, -422, -108 },
+    { 0xDFF97724UL, 0x70297EBDUL, -396, -100 },
+    { 0xA6DFBD9FUL, 0xB8E5B88FUL, -369, -92 },
+    { 0xF8A95FCFUL, 0x88747D94UL, -343, -84 },
+    { 0xB9447093UL, 0x8FA89BCFUL, -316, -76 },
+    { 0x8A08F0F8UL, 0xBF0F156BUL, -289, -68 },
+    { 0xCDB02555UL, 0x653131B6UL, -263, -60 },
+    { 0x993FE2C6UL, 0xD07B7FACUL, -236, -52 },
+    { 0xE45C10C4UL, 0x2A2B3B06UL, -210, -44 },
+    { 0xAA242499UL, 0x697392D3UL, -183, -36 },
+    { 0xFD87B5F2UL, 0x8300CA0EUL, -157, -28 },
+    { 0xBCE50864UL, 0x92111AEBUL, -130, -20 },
+    { 0x8CBCCC09UL, 0x6F5088CCUL, -103, -12 },
+    { 0xD1B71758UL, 0xE219652CUL, -77, -4 },
+    { 0x9C400000UL, 0x00000000UL, -50, 4 },
+    { 0xE8D4A510UL, 0x00000000UL, -24, 12 },
+    { 0xAD78EBC5UL, 0xAC620000UL, 3, 20 },
+    { 0x813F3978UL, 0xF8940984UL, 30, 28 },
+    { 0xC097CE7BUL, 0xC90715B3UL, 56, 36 },
+    { 0x8F7E32CEUL, 0x7BEA5C70UL, 83, 44 },
+    { 0xD5D238A4UL, 0xABE98068UL, 109, 52 },
+    { 0x9F4F2726UL, 0x179A2245UL, 136, 60 },
+    { 0xED63A231UL, 0xD4C4FB27UL, 162, 68 },
+    { 0xB0DE6538UL, 0x8CC8ADA8UL, 189, 76 },
+    { 0x83C7088EUL, 0x1AAB65DBUL, 216, 84 },
+    { 0xC45D1DF9UL, 0x42711D9AUL, 242, 92 },
+    { 0x924D692CUL, 0xA61BE758UL, 269, 100 },
+    { 0xDA01EE64UL, 0x1A708DEAUL, 295, 108 },
+    { 0xA26DA399UL, 0x9AEF774AUL, 322, 116 },
+    { 0xF209787BUL, 0xB47D6B85UL, 348, 124 },
+    { 0xB454E4A1UL, 0x79DD1877UL, 375, 132 },
+    { 0x865B8692UL, 0x5B9BC5C2UL, 402, 140 },
+    { 0xC83553C5UL, 0xC8965D3DUL, 428, 148 },
+    { 0x952AB45CUL, 0xFA97A0B3UL, 455, 156 },
+    { 0xDE469FBDUL, 0x99A05FE3UL, 481, 164 },
+    { 0xA59BC234UL, 0xDB398C25UL, 508, 172 },
+    { 0xF6C69A72UL, 0xA3989F5CUL, 534, 180 },
+    { 0xB7DCBF53UL, 0x54E9BECEUL, 561, 188 },
+    { 0x88FCF317UL, 0xF22241E2UL, 588, 196 },
+    { 0xCC20CE9BUL, 0xD35C78A5UL, 614, 204 },
+    { 0x98165AF3UL, 0x7B2153DFUL, 641, 212 },
+    { 0xE2A0B5DCUL, 0x971F303AUL, 667, 220 },
+    { 0xA8D9D153UL, 0x5CE3B396UL, 694, 228 },
+    { 0xFB9B7CD9UL, 0xA4A7443CUL, 720, 236 },
+    { 0xBB764C4CUL, 0xA7A44410UL, 747, 244 },
+    { 0x8BAB8EEFUL, 0xB6409C1AUL, 774, 252 },
+    { 0xD01FEF10UL, 0xA657842CUL, 800, 260 },
+    { 0x9B10A4E5UL, 0xE9913129UL, 827, 268 },
+    { 0xE7109BFBUL, 0xA19C0C9DUL, 853, 276 },
+    { 0xAC2820D9UL, 0x623BF429UL, 880, 284 },
+    { 0x80444B5EUL, 0x7AA7CF85UL, 907, 292 },
+    { 0xBF21E440UL, 0x03ACDD2DUL, 933, 300 },
+    { 0x8E679C2FUL, 0x5E44FF8FUL, 960, 308 },
+    { 0xD433179DUL, 0x9C8CB841UL, 986, 316 },
+    { 0x9E19DB92UL, 0xB4E31BA9UL, 1013, 324 }
+};
+
+static diy_fp diy_fp_make(uint64_t f, int e)
+{
+    diy_fp number;
+    number.f = f;
+    number.e = e;
+
+    return number;
+}
+
+/* x * y rounded to 64 bits, computed with 32 bit partial products */
+static diy_fp diy_fp_multiply(const diy_fp x, const diy_fp y)
+{
+    const uint64_t x_low = x.f & 0xFFFFFFFFUL;
+    const uint64_t x_high = x.f >> 32;
+    const uint64_t y_low = y.f & 0xFFFFFFFFUL;
+    const uint64_t y_high = y.f >> 32;
+    const uint64_t low_low = x_low * y_low;
+    const uint64_t low_high = x_low * y_high;
+    const uint64_t high_low = x_high * y_low;
+    const uint64_t high_high = x_high * y_high;
+    uint64_t middle = (low_low >> 32) + (low_high & 0xFFFFFFFFUL) + (high_low & 0xFFFFFFFFUL);
+
+    middle += (uint64_t)1 << 31; /* round, ties up */
+
+    return diy_fp_make(high_high + (low_high >> 32) + (high_low >> 32) + (middle >> 32), x.e + y.e + 64);
+}
+
+static diy_fp diy_fp_normalize(diy_fp number)
+{
+    while ((number.f >> 63) == 0)
+    {
+        number.f <<= 1;
+        number.e--;
+    }
+
+    return number;
+}
+
+/* Decompose value into its significand and the boundaries halfway to its neighbours. */
+static void grisu_boundaries(double value, diy_fp * const v, diy_fp * const minus, diy_fp * const plus)
+{
+    const uint64_t hidden_bit = (uint64_t)1 << 52;
+    uint64_t bits = 0;
+    uint64_t fraction = 0;
+    int exponent = 0;
+
+    memcpy(&bits, &value, sizeof(bits));
+    fraction = bits & (hidden_bit - 1);
+    exponent = (int)((bits >> 52) & 0x7FF);
+
+    if (exponent == 0)
+    {
+        /* subnormal */
+        *v = diy_fp_make(fraction, 1 - 1075);
+    }
+    else
+    {
+        *v = diy_fp_make(fraction + hidden_bit, exponent - 1075);
+    }
+
+    *plus = diy_fp_normalize(diy_fp_make((2 * v->f) + 1, v->e - 1));
+    if ((fraction == 0) && (exponent > 1))
+    {
+        /* the lower neighbour is closer at a power of two */
+        *minus = diy_fp_make((4 * v->f) - 1, v->e - 2);
+    }
+    else
+    {
+        *minus = diy_fp_make((2 * v->f) - 1, v->e - 1);
+    }
+    minus->f <<= minus->e - plus->e;
+    minus->e = plus->e;
+
+    *v = diy_fp_normalize(*v);
+}
+
+/* Nudge the last digit towards w as long as the result stays within the boundaries, then tell whether the
+ * digits are certainly the closest shortest ones. The scaled w and boundaries are only known to within unit
+ * of the exact values, distance and delta are taken from the boundary widened by unit (Grisu3's round_weed). */
+static cJSON_bool grisu_round_weed(unsigned char * const buffer, size_t length, uint64_t distance, uint64_t delta, uint64_t rest, uint64_t ten_k, uint64_t unit)
+{
+    const uint64_t small_distance = distance - unit;
+    const uint64_t big_distance = distance + unit;
+
+    while ((rest < small_distance) && ((delta - rest) >= ten_k)
+        && (((rest + ten_k) < small_distance) || ((small_distance - rest) >= (rest + ten_k - small_distance))))
+    {
+        buffer[length - 1]--;
+        rest += ten_k;
+    }
+
+    /* one more step could also be closer to the exact w, the digits can't be trusted */
+    if ((rest < big_distance) && ((delta - rest) >= ten_k)
+        && (((rest + ten_k) < big_distance) || ((big_distance - rest) > (rest + ten_k - big_distance))))
+    {
+        return false;
+    }
+
+    /* inside the boundaries even for the most unfavourable error */
+    return ((2 * unit) <= rest) && (rest <= (delta - (4 * unit)));
+}
+
+/* Generate the shortest digits of the double into buffer (at most 17), value = digits * 10^decimal_exponent.
+ * Returns 0 in the rare cases (about 0.5% of doubles) where the error of the scaled values leaves it unsure
+ * that the digits are the shortest ones that read back as the double. */
+static size_t grisu_digits(double value, unsigned char * const buffer, int * const decimal_exponent)
+{
+    diy_fp v;
+    diy_fp minus;
+    diy_fp plus;
+    diy_fp w;
+    diy_fp upper;
+    diy_fp lower;
+    diy_fp one;
+    const cached_power *cached = NULL;
+    uint64_t fractional = 0;
+    uint64_t delta = 0;
+    uint64_t unit = 1;
+    unsigned long integral = 0;
+    unsigned long power = 1;
+    size_t length = 0;
+    int remaining_digits = 1;
+    int k = 0;
+
+    grisu_boundaries(value, &v, &minus, &plus);
+
+    /* pick a cached power of ten that brings the exponent of the upper boundary into [alpha, alpha + 28] */
+    k = GRISU_ALPHA - plus.e - 1;
+    k = ((k * 78913) / (1 << 18)) + ((k > 0) ? 1 : 0);
+    cached = &cached_powers[(-CACHED_POWERS_MIN_DECIMAL_EXPONENT + k + (CACHED_POWERS_DECIMAL_STEP - 1)) / CACHED_POWERS_DECIMAL_STEP];
+    {
+        const diy_fp power_of_ten = diy_fp_make(((uint64_t)cached->high << 32) | (uint64_t)cached->low, cached->binary_exponent);
+        w = diy_fp_multiply(v, power_of_ten);
+        lower = diy_fp_multiply(minus, power_of_ten);
+        upper = diy_fp_multiply(plus, power_of_ten);
+    }
+    *decimal_exponent = -cached->decimal_exponent;
+
+    /* each product is off by less than unit, widen the interval by that much and weed out the unsure digits later */
+    lower.f -= unit;
+    upper.f += unit;
+
+    one = diy_fp_make((uint64_t)1 << -upper.e, upper.e);
+    integral = (unsigned long)(upper.f >> -one.e);
+    fractional = upper.f & (one.f - 1);
+    delta = upper.f - lower.f;
+
+    /* integral part has at most 10 digits */
+    while ((power * 10) <= integral)
+    {
+        power *= 10;
+        remaining_digits++;
+        if (power == 1000000000UL)
+        {
+            break;
+        }
+    }
+
+    while (remaining_digits > 0)
+    {
+        uint64_t rest = 0;
+
+        buffer[length++] = (unsigned char)('0' + (integral / power));
+        integral %= power;
+        remaining_digits--;
+
+        rest = ((uint64_t)integral << -one.e) + fractional;
+        if (rest < delta)
+        {
+            *decimal_exponent += remaining_digits;
+            return grisu_round_weed(buffer, length, upper.f - w.f, delta, rest, (uint64_t)power << -one.e, unit) ? length : 0;
+        }
+        power /= 10;
+    }
+
+    for (;;)
+    {
+        fractional *= 10;
+        delta *= 10;
+        unit *= 10;
+
+        buffer[length++] = (unsigned char)('0' + (fractional >> -one.e));
+        fractional &= one.f - 1;
+        (*decimal_exponent)--;
+
+        if (fractional < delta)
+        {
+            break;
+        }
+    }
+
+    return grisu_round_weed(buffer, length, (upper.f - w.f) * unit, delta, fractional, one.f, unit) ? length : 0;
+}
+
+/* Print a finite, nonzero double. The Grisu digits of a normal double are the shortest that read back as
+ * it, and the closest of those. With 15 or fewer they are exactly what %1.15g rounds to, and they are
+ * laid out the way %1.15g would. With 16 or 17 the 15 digit form didn't read back, so %1.17g was used
+ * before. These are laid out the way %1.17g would, and 17 digits are its text, while 16 print one digit
+ * shorter. Where Grisu can't be sure of its digits, and for subnormals whose ulp is wider than a 15
+ * digit step (so the shortest digits needn't be the %1.15g ones), the double is printed as before:
+ * %1.15g if that reads back as the same double, %1.17g if it doesn't. */
+static int print_double(unsigned char * const buffer, double number)
+{
+    unsigned char digits[18];
+    unsigned char decimal_point = '.';
+    size_t digit_count = 0;
+    int decimal_exponent = 0;
+    int exponent = 0;
+    int precision = 15;
+    int length = 0;
+    int i = 0;
+
+    if (fabs(number) >= DBL_MIN)
+    {
+        digit_count = grisu_digits(fabs(number), digits, &decimal_exponent);
+    }
+    if (digit_count == 0)
+    {
+        length = sprintf((char*)buffer, "%1.15g", number);
+        if (strtod((const char*)buffer, NULL) != number)
+        {
+            length = sprintf((char*)buffer, "%1.17g", number);
+        }
+        /* replace the locale dependent decimal point with '.' */
+        decimal_point = get_decimal_point();
+        for (i = 0; i < length; i++)
+        {
+            if (buffer[i] == decimal_point)
+            {
+                buffer[i] = '.';
+            }
+        }
+
+        return length;
+    }
+    if (digit_count > 15)
+    {
+        precision = 17;
+    }
+
+    if (number < 0)
+    {
+        buffer[length++] = '-';
+    }
+    /* exponent of the first digit */
+    exponent = (int)digit_count + decimal_exponent - 1;
+
+    if ((exponent < -4) || (exponent >= precision))
+    {
+        /* d.ddde+XX */
+        buffer[length++] = digits[0];
+        if (digit_count > 1)
+        {
+            buffer[length++] = '.';
+            memcpy(buffer + length, digits + 1, digit_count - 1);
+            length += (int)digit_count - 1;
+        }
+        buffer[length++] = 'e';
+        buffer[length++] = (exponent < 0) ? '-' : '+';
+        if (exponent < 0)
+        {
+            exponent = -exponent;
+        }
+        if (exponent >= 100)
+        {
+            buffer[length++] = (unsigned char)('0' + (exponent / 100));
+        }
+        buffer[length++] = (unsigned char)('0' + ((exponent / 10) % 10));
+        buffer[length++] = (unsigned char)('0' + (exponent % 10));
+    }
+    else if (exponent < 0)
+    {
+        /* 0.000ddd */
+        buffer[length++] = '0';
+        buffer[length++] = '.';
+        for (i = -1; i > exponent; i--)
+        {
+            buffer[length++] = '0';
+        }
+        memcpy(buffer + length, digits, digit_count);
+        length += (int)digit_count;
+    }
+    else if ((int)digit_count <= (exponent + 1))
+    {
+        /* ddd000 */
+        memcpy(buffer + length, digits, digit_count);
+        length += (int)digit_count;
+        for (i = (int)digit_count; i <= exponent; i++)
+        {
+            buffer[length++] = '0';
+        }
+    }
+    else
+    {
+        /* ddd.ddd */
+        memcpy(buffer + length, digits, (size_t)exponent + 1);
+        length += exponent + 1;
+        buffer[length++] = '.';
+        memcpy(buffer + length, digits + exponent + 1, digit_count - (size_t)exponent - 1);
+        length += (int)digit_count - exponent - 1;
+    }
+    buffer[length] = '\0';
+
+    return length;
+}
+
+/* format a 64 bit integer without relying on printf's long long support */
+static int print_int64(unsigned char * const buffer, int64_t number)
+{
+    unsigned char digits[21];
+    uint64_t magnitude = (number < 0) ? ((uint64_t)0 - (uint64_t)number) : (uint64_t)number;
+    int length = 0;
+    int i = 0;
+
+    do
+    {
+        digits[i++] = (unsigned char)('0' + (magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    if (number < 0)
+    {
+        buffer[length++] = '-';
+    }
+    while (i > 0)
+    {
+        buffer[length++] = digits[--i];
+    }
+    buffer[length] = '\0';
+
+    return length;
+}
+
+/* Render the number nicely from the given item into a string. */
+static cJSON_bool print_number(const cJSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+    double d = item->valuedouble;
+    int length = 0;
+    unsigned char number_buffer[26] = {0}; /* temporary buffer to print the number into */
+
+    if (output_buffer == NULL)
+    {
+        return false;
+    }
+
+    /* This checks for NaN and Infinity */
+    if (isnan(d) || isinf(d))
+    {
+        length = sprintf((char*)number_buffer, "null");
+    }
+    else if ((item->type & cJSON_NumberIsInt64) && (d == (double)item->valueint64))
+    {
+        /* exact integers, up to INT64_MAX, which the double only holds rounded up to 2^63 */
+        length = print_int64(number_buffer, item->valueint64);
+    }
+    else if (d == (double)item->valueint)
+    {
+        length = print_int64(number_buffer, item->valueint);
+    }
+    else if ((d == (double)item->valueint64) && (d >= -9223372036854775808.0) && (d < 9223372036854775808.0))
+    {
+        length = print_int64(number_buffer, item->valueint64);
+    }
+    else
+    {
+        /* the same text as %1.15g, or %1.17g when 15 digits don't read back as the same double */
+        length = print_double(number_buffer, d);
+    }
+
+    /* buffer overrun occurred */
+    if ((length < 0) || (length > (int)(sizeof(number_buffer) - 1)))
+    {
+        return false;
+    }
+
+    /* reserve appropriate space in the output */
+    output_pointer = ensure(output_buffer, (size_t)length + sizeof(""));
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+
+    /* the formatters don't depend on the locale, so the number is copied as is */
+    memcpy(output_pointer, number_buffer, (size_t)length + sizeof(""));
+
+    output_buffer->offset += (size_t)length;
+
+    return true;
+}
+
+/* parse 4 digit hexadecimal number */
+static unsigned parse_hex4(const unsigned char * const input)
+{
+    unsigned int h = 0;
+    size_t i = 0;
+
+    for (i = 0; i < 4; i++)
+    {
+        /* parse digit */
+        if ((input[i] >= '0') && (input[i] <= '9'))
+        {
+            h += (unsigned int) input[i] - '0';
+        }
+        else if ((input[i] >= 'A') && (input[i] <= 'F'))
+        {
+            h += (unsigned int) 10 + input[i] - 'A';
+        }
+        else if ((input[i] >= 'a') && (input[i] <= 'f'))
+        {
+            h += (unsigned int) 10 + input[i] - 'a';
+        }
+        else /* invalid */
+        {
+            return 0;
+        }
+
+        if (i < 3)
+        {
+            /* shift left to make place for the next nibble */
+            h = h << 4;
+        }
+    }
+
+    return h;
+}
+
+/* converts a UTF-16 literal to UTF-8
+ * A literal can be one or two sequences of the form \uXXXX */
+static unsigned char utf16_literal_to_utf8(const unsigned char * const input_pointer, const unsigned char * const input_end, unsigned char **output_pointer)
+{
+    long unsigned int codepoint = 0;
+    unsigned int first_code = 0;
+    const unsigned char *first_sequence = input_pointer;
+    unsigned char utf8_length = 0;
+    unsigned char utf8_position = 0;
+    unsigned char sequence_length = 0;
+    unsigned char first_byte_mark = 0;
+
+    if ((input_end - first_sequence) < 6)
+    {
+        /* input ends unexpectedly */
+        goto fail;
+    }
+
+    /* get the first utf16 sequence */
+    first_code = parse_hex4(first_sequence + 2);
+
+    /* check that the code is valid */
+    if (((first_code >= 0xDC00) && (first_code <= 0xDFFF)))
+    {
+        goto fail;
+    }
+
+    /* UTF16 surrogate pair */
+    if ((first_code >= 0xD800) && (first_code <= 0xDBFF))
+    {
+        const unsigned char *second_sequence = first_sequence + 6;
+        unsigned int second_code = 0;
+        sequence_length = 12; /* \uXXXX\uXXXX */
+
+        if ((input_end - second_sequence) < 6)
+        {
+            /* input ends unexpectedly */
+            goto fail;
+        }
+
+        if ((second_sequence[0] != '\\') || (second_sequence[1] != 'u'))
+        {
+            /* missing second half of the surrogate pair */
+            goto fail;
+        }
+
+        /* get the second utf16 sequence */
+        second_code = parse_hex4(second_sequence + 2);
+        /* check that the code is valid */
+        if ((second_code < 0xDC00) || (second_code > 0xDFFF))
+        {
+            /* invalid second half of the surrogate pair */
+            goto fail;
+        }
+
+
+        /* calculate the unicode codepoint from the surrogate pair */
+        codepoint = 0x10000 + (((first_code & 0x3FF) << 10) | (second_code & 0x3FF));
+    }
+    else
+    {
+        sequence_length = 6; /* \uXXXX */
+        codepoint = first_code;
+    }
+
+    /* encode as UTF-8
+     * takes at maximum 4 bytes to encode:
+     * 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx */
+    if (codepoint < 0x80)
+    {
+        /* normal ascii, encoding 0xxxxxxx */
+        utf8_length = 1;
+    }
+    else if (codepoint < 0x800)
+    {
+        /* two bytes, encoding 110xxxxx 10xxxxxx */
+        utf8_length = 2;
+        first_byte_mark = 0xC0; /* 11000000 */
+    }
+    else if (codepoint < 0x10000)
+    {
+        /* three bytes, encoding 1110xxxx 10xxxxxx 10xxxxxx */
+        utf8_length = 3;
+        first_byte_mark = 0xE0; /* 11100000 */
+    }
+    else if (codepoint <= 0x10FFFF)
+    {
+        /* four bytes, encoding 1110xxxx 10xxxxxx 10xxxxxx 10xxxxxx */
+        utf8_length = 4;
+        first_byte_mark = 0xF0; /* 11110000 */
+    }
+    else
+    {
+        /* invalid unicode codepoint */
+        goto fail;
+    }
+
+    /* encode as utf8 */
+    for (utf8_position = (unsigned char)(utf8_length - 1); utf8_position > 0; utf8_position--)
+    {
+        /* 10xxxxxx */
+        (*output_pointer)[utf8_position] = (unsigned char)((codepoint | 0x80) & 0xBF);
+        codepoint >>= 6;
+    }
+    /* encode first byte */
+    if (utf8_length > 1)
+    {
+        (*output_pointer)[0] = (unsigned char)((codepoint | first_byte_mark) & 0xFF);
+    }
+    else
+    {
+        (*output_pointer)[0] = (unsigned char)(codepoint & 0x7F);
+    }
+
+    *output_pointer += utf8_length;
+
+    return sequence_length;
+
+fail:
+    return 0;
+}
+
+/* Scanning kernels: skip whole blocks of bytes that are of no interest, many bytes per step.
+ * They stop somewhere in front of the first interesting byte (never after it), the byte loops of the callers do the rest.
+ * Blocks are 16 bytes with SSE2, otherwise a machine word (4 bytes on the ESP32, 8 on 64 bit hosts). */
+#define word_broadcast(byte) (((size_t)-1 / 0xFF) * (size_t)(byte))
+/* nonzero if any byte in word is less than n (n <= 128) */
+#define word_has_less(word, n) (((word) - word_broadcast(n)) & ~(word) & word_broadcast(0x80))
+/* nonzero if any byte in word equals byte */
+#define word_has_byte(word, byte) word_has_less((word) ^ word_broadcast(byte), 1)
+
+/* skip bytes <= 32, the whitespace (and control characters) that cJSON skips between tokens */
+static const unsigned char *scan_whitespace(const unsigned char *pointer, const unsigned char * const end)
+{
+#ifdef CJSON_SCAN_SSE2
+    const __m128i space = _mm_set1_epi8(32);
+    while ((end - pointer) >= 16)
+    {
+        const __m128i bytes = _mm_loadu_si128((const __m128i*)(const void*)pointer);
+        /* bytes <= 32 are unchanged by the maximum with 32 */
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(bytes, space), space)) != 0xFFFF)
+        {
+            return pointer;
+        }
+        pointer += 16;
+    }
+#endif
+    while ((end - pointer) >= (ptrdiff_t)sizeof(size_t))
+    {
+        size_t word;
+        memcpy(&word, pointer, sizeof(word));
+        /* a byte is above 32 if its high bit is set or adding 95 to its low bits carries into the high bit */
+        if ((((word & word_broadcast(0x7F)) + word_broadcast(0x5F)) | word) & word_broadcast(0x80))
+        {
+            return pointer;
+        }
+        pointer += sizeof(word);
+    }
+
+    return pointer;
+}
+
+/* skip bytes that can be copied into or out of a string literal as they are, stopping in front of '"', '\\' and control characters */
+static const unsigned char *scan_string(const unsigned char *pointer, const unsigned char * const end)
+{
+#ifdef CJSON_SCAN_SSE2
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(31);
+    while ((end - pointer) >= 16)
+    {
+        const __m128i bytes = _mm_loadu_si128((const __m128i*)(const void*)pointer);
+        const __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, backslash)),
+                                             _mm_cmpeq_epi8(_mm_max_epu8(bytes, control), control));
+        if (_mm_movemask_epi8(special) != 0)
+        {
+            return pointer;
+        }
+        pointer += 16;
+    }
+#endif
+    while ((end - pointer) >= (ptrdiff_t)sizeof(size_t))
+    {
+        size_t word;
+        memcpy(&word, pointer, sizeof(word));
+        if (word_has_byte(word, '\"') | word_has_byte(word, '\\') | word_has_less(word, 32))
+        {
+            return pointer;
+        }
+        pointer += sizeof(word);
+    }
+
+    return pointer;
+}
+
+/* Find the closing quote of the string literal at the buffer's offset.
+ * Returns the position of the quote or NULL if the string is unterminated, and counts the escape backslashes. */
+static const unsigned char *find_string_end(const parse_buffer * const input_buffer, size_t * const skipped_bytes)
+{
+    const unsigned char *input_end = buffer_at_offset(input_buffer) + 1;
+    const unsigned char * const buffer_end = input_buffer->content + input_buffer->length;
+
+    *skipped_bytes = 0;
+    for (;;)
+    {
+        /* scan_string stops in front of the word holding the quote or backslash, the rest is stepped over here */
+        input_end = scan_string(input_end, buffer_end);
+        while ((input_end < buffer_end) && (*input_end != '\"') && (*input_end != '\\'))
+        {
+            input_end++;
+        }
+        if ((input_end >= buffer_end) || (*input_end == '\"'))
+        {
+            break;
+        }
+
+        /* is escape sequence */
+        if ((size_t)(input_end + 1 - input_buffer->content) >= input_buffer->length)
+        {
+            /* prevent buffer overflow when last input character is a backslash */
+            return NULL;
+        }
+        (*skipped_bytes)++;
+        input_end += 2;
+    }
+    if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
+    {
+        return NULL; /* string ended unexpectedly */
+    }
+
+    return input_end;
+}
+
+/* Unescape the characters between input_pointer and input_end into output, which has room for output_size bytes
+ * including the terminator. Characters that don't fit are dropped whole and *truncated is set.
+ * Returns the position of the terminator, or NULL on an invalid escape sequence,
+ * in which case *failed_at (unless failed_at is NULL) points to its backslash. */
+static unsigned char *unescape_string(const unsigned char *input_pointer, const unsigned char * const input_end, unsigned char * const output, size_t output_size, cJSON_bool * const truncated, const unsigned char ** const failed_at)
+{
+    unsigned char *output_pointer = output;
+    const unsigned char * const output_end = output + output_size - 1;
+    size_t run_length = 0;
+
+    *truncated = false;
+    while (input_pointer < input_end)
+    {
+        if (*input_pointer != '\\')
+        {
+            if (output_pointer == output_end)
+            {
+                /* don't leave the first half of a UTF-8 sequence behind */
+                if ((*input_pointer & 0xC0) == 0x80)
+                {
+                    while ((output_pointer > output) && ((output_pointer[-1] & 0xC0) == 0x80))
+                    {
+                        output_pointer--;
+                    }
+                    if ((output_pointer > output) && (output_pointer[-1] >= 0xC0))
+                    {
+                        output_pointer--;
+                    }
+                }
+                *truncated = true;
+                break;
+            }
+            /* copy the whole run up to the next escape sequence, as far as it fits */
+            run_length = (size_t)(scan_string(input_pointer + 1, input_end) - input_pointer);
+            if (run_length > (size_t)(output_end - output_pointer))
+            {
+                run_length = (size_t)(output_end - output_pointer);
+            }
+            memmove(output_pointer, input_pointer, run_length);
+            output_pointer += run_length;
+            input_pointer += run_length;
+        }
+        /* escape sequence */
+        else
+        {
+            unsigned char sequence[4];
+            unsigned char *sequence_pointer = sequence;
+            unsigned char sequence_length = 2;
+            if ((input_end - input_pointer) < 1)
+            {
+                goto fail;
+            }
+
+            switch (input_pointer[1])
+            {
+                case 'b':
+                    *sequence_pointer++ = '\b';
+                    break;
+                case 'f':
+                    *sequence_pointer++ = '\f';
+                    break;
+                case 'n':
+                    *sequence_pointer++ = '\n';
+                    break;
+                case 'r':
+                    *sequence_pointer++ = '\r';
+                    break;
+                case 't':
+                    *sequence_pointer++ = '\t';
+                    break;
+                case '\"':
+                case '\\':
+                case '/':
+                    *sequence_pointer++ = input_pointer[1];
+                    break;
+
+                /* UTF-16 literal */
+                case 'u':
+                    sequence_length = utf16_literal_to_utf8(input_pointer, input_end, &sequence_pointer);
+                    if (sequence_length == 0)
+                    {
+                        /* failed to convert UTF16-literal to UTF-8 */
+                        goto fail;
+                    }
+                    break;
+
+                default:
+                    goto fail;
+            }
+
+            if ((size_t)(sequence_pointer - sequence) > (size_t)(output_end - output_pointer))
+            {
+                *truncated = true;
+                break;
+            }
+            memcpy(output_pointer, sequence, (size_t)(sequence_pointer - sequence));
+            output_pointer += sequence_pointer - sequence;
+            input_pointer += sequence_length;
+        }
+    }
+
+    /* zero terminate the output */
+    *output_pointer = '\0';
+
+    return output_pointer;
+
+fail:
+    if (failed_at != NULL)
+    {
+        *failed_at = input_pointer;
+    }
+
+    return NULL;
+}
+
+/* Parse the input text into an unescaped cinput. Returns NULL on failure. */
+static unsigned char *parse_string_literal(parse_buffer * const input_buffer)
+{
+    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
+    const unsigned char *input_end = NULL;
+    unsigned char *output = NULL;
+    size_t allocation_length = 0;
+    const unsigned char *failed_at = NULL;
+    size_t skipped_bytes = 0;
+    cJSON_bool truncated = false;
+
+    /* not a string */
+    if (buffer_at_offset(input_buffer)[0] != '\"')
+    {
+        goto fail;
+    }
+
+    input_end = find_string_end(input_buffer, &skipped_bytes);
+    if (input_end == NULL)
+    {
+        goto fail;
+    }
+
+    /* This is at most how much we need for the output */
+    allocation_length = (size_t) (input_end - buffer_at_offset(input_buffer)) - skipped_bytes;
+    if (input_buffer->in_situ)
+    {
+        /* unescaping never makes a string longer, so it is done in place
+         * and the closing quote makes room for the terminator */
+        output = (unsigned char*)cast_away_const(input_pointer);
+    }
+    else
+    {
+        profile_at(cJSON_SiteString);
+        output = (unsigned char*)parse_allocate(input_buffer, allocation_length + sizeof(""));
+        if (output == NULL)
+        {
+            goto fail; /* allocation failure */
+        }
+    }
+
+    if (unescape_string(input_pointer, input_end, output, allocation_length + sizeof(""), &truncated, &failed_at) == NULL)
+    {
+        input_pointer = failed_at; /* report the invalid escape sequence, not the start of the string */
+        goto fail;
+    }
+
+    input_buffer->offset = (size_t) (input_end - input_buffer->content);
+    input_buffer->offset++;
+
+    return output;
+
+fail:
+    if ((output != NULL) && !input_buffer->in_situ)
+    {
+        parse_deallocate(input_buffer, output);
+    }
+
+    if (input_pointer != NULL)
+    {
+        input_buffer->offset = (size_t)(input_pointer - input_buffer->content);
+    }
+
+    return NULL;
+}
+
+#ifndef CJSON_INTERN_LIMIT
+/* keys the intern table holds at most, 0 compiles interning out */
+#define CJSON_INTERN_LIMIT 32
+#endif
+
+#if CJSON_INTERN_LIMIT > 0
+/* keys shared by parsed objects, an open addressed table that only cJSON_InternKeys adds to */
+static struct
+{
+    cJSON_bool enabled;
+    size_t count;
+    const char *keys[CJSON_INTERN_LIMIT * 2]; /* at most half full */
+    size_t lengths[CJSON_INTERN_LIMIT * 2];
+} intern;
+
+#define intern_slot_count (sizeof(intern.keys) / sizeof(intern.keys[0]))
+
+/* FNV-1a, like hash_key but over a length */
+static unsigned long intern_hash(const unsigned char *key, size_t length)
+{
+    unsigned long hash = 2166136261UL;
+    size_t i = 0;
+
+    for (i = 0; i < length; i++)
+    {
+        hash ^= key[i];
+        hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+    }
+
+    return hash;
+}
+
+/* Find the key of length bytes, adding it by reference while there is room. Returns NULL if it isn't interned. */
+static const char *intern_key(const char *key, size_t length)
+{
+    size_t i = intern_hash((const unsigned char*)key, length) % intern_slot_count;
+
+    for (; intern.keys[i] != NULL; i = (i + 1) % intern_slot_count)
+    {
+        if ((intern.lengths[i] == length) && (memcmp(intern.keys[i], key, length) == 0))
+        {
+            return intern.keys[i];
+        }
+    }
+
+    if (intern.count >= CJSON_INTERN_LIMIT)
+    {
+        return NULL;
+    }
+    intern.keys[i] = key;
+    intern.lengths[i] = length;
+    intern.count++;
+
+    return intern.keys[i];
+}
+
+/* The interned copy of the key of length bytes without adding it, NULL if there is none.
+ * Only reads the table, so parses on several threads can look keys up at once. */
+static const char *intern_find(const unsigned char *key, size_t length)
+{
+    size_t i = intern_hash(key, length) % intern_slot_count;
+
+    for (; intern.keys[i] != NULL; i = (i + 1) % intern_slot_count)
+    {
+        if ((intern.lengths[i] == length) && (memcmp(intern.keys[i], key, length) == 0))
+        {
+            return intern.keys[i];
+        }
+    }
+
+    return NULL;
+}
+#endif
+
+CJSON_PUBLIC(cJSON_bool) cJSON_InternKeys(const char * const *keys, size_t count)
+{
+#if CJSON_INTERN_LIMIT > 0
+    cJSON_bool status = true;
+    size_t i = 0;
+
+    if ((keys == NULL) && (count != 0))
+    {
+        return false;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if ((keys[i] == NULL) || (intern_key(keys[i], strlen(keys[i])) == NULL))
+        {
+            status = false;
+        }
+    }
+    intern.enabled = true;
+
+    return status;
+#else
+    (void)keys;
+    (void)count;
+    return false;
+#endif
+}
+
+CJSON_PUBLIC(size_t) cJSON_InternedKeyCount(void)
+{
+#if CJSON_INTERN_LIMIT > 0
+    return intern.count;
+#else
+    return 0;
+#endif
+}
+
+/* Parse an object key. *shared is set if the key doesn't belong to the item,
+ * either because it is interned or because it points into an in situ buffer. */
+static unsigned char *parse_key(parse_buffer * const input_buffer, cJSON_bool * const shared)
+{
+#if CJSON_INTERN_LIMIT > 0
+    if (intern.enabled && can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '\"'))
+    {
+        size_t skipped_bytes = 0;
+        const unsigned char *input_end = find_string_end(input_buffer, &skipped_bytes);
+        const char *key = NULL;
+
+        /* keys with escape sequences are rare, they take the usual path */
+        if ((input_end != NULL) && (skipped_bytes == 0))
+        {
+            const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
+
+            key = intern_find(input_pointer, (size_t)(input_end - input_pointer));
+        }
+        if (key != NULL)
+        {
+            input_buffer->offset = (size_t)(input_end - input_buffer->content) + 1;
+            *shared = true;
+            return (unsigned char*)cast_away_const(key);
+        }
+    }
+#endif
+
+    *shared = input_buffer->in_situ;
+    return parse_string_literal(input_buffer);
+}
+
+/* Parse a string value and populate item. */
+static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_buffer)
+{
+    unsigned char *output = parse_string_literal(input_buffer);
+    if (output == NULL)
+    {
+        return false;
+    }
+
+    item->type |= cJSON_String;
+    if (input_buffer->in_situ)
+    {
+        /* the string belongs to the input buffer */
+        item->type |= cJSON_IsReference;
+    }
+    item->valuestring = (char*)output;
+
+    return true;
+}
+
+/* Render the cstring provided to an escaped version that can be printed. */
+/* write the escape sequence for character to output (7 bytes of room), returns its length */
+static size_t print_escape_sequence(unsigned char character, unsigned char * const output)
+{
+    output[0] = '\\';
+    switch (character)
+    {
+        case '\\':
+            output[1] = '\\';
+            return 2;
+        case '\"':
+            output[1] = '\"';
+            return 2;
+        case '\b':
+            output[1] = 'b';
+            return 2;
+        case '\f':
+            output[1] = 'f';
+            return 2;
+        case '\n':
+            output[1] = 'n';
+            return 2;
+        case '\r':
+            output[1] = 'r';
+            return 2;
+        case '\t':
+            output[1] = 't';
+            return 2;
+        default:
+            /* escape and print as unicode codepoint */
+            sprintf((char*)output + 1, "u%04x", character);
+            return 6;
+    }
+}
+
+/* print a string that doesn't fit the sink's buffer: normal runs and escape sequences are appended one by one */
+static cJSON_bool print_string_chunked(const unsigned char * const input, const unsigned char * const input_end, printbuffer * const output_buffer)
+{
+    const unsigned char *input_pointer = input;
+    const unsigned char *run_start = input;
+    unsigned char sequence[7];
+
+    if (!print_bytes(output_buffer, (const unsigned char*)"\"", 1))
+    {
+        return false;
+    }
+
+    for (;;)
+    {
+        input_pointer = scan_string(input_pointer, input_end);
+        if ((input_pointer < input_end) && (*input_pointer > 31) && (*input_pointer != '\"') && (*input_pointer != '\\'))
+        {
+            /* the scan stopped early on a normal character */
+            input_pointer++;
+            continue;
+        }
+
+        if (!print_bytes(output_buffer, run_start, (size_t)(input_pointer - run_start)))
+        {
+            return false;
+        }
+        if (input_pointer == input_end)
+        {
+            break;
+        }
+
+        if (!print_bytes(output_buffer, sequence, print_escape_sequence(*input_pointer, sequence)))
+        {
+            return false;
+        }
+        input_pointer++;
+        run_start = input_pointer;
+    }
+
+    return print_bytes(output_buffer, (const unsigned char*)"\"", 1);
+}
+
+static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffer * const output_buffer)
+{
+    const unsigned char *input_pointer = NULL;
+    const unsigned char *input_end = NULL;
+    unsigned char *output = NULL;
+    unsigned char *output_pointer = NULL;
+    size_t output_length = 0;
+    /* numbers of additional characters needed for escaping */
+    size_t escape_characters = 0;
+
+    if (output_buffer == NULL)
+    {
+        return false;
+    }
+
+    /* empty string */
+    if (input == NULL)
+    {
+        output = ensure(output_buffer, sizeof("\"\""));
+        if (output == NULL)
+        {
+            return false;
+        }
+        strcpy((char*)output, "\"\"");
+
+        return true;
+    }
+
+    /* set "flag" to 1 if something needs to be escaped */
+    input_end = input + strlen((const char*)input);
+    for (input_pointer = input; (input_pointer = scan_string(input_pointer, input_end)) < input_end; input_pointer++)
+    {
+        switch (*input_pointer)
+        {
+            case '\"':
+            case '\\':
+            case '\b':
+            case '\f':
+            case '\n':
+            case '\r':
+            case '\t':
+                /* one character escape sequence */
+                escape_characters++;
+                break;
+            default:
+                if (*input_pointer < 32)
+                {
+                    /* UTF-16 escape sequence uXXXX */
+                    escape_characters += 5;
+                }
+                break;
+        }
+    }
+    output_length = (size_t)(input_end - input) + escape_characters;
+
+    if ((output_buffer->sink != NULL) && (output_length + sizeof("\"\"") >= output_buffer->length))
+    {
+        return print_string_chunked(input, input_end, output_buffer);
+    }
+
+    output = ensure(output_buffer, output_length + sizeof("\"\""));
+    if (output == NULL)
+    {
+        return false;
+    }
+
+    /* no characters have to be escaped */
+    if (escape_characters == 0)
+    {
+        output[0] = '\"';
+        memcpy(output + 1, input, output_length);
+        output[output_length + 1] = '\"';
+        output[output_length + 2] = '\0';
+
+        return true;
+    }
+
+    output[0] = '\"';
+    output_pointer = output + 1;
+    /* copy the string */
+    for (input_pointer = input; *input_pointer != '\0'; (void)input_pointer++, output_pointer++)
+    {
+        if ((*input_pointer > 31) && (*input_pointer != '\"') && (*input_pointer != '\\'))
+        {
+            /* copy the whole run of normal characters */
+            const unsigned char * const run_end = scan_string(input_pointer + 1, input_end);
+            memcpy(output_pointer, input_pointer, (size_t)(run_end - input_pointer));
+            output_pointer += run_end - input_pointer - 1;
+            input_pointer = run_end - 1;
+        }
+        else
+        {
+            /* character needs to be escaped */
+            output_pointer += print_escape_sequence(*input_pointer, output_pointer) - 1;
+        }
+    }
+    output[output_length + 1] = '\"';
+    output[output_length + 2] = '\0';
+
+    return true;
+}
+
+/* Invoke print_string_ptr (which is useful) on an item. */
+static cJSON_bool print_string(const cJSON * const item, printbuffer * const p)
+{
+    return print_string_ptr((unsigned char*)item->valuestring, p);
+}
+
+/* Predeclare these prototypes. */
+static cJSON_bool parse_scalar(cJSON * const item, parse_buffer * const input_buffer);
+static cJSON_bool parse_value(cJSON * const item, parse_buffer * const input_buffer);
+static cJSON_bool print_value(const cJSON * const item, printbuffer * const output_buffer);
+
+/* Utility to jump whitespace and cr/lf */
+static parse_buffer *buffer_skip_whitespace(parse_buffer * const buffer)
+{
+    if ((buffer == NULL) || (buffer->content == NULL))
+    {
+        return NULL;
+    }
+
+    /* most tokens follow each other without any whitespace */
+    if (cannot_access_at_index(buffer, 0) || (buffer_at_offset(buffer)[0] > 32))
+    {
+        return buffer;
+    }
+
+    buffer->offset = (size_t)(scan_whitespace(buffer_at_offset(buffer), buffer->content + buffer->length) - buffer->content);
+    while (can_access_at_index(buffer, 0) && (buffer_at_offset(buffer)[0] <= 32))
+    {
+       buffer->offset++;
+    }
+
+    if (buffer->offset == buffer->length)
+    {
+        buffer->offset--;
+    }
+
+    return buffer;
+}
+
+/* skip the UTF-8 BOM (byte order mark) if it is at the beginning of a buffer */
+static parse_buffer *skip_utf8_bom(parse_buffer * const buffer)
+{
+    if ((buffer == NULL) || (buffer->content == NULL) || (buffer->offset != 0))
+    {
+        return NULL;
+    }
+
+    if (can_access_at_index(buffer, 4) && (strncmp((const char*)buffer_at_offset(buffer), "\xEF\xBB\xBF", 3) == 0))
+    {
+        buffer->offset += 3;
+    }
+
+    return buffer;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated)
+{
+    size_t buffer_length;
+
+    if (NULL == value)
+    {
+        return NULL;
+    }
+
+    /* Adding null character size due to require_null_terminated. */
+    buffer_length = strlen(value) + sizeof("");
+
+    return cJSON_ParseWithLengthOpts(value, buffer_length, return_parse_end, require_null_terminated);
+}
+
+/* Fill in where and why parsing of value stopped. */
+static void record_parse_error(const parse_buffer * const buffer, const char *value, const char **return_parse_end, cJSON_ParseError * const parse_error)
+{
+    parse_error->position = 0;
+    parse_error->reason = (buffer->error != cJSON_ErrorNone) ? buffer->error : cJSON_ErrorSyntax;
+
+    if (buffer->offset < buffer->length)
+    {
+        parse_error->position = buffer->offset;
+    }
+    else if (buffer->length > 0)
+    {
+        parse_error->position = buffer->length - 1;
+    }
+
+    if ((return_parse_end != NULL) && (value != NULL))
+    {
+        *return_parse_end = value + parse_error->position;
+    }
+}
+
+/* Hand the outcome of a parse to cJSON_GetErrorPtr, only the functions without a cJSON_ParseError do this. */
+static void publish_parse_error(const char *value, const cJSON_ParseError * const parse_error)
+{
+    if ((value == NULL) || (parse_error->reason == cJSON_ErrorNone))
+    {
+        global_error.json = NULL;
+        global_error.position = 0;
+        return;
+    }
+
+    global_error.json = (const unsigned char*)value;
+    global_error.position = parse_error->position;
+}
+
+/* Parse a document with a prepared parse buffer - create a new root, and populate.
+ * Nothing shared is written, the outcome goes to error. */
+static cJSON *parse_document(parse_buffer * const buffer, const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated, cJSON_ParseError * const parse_error)
+{
+    cJSON *item = NULL;
+
+    parse_error->position = 0;
+    parse_error->reason = cJSON_ErrorNone;
+
+    if (value == NULL || 0 == buffer_length)
+    {
+        goto fail;
+    }
+
+    buffer->content = (const unsigned char*)value;
+    buffer->length = buffer_length;
+    buffer->offset = 0;
+
+    item = parse_new_item(buffer);
+    if (item == NULL) /* memory fail */
+    {
+        goto fail;
+    }
+    if (buffer->arena != NULL)
+    {
+        item->type |= cJSON_IsArenaRoot;
+    }
+
+    if (!parse_value(item, buffer_skip_whitespace(skip_utf8_bom(buffer))))
+    {
+        /* parse failure. ep is set. */
+        goto fail;
+    }
+
+    /* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator */
+    if (require_null_terminated)
+    {
+        buffer_skip_whitespace(buffer);
+        if ((buffer->offset >= buffer->length) || buffer_at_offset(buffer)[0] != '\0')
+        {
+            buffer->error = cJSON_ErrorTrailing;
+            goto fail;
+        }
+    }
+    if (return_parse_end)
+    {
+        *return_parse_end = (const char*)buffer_at_offset(buffer);
+    }
+
+    return item;
+
+fail:
+    if (item != NULL)
+    {
+        cJSON_Delete(item);
+    }
+    else if (buffer->arena != NULL)
+    {
+        arena_release(buffer->arena);
+    }
+
+    if (value != NULL)
+    {
+        record_parse_error(buffer, value, return_parse_end, parse_error);
+    }
+    else
+    {
+        parse_error->reason = cJSON_ErrorSyntax;
+    }
+
+    return NULL;
+}
+
+/* Parse an object - create a new root, and populate. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+    cJSON_ParseError parse_error = { 0, cJSON_ErrorNone };
+    cJSON *item = NULL;
+
+    buffer.hooks = global_hooks;
+
+    item = parse_document(&buffer, value, buffer_length, return_parse_end, require_null_terminated, &parse_error);
+    publish_parse_error(value, &parse_error);
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithError(const char *value, size_t buffer_length, cJSON_bool require_null_terminated, cJSON_ParseError *parse_error)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+    cJSON_ParseError ignored = { 0, cJSON_ErrorNone };
+
+    buffer.hooks = global_hooks;
+
+    return parse_document(&buffer, value, buffer_length, NULL, require_null_terminated, (parse_error != NULL) ? parse_error : &ignored);
+}
+
+/* cJSON_ParseInSitu reporting to parse_error */
+static cJSON *parse_in_situ(char *value, size_t buffer_length, cJSON_ParseError * const parse_error)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+
+    buffer.hooks = global_hooks;
+    buffer.in_situ = true;
+
+    return parse_document(&buffer, value, buffer_length, NULL, false, parse_error);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseInSitu(char *value, size_t buffer_length)
+{
+    cJSON_ParseError parse_error = { 0, cJSON_ErrorNone };
+    cJSON *item = parse_in_situ(value, buffer_length, &parse_error);
+
+    publish_parse_error(value, &parse_error);
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseInSituWithError(char *value, size_t buffer_length, cJSON_ParseError *parse_error)
+{
+    cJSON_ParseError ignored = { 0, cJSON_ErrorNone };
+
+    return parse_in_situ(value, buffer_length, (parse_error != NULL) ? parse_error : &ignored);
+}
+
+/* cJSON_ParseWithLengthArena reporting to parse_error */
+static cJSON *parse_arena(const char *value, size_t buffer_length, void *arena, size_t arena_size, cJSON_ParseError * const parse_error)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+
+    if ((value == NULL) || (buffer_length == 0))
+    {
+        return parse_document(&buffer, value, buffer_length, NULL, false, parse_error);
+    }
+
+    buffer.hooks = global_hooks;
+
+    if (arena == NULL)
+    {
+        /* one pooled block that is known to fit the whole document */
+        arena_size = cJSON_ArenaSizeFor(value, buffer_length);
+        profile_at(cJSON_SiteArena);
+        arena = global_hooks.allocate(arena_size);
+        buffer.arena = arena_init((unsigned char*)arena, arena_size, global_hooks.deallocate);
+        if ((buffer.arena == NULL) && (arena != NULL))
+        {
+            global_hooks.deallocate(arena);
+        }
+    }
+    else
+    {
+        buffer.arena = arena_init((unsigned char*)arena, arena_size, NULL);
+    }
+
+    if (buffer.arena == NULL)
+    {
+        parse_error->position = 0;
+        parse_error->reason = cJSON_ErrorMemory;
+        return NULL;
+    }
+
+    return parse_document(&buffer, value, buffer_length, NULL, false, parse_error);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthArena(const char *value, size_t buffer_length, void *arena, size_t arena_size)
+{
+    cJSON_ParseError parse_error = { 0, cJSON_ErrorNone };
+    cJSON *item = parse_arena(value, buffer_length, arena, arena_size, &parse_error);
+
+    publish_parse_error(value, &parse_error);
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthArenaWithError(const char *value, size_t buffer_length, void *arena, size_t arena_size, cJSON_ParseError *parse_error)
+{
+    cJSON_ParseError ignored = { 0, cJSON_ErrorNone };
+
+    return parse_arena(value, buffer_length, arena, arena_size, (parse_error != NULL) ? parse_error : &ignored);
+}
+
+/* Default options for cJSON_Parse */
+CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value)
+{
+    return cJSON_ParseWithOpts(value, 0, 0);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_length)
+{
+    return cJSON_ParseWithLengthOpts(value, buffer_length, 0, 0);
+}
+
+/* Skip over a single string, literal or number. Strings are only checked for their closing quote. */
+static cJSON_bool skip_scalar(parse_buffer * const input_buffer)
+{
+    cJSON scratch;
+    size_t skipped_bytes = 0;
+    const unsigned char *string_end = NULL;
+
+    if (buffer_at_offset(input_buffer)[0] == '\"')
+    {
+        string_end = find_string_end(input_buffer, &skipped_bytes);
+        if (string_end == NULL)
+        {
+            return false;
+        }
+        input_buffer->offset = (size_t)(string_end - input_buffer->content) + 1;
+        return true;
+    }
+
+    /* literals and numbers are parsed without allocating, only the type of the scratch item is read */
+    scratch.type = cJSON_Invalid;
+    if ((buffer_at_offset(input_buffer)[0] == '-') || ((buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9')))
+    {
+        return parse_number(&scratch, input_buffer);
+    }
+    return parse_scalar(&scratch, input_buffer);
+}
+
+/* Step over the opening bracket or comma in front of a member and, in objects, over its name. */
+static cJSON_bool skip_member_start(parse_buffer * const input_buffer, const cJSON_bool object)
+{
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (!object)
+    {
+        return true;
+    }
+
+    /* skip the name */
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '\"') || !skip_scalar(input_buffer))
+    {
+        return false;
+    }
+    buffer_skip_whitespace(input_buffer);
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+    {
+        return false;
+    }
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+
+    return true;
+}
+
+/* Skip over a value without building anything or recursing.
+ * Only the kind of each open container has to be remembered, one bit per nesting level. */
+static cJSON_bool skip_value(parse_buffer * const input_buffer)
+{
+    unsigned char objects[(CJSON_NESTING_LIMIT + 7) / 8];
+    size_t depth = 0; /* containers opened by this call */
+    cJSON_bool object = false;
+
+    for (;;)
+    {
+        unsigned char opening = 0;
+
+        if (cannot_access_at_index(input_buffer, 0))
+        {
+            return false;
+        }
+        opening = buffer_at_offset(input_buffer)[0];
+
+        if ((opening == '[') || (opening == '{'))
+        {
+            if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+            {
+                input_buffer->error = cJSON_ErrorDepth;
+                return false; /* to deeply nested */
+            }
+            object = (opening == '{');
+
+            input_buffer->offset++;
+            buffer_skip_whitespace(input_buffer);
+            if (!(can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == (object ? '}' : ']'))))
+            {
+                /* remember the kind of container, its members come next */
+                if (object)
+                {
+                    objects[depth / 8] = (unsigned char)(objects[depth / 8] | (1U << (depth % 8)));
+                }
+                else
+                {
+                    objects[depth / 8] = (unsigned char)(objects[depth / 8] & ~(1U << (depth % 8)));
+                }
+                depth++;
+                input_buffer->depth++;
+
+                /* step back to character in front of the first element */
+                input_buffer->offset--;
+                if (!skip_member_start(input_buffer, object))
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            /* empty array or object */
+            input_buffer->offset++;
+        }
+        else if (!skip_scalar(input_buffer))
+        {
+            return false;
+        }
+
+        /* the value is done, go on with the next member or close the innermost container */
+        for (;;)
+        {
+            if (depth == 0)
+            {
+                return true;
+            }
+            object = (objects[(depth - 1) / 8] >> ((depth - 1) % 8)) & 1;
+
+            buffer_skip_whitespace(input_buffer);
+            if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','))
+            {
+                break;
+            }
+            if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != (object ? '}' : ']')))
+            {
+                return false;
+            }
+            input_buffer->offset++;
+            input_buffer->depth--;
+            depth--;
+        }
+
+        if (!skip_member_start(input_buffer, object))
+        {
+            return false;
+        }
+    }
+}
+
+/* Decode one member value into the destination of its field.
+ * *stored is false if the value has another type, in which case it is skipped. */
+static cJSON_bool decode_field(parse_buffer * const input_buffer, const cJSON_Field * const field, unsigned char * const destination, cJSON_bool * const stored)
+{
+    cJSON scratch;
+    unsigned char first = 0;
+
+    *stored = false;
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        return false;
+    }
+    first = buffer_at_offset(input_buffer)[0];
+
+    switch (field->type)
+    {
+        case cJSON_FieldString:
+            if ((first == '\"') && (field->size > 0))
+            {
+                size_t skipped_bytes = 0;
+                cJSON_bool truncated = false;
+                const unsigned char *failed_at = NULL;
+                const unsigned char *string_end = find_string_end(input_buffer, &skipped_bytes);
+                if (string_end == NULL)
+                {
+                    return false;
+                }
+                if (unescape_string(buffer_at_offset(input_buffer) + 1, string_end, destination, field->size, &truncated, &failed_at) == NULL)
+                {
+                    input_buffer->offset = (size_t)(failed_at - input_buffer->content);
+                    return false;
+                }
+                input_buffer->offset = (size_t)(string_end - input_buffer->content) + 1;
+                *stored = true;
+                return true;
+            }
+            break;
+
+        case cJSON_FieldInt:
+        case cJSON_FieldInt64:
+        case cJSON_FieldDouble:
+            if ((first == '-') || ((first >= '0') && (first <= '9')))
+            {
+                memset(&scratch, '\0', sizeof(scratch));
+                if (!parse_number(&scratch, input_buffer))
+                {
+                    return false;
+                }
+                if (field->type == cJSON_FieldInt)
+                {
+                    *(int*)(void*)destination = scratch.valueint;
+                }
+                else if (field->type == cJSON_FieldInt64)
+                {
+                    *(int64_t*)(void*)destination = scratch.valueint64;
+                }
+                else
+                {
+                    *(double*)(void*)destination = scratch.valuedouble;
+                }
+                *stored = true;
+                return true;
+            }
+            break;
+
+        case cJSON_FieldBool:
+            if ((first == 't') || (first == 'f'))
+            {
+                memset(&scratch, '\0', sizeof(scratch));
+                if (!parse_scalar(&scratch, input_buffer))
+                {
+                    return false;
+                }
+                *(cJSON_bool*)(void*)destination = cJSON_IsTrue(&scratch);
+                *stored = true;
+                return true;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return skip_value(input_buffer);
+}
+
+static cJSON_bool decode_object(const char *value, size_t buffer_length, const cJSON_Field *fields, size_t field_count, void *destination, unsigned long *found, cJSON_ParseError * const parse_error)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+    unsigned char name[CJSON_DECODE_NAME_LENGTH];
+    unsigned long found_fields = 0;
+
+    parse_error->position = 0;
+    parse_error->reason = cJSON_ErrorNone;
+
+    if ((value == NULL) || (buffer_length == 0) || ((fields == NULL) && (field_count > 0)) || (destination == NULL) || (field_count > CJSON_DECODE_MAX_FIELDS))
+    {
+        parse_error->reason = cJSON_ErrorSyntax;
+        return false;
+    }
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.hooks = global_hooks;
+
+    buffer_skip_whitespace(skip_utf8_bom(&buffer));
+    if (cannot_access_at_index(&buffer, 0) || (buffer_at_offset(&buffer)[0] != '{'))
+    {
+        goto fail; /* not an object */
+    }
+    buffer.depth++;
+
+    buffer.offset++;
+    buffer_skip_whitespace(&buffer);
+    if (can_access_at_index(&buffer, 0) && (buffer_at_offset(&buffer)[0] == '}'))
+    {
+        goto success; /* empty object */
+    }
+
+    /* step back to character in front of the first member */
+    buffer.offset--;
+    do
+    {
+        const unsigned char *name_end = NULL;
+        const unsigned char *failed_at = NULL;
+        size_t skipped_bytes = 0;
+        size_t field_index = field_count;
+        cJSON_bool truncated = false;
+        cJSON_bool stored = false;
+
+        /* unescape the name into the scratch buffer, names that don't fit can't match a field */
+        buffer.offset++;
+        buffer_skip_whitespace(&buffer);
+        if (cannot_access_at_index(&buffer, 0) || (buffer_at_offset(&buffer)[0] != '\"'))
+        {
+            goto fail;
+        }
+        name_end = find_string_end(&buffer, &skipped_bytes);
+        if (name_end == NULL)
+        {
+            goto fail;
+        }
+        if (unescape_string(buffer_at_offset(&buffer) + 1, name_end, name, sizeof(name), &truncated, &failed_at) == NULL)
+        {
+            buffer.offset = (size_t)(failed_at - buffer.content);
+            goto fail;
+        }
+        buffer.offset = (size_t)(name_end - buffer.content) + 1;
+
+        if (!truncated)
+        {
+            for (field_index = 0; field_index < field_count; field_index++)
+            {
+                if (strcmp((const char*)name, fields[field_index].name) == 0)
+                {
+                    break;
+                }
+            }
+        }
+
+        buffer_skip_whitespace(&buffer);
+        if (cannot_access_at_index(&buffer, 0) || (buffer_at_offset(&buffer)[0] != ':'))
+        {
+            goto fail; /* invalid object */
+        }
+        buffer.offset++;
+        buffer_skip_whitespace(&buffer);
+
+        /* unknown members and repeated names are skipped, the first occurrence wins */
+        if ((field_index < field_count) && !(found_fields & (1UL << field_index)))
+        {
+            if (!decode_field(&buffer, &fields[field_index], (unsigned char*)destination + fields[field_index].offset, &stored))
+            {
+                goto fail;
+            }
+            if (stored)
+            {
+                found_fields |= 1UL << field_index;
+            }
+        }
+        else if (!skip_value(&buffer))
+        {
+            goto fail;
+        }
+        buffer_skip_whitespace(&buffer);
+    }
+    while (can_access_at_index(&buffer, 0) && (buffer_at_offset(&buffer)[0] == ','));
+
+    if (cannot_access_at_index(&buffer, 0) || (buffer_at_offset(&buffer)[0] != '}'))
+    {
+        goto fail; /* expected end of object */
+    }
+
+success:
+    if (found != NULL)
+    {
+        *found = found_fields;
+    }
+
+    return true;
+
+fail:
+    record_parse_error(&buffer, value, NULL, parse_error);
+
+    return false;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_DecodeObject(const char *value, size_t buffer_length, const cJSON_Field *fields, size_t field_count, void *destination, unsigned long *found)
+{
+    cJSON_ParseError parse_error = { 0, cJSON_ErrorNone };
+    const cJSON_bool decoded = decode_object(value, buffer_length, fields, field_count, destination, found, &parse_error);
+
+    publish_parse_error(value, &parse_error);
+
+    return decoded;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_DecodeObjectWithError(const char *value, size_t buffer_length, const cJSON_Field *fields, size_t field_count, void *destination, unsigned long *found, cJSON_ParseError *parse_error)
+{
+    cJSON_ParseError ignored = { 0, cJSON_ErrorNone };
+
+    return decode_object(value, buffer_length, fields, field_count, destination, found, (parse_error != NULL) ? parse_error : &ignored);
+}
+
+static cJSON *get_object_item(const cJSON * const object, const char * const name, const cJSON_bool case_sensitive);
+
+/* copy a string into a field of size bytes, cutting it short on a character boundary */
+static void copy_string_field(unsigned char * const destination, size_t size, const unsigned char * const string)
+{
+    size_t length = strlen((const char*)string);
+
+    if (length >= size)
+    {
+        length = size - 1;
+        /* drop the lead byte of a sequence whose continuation bytes don't fit */
+        while ((length > 0) && ((string[length] & 0xC0) == 0x80))
+        {
+            length--;
+        }
+    }
+
+    memcpy(destination, string, length);
+    destination[length] = '\0';
+}
+
+/* Store item in the destination of field, returns false if it has another type. */
+static cJSON_bool decode_item_field(const cJSON * const item, const cJSON_Field * const field, unsigned char * const destination)
+{
+    switch (field->type)
+    {
+        case cJSON_FieldInt:
+        case cJSON_FieldInt64:
+        case cJSON_FieldDouble:
+            if (!cJSON_IsNumber(item))
+            {
+                return false;
+            }
+            if (field->type == cJSON_FieldInt)
+            {
+                *(int*)(void*)destination = item->valueint;
+            }
+            else if (field->type == cJSON_FieldInt64)
+            {
+                *(int64_t*)(void*)destination = item->valueint64;
+            }
+            else
+            {
+                *(double*)(void*)destination = item->valuedouble;
+            }
+            return true;
+
+        case cJSON_FieldBool:
+            if (!cJSON_IsBool(item))
+            {
+                return false;
+            }
+            *(cJSON_bool*)(void*)destination = cJSON_IsTrue(item);
+            return true;
+
+        case cJSON_FieldString:
+            if (!cJSON_IsString(item) || (item->valuestring == NULL) || (field->size == 0))
+            {
+                return false;
+            }
+            copy_string_field(destination, field->size, (const unsigned char*)item->valuestring);
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_DecodeItem(const cJSON *object, const cJSON_Field *fields, size_t field_count, void *destination, unsigned long *found)
+{
+    unsigned long found_fields = 0;
+    size_t field_index = 0;
+
+    if (!cJSON_IsObject(object) || ((fields == NULL) && (field_count > 0)) || (destination == NULL) || (field_count > CJSON_DECODE_MAX_FIELDS))
+    {
+        return false;
+    }
+
+    for (field_index = 0; field_index < field_count; field_index++)
+    {
+        const cJSON * const item = get_object_item(object, fields[field_index].name, true);
+
+        if ((item != NULL) && decode_item_field(item, &fields[field_index], (unsigned char*)destination + fields[field_index].offset))
+        {
+            found_fields |= 1UL << field_index;
+        }
+    }
+
+    if (found != NULL)
+    {
+        *found = found_fields;
+    }
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_DecodeItemWithQueries(const cJSON *root, const cJSON_Query *queries, const cJSON_Field *fields, size_t field_count, void *destination, unsigned long *found)
+{
+    unsigned long found_fields = 0;
+    size_t field_index = 0;
+
+    if ((root == NULL) || (((fields == NULL) || (queries == NULL)) && (field_count > 0)) || (destination == NULL) || (field_count > CJSON_DECODE_MAX_FIELDS))
+    {
+        return false;
+    }
+
+    for (field_index = 0; field_index < field_count; field_index++)
+    {
+        const cJSON * const item = cJSON_GetQueryItem(root, &queries[field_index]);
+
+        if ((item != NULL) && decode_item_field(item, &fields[field_index], (unsigned char*)destination + fields[field_index].offset))
+        {
+            found_fields |= 1UL << field_index;
+        }
+    }
+
+    if (found != NULL)
+    {
+        *found = found_fields;
+    }
+
+    return true;
+}
+
+/* Tape entries: the tag in the top byte, a 32 bit offset in the low half.
+ * '{' and '[' hold the entry after their end and, in bits 32..55, their (saturated) element count,
+ * '}' and ']' hold their start, '\"' holds the offset of its string, 'l' and 'd' are followed by
+ * an entry with the raw int64_t or double, and 'n', 't' and 'f' carry nothing. */
+#define tape_entry(tag, offset) ((((uint64_t)(tag)) << 56) | (uint64_t)(offset))
+#define tape_tag(entry) ((unsigned char)((entry) >> 56))
+#define tape_offset(entry) ((size_t)((entry) & 0xFFFFFFFFUL))
+#define tape_count(entry) ((size_t)(((entry) >> 32) & 0xFFFFFFUL))
+#define TAPE_MAX_COUNT 0xFFFFFFUL
+#define TAPE_MAX_LENGTH 0xFFFFFFFFUL
+
+struct cJSON_Tape
+{
+    uint64_t *entries;
+    const char *strings; /* zero terminated, right behind the entries */
+    size_t entry_count;
+    size_t size; /* of the whole block */
+};
+
+#define tape_header_size arena_align(sizeof(cJSON_Tape))
+
+typedef struct
+{
+    cJSON_Tape *tape;
+    size_t entry_capacity;
+    unsigned char *strings;
+    size_t strings_length;
+} tape_builder;
+
+static cJSON_bool tape_push(tape_builder * const builder, uint64_t entry)
+{
+    if (builder->tape->entry_count >= builder->entry_capacity)
+    {
+        return false;
+    }
+    builder->tape->entries[builder->tape->entry_count++] = entry;
+
+    return true;
+}
+
+static cJSON_bool tape_parse_string(tape_builder * const builder, parse_buffer * const input_buffer)
+{
+    const unsigned char * const input_pointer = buffer_at_offset(input_buffer) + 1;
+    const unsigned char *input_end = NULL;
+    unsigned char *output = builder->strings + builder->strings_length;
+    unsigned char *terminator = NULL;
+    const unsigned char *failed_at = NULL;
+    size_t skipped_bytes = 0;
+    cJSON_bool truncated = false;
+
+    input_end = find_string_end(input_buffer, &skipped_bytes);
+    if (input_end == NULL)
+    {
+        return false;
+    }
+
+    /* the quotes of every string leave room for its terminator */
+    terminator = unescape_string(input_pointer, input_end, output, (size_t)(input_end - input_pointer) + sizeof(""), &truncated, &failed_at);
+    if (terminator == NULL)
+    {
+        input_buffer->offset = (size_t)(failed_at - input_buffer->content);
+        return false;
+    }
+    if (!tape_push(builder, tape_entry('\"', builder->strings_length)))
+    {
+        return false;
+    }
+    builder->strings_length += (size_t)(terminator - output) + sizeof("");
+    input_buffer->offset = (size_t)(input_end - input_buffer->content) + 1;
+
+    return true;
+}
+
+static cJSON_bool tape_parse_value(tape_builder * const builder, parse_buffer * const input_buffer);
+
+static cJSON_bool tape_parse_container(tape_builder * const builder, parse_buffer * const input_buffer)
+{
+    const unsigned char opening = buffer_at_offset(input_buffer)[0];
+    const unsigned char closing = (opening == '[') ? ']' : '}';
+    const size_t start = builder->tape->entry_count;
+    size_t count = 0;
+
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        input_buffer->error = cJSON_ErrorDepth;
+        return false; /* to deeply nested */
+    }
+    input_buffer->depth++;
+
+    /* the start entry is completed once the end is known */
+    if (!tape_push(builder, tape_entry(opening, 0)))
+    {
+        return false;
+    }
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == closing))
+    {
+        goto success; /* empty array or object */
+    }
+
+    /* step back to character in front of the first element */
+    input_buffer->offset--;
+    do
+    {
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (opening == '{')
+        {
+            if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '\"') || !tape_parse_string(builder, input_buffer))
+            {
+                return false; /* failed to parse name */
+            }
+            buffer_skip_whitespace(input_buffer);
+            if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+            {
+                return false; /* invalid object */
+            }
+            input_buffer->offset++;
+            buffer_skip_whitespace(input_buffer);
+        }
+
+        if (!tape_parse_value(builder, input_buffer))
+        {
+            return false;
+        }
+        count++;
+        buffer_skip_whitespace(input_buffer);
+    }
+    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != closing))
+    {
+        return false; /* expected end of array or object */
+    }
+
+success:
+    input_buffer->depth--;
+    input_buffer->offset++;
+
+    if (!tape_push(builder, tape_entry(closing, start)))
+    {
+        return false;
+    }
+    if (count > TAPE_MAX_COUNT)
+    {
+        count = TAPE_MAX_COUNT;
+    }
+    builder->tape->entries[start] = tape_entry(opening, builder->tape->entry_count) | (((uint64_t)count) << 32);
+
+    return true;
+}
+
+static cJSON_bool tape_parse_value(tape_builder * const builder, parse_buffer * const input_buffer)
+{
+    cJSON scratch;
+    uint64_t raw = 0;
+
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        return false;
+    }
+
+    switch (buffer_at_offset(input_buffer)[0])
+    {
+        case '\"':
+            return tape_parse_string(builder, input_buffer);
+
+        case '[':
+        case '{':
+            return tape_parse_container(builder, input_buffer);
+
+        default:
+            break;
+    }
+
+    /* literals and numbers are parsed without allocating */
+    memset(&scratch, '\0', sizeof(scratch));
+    if (!parse_scalar(&scratch, input_buffer))
+    {
+        return false;
+    }
+
+    switch (scratch.type & 0xFF)
+    {
+        case cJSON_NULL:
+            return tape_push(builder, tape_entry('n', 0));
+
+        case cJSON_True:
+            return tape_push(builder, tape_entry('t', 0));
+
+        case cJSON_False:
+            return tape_push(builder, tape_entry('f', 0));
+
+        case cJSON_Number:
+            if (scratch.valuedouble == (double)scratch.valueint64)
+            {
+                return tape_push(builder, tape_entry('l', 0)) && tape_push(builder, (uint64_t)scratch.valueint64);
+            }
+            memcpy(&raw, &scratch.valuedouble, sizeof(raw));
+            return tape_push(builder, tape_entry('d', 0)) && tape_push(builder, raw);
+
+        default:
+            return false;
+    }
+}
+
+/* move the strings right behind the used entries and give the rest of the block back */
+static cJSON_Tape *tape_shrink(cJSON_Tape *tape, size_t strings_length)
+{
+    const size_t entries_size = tape->entry_count * sizeof(uint64_t);
+    const size_t size = tape_header_size + entries_size + strings_length;
+    cJSON_Tape *shrunk = NULL;
+
+    memmove((unsigned char*)tape->entries + entries_size, tape->strings, strings_length);
+    if (global_hooks.reallocate != NULL)
+    {
+        shrunk = (cJSON_Tape*)global_hooks.reallocate(tape, size);
+        if (shrunk == NULL)
+        {
+            /* keep the bigger block */
+            shrunk = tape;
         }
-        else if ((input[i] >= 'A') && (input[i] <= 'F'))
+    }
+    else
+    {
+        profile_at(cJSON_SiteTape);
+        shrunk = (cJSON_Tape*)global_hooks.allocate(size);
+        if (shrunk == NULL)
         {
-            h += (unsigned int) 10 + input[i] - 'A';
+            shrunk = tape;
         }
-        else if ((input[i] >= 'a') && (input[i] <= 'f'))
+        else
         {
-            h += (unsigned int) 10 + input[i] - 'a';
+            memcpy(shrunk, tape, size);
+            global_hooks.deallocate(tape);
         }
-        else /* invalid */
+    }
+
+    if (shrunk->size > size)
+    {
+        shrunk->size = size;
+    }
+    shrunk->entries = (uint64_t*)(void*)((unsigned char*)shrunk + tape_header_size);
+    shrunk->strings = (const char*)shrunk->entries + entries_size;
+
+    return shrunk;
+}
+
+CJSON_PUBLIC(cJSON_Tape *) cJSON_ParseTape(const char *value, size_t buffer_length)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+    tape_builder builder;
+    size_t values = 1;
+    size_t containers = 0;
+    size_t i = 0;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if ((value == NULL) || (buffer_length == 0) || (buffer_length > TAPE_MAX_LENGTH))
+    {
+        return NULL;
+    }
+
+    /* as for arenas, every value is introduced by the start of the document, '[', '{' or ','.
+     * It takes at most two entries and one more for its name, containers one more for their end */
+    for (i = 0; i < buffer_length; i++)
+    {
+        if ((value[i] == '[') || (value[i] == '{'))
         {
-            return 0;
+            containers++;
+            values++;
+        }
+        else if (value[i] == ',')
+        {
+            values++;
         }
+    }
 
-        if (i < 3)
+    memset(&builder, '\0', sizeof(builder));
+    builder.entry_capacity = (3 * values) + containers;
+    if (builder.entry_capacity > ((TAPE_MAX_LENGTH - tape_header_size - buffer_length) / sizeof(uint64_t)))
+    {
+        return NULL;
+    }
+    profile_at(cJSON_SiteTape);
+    builder.tape = (cJSON_Tape*)global_hooks.allocate(tape_header_size + (builder.entry_capacity * sizeof(uint64_t)) + buffer_length);
+    if (builder.tape == NULL)
+    {
+        return NULL;
+    }
+    builder.tape->entries = (uint64_t*)(void*)((unsigned char*)builder.tape + tape_header_size);
+    builder.tape->entry_count = 0;
+    builder.tape->size = tape_header_size + (builder.entry_capacity * sizeof(uint64_t)) + buffer_length;
+    builder.strings = (unsigned char*)(builder.tape->entries + builder.entry_capacity);
+    builder.tape->strings = (const char*)builder.strings;
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.hooks = global_hooks;
+
+    if (!tape_parse_value(&builder, buffer_skip_whitespace(skip_utf8_bom(&buffer))))
+    {
+        cJSON_ParseError parse_error = { 0, cJSON_ErrorNone };
+        record_parse_error(&buffer, value, NULL, &parse_error);
+        publish_parse_error(value, &parse_error);
+        global_hooks.deallocate(builder.tape);
+
+        return NULL;
+    }
+
+    return tape_shrink(builder.tape, builder.strings_length);
+}
+
+CJSON_PUBLIC(void) cJSON_DeleteTape(cJSON_Tape *tape)
+{
+    if (tape != NULL)
+    {
+        global_hooks.deallocate(tape);
+    }
+}
+
+CJSON_PUBLIC(size_t) cJSON_TapeMemorySize(const cJSON_Tape *tape)
+{
+    return (tape != NULL) ? tape->size : 0;
+}
+
+static cJSON_TapeItem tape_item(const cJSON_Tape * const tape, size_t index, size_t key)
+{
+    cJSON_TapeItem item;
+
+    item.tape = tape;
+    item.index = index;
+    item.key = key;
+
+    return item;
+}
+
+#define tape_item_entry(item) ((item).tape->entries[(item).index])
+
+/* the entry behind the value at index */
+static size_t tape_skip(const cJSON_Tape * const tape, size_t index)
+{
+    switch (tape_tag(tape->entries[index]))
+    {
+        case '[':
+        case '{':
+            return tape_offset(tape->entries[index]);
+
+        case 'l':
+        case 'd':
+            return index + 2;
+
+        default:
+            return index + 1;
+    }
+}
+
+/* the element at index of a container that starts with opening, invalid on its end */
+static cJSON_TapeItem tape_element(const cJSON_Tape * const tape, size_t index, unsigned char opening)
+{
+    const unsigned char tag = tape_tag(tape->entries[index]);
+
+    if ((tag == ']') || (tag == '}'))
+    {
+        return tape_item(NULL, 0, 0);
+    }
+    if (opening == '{')
+    {
+        return tape_item(tape, index + 1, index);
+    }
+
+    return tape_item(tape, index, 0);
+}
+
+CJSON_PUBLIC(cJSON_TapeItem) cJSON_TapeRoot(const cJSON_Tape *tape)
+{
+    if ((tape == NULL) || (tape->entry_count == 0))
+    {
+        return tape_item(NULL, 0, 0);
+    }
+
+    return tape_item(tape, 0, 0);
+}
+
+CJSON_PUBLIC(int) cJSON_TapeType(cJSON_TapeItem item)
+{
+    if (item.tape == NULL)
+    {
+        return cJSON_Invalid;
+    }
+
+    switch (tape_tag(tape_item_entry(item)))
+    {
+        case 'f':
+            return cJSON_False;
+        case 't':
+            return cJSON_True;
+        case 'n':
+            return cJSON_NULL;
+        case 'l':
+        case 'd':
+            return cJSON_Number;
+        case '\"':
+            return cJSON_String;
+        case '[':
+            return cJSON_Array;
+        case '{':
+            return cJSON_Object;
+        default:
+            return cJSON_Invalid;
+    }
+}
+
+CJSON_PUBLIC(cJSON_TapeItem) cJSON_TapeChild(cJSON_TapeItem item)
+{
+    unsigned char tag = 0;
+
+    if (item.tape == NULL)
+    {
+        return item;
+    }
+
+    tag = tape_tag(tape_item_entry(item));
+    if ((tag != '[') && (tag != '{'))
+    {
+        return tape_item(NULL, 0, 0);
+    }
+
+    return tape_element(item.tape, item.index + 1, tag);
+}
+
+CJSON_PUBLIC(cJSON_TapeItem) cJSON_TapeNext(cJSON_TapeItem item)
+{
+    size_t next = 0;
+
+    if ((item.tape == NULL) || (item.index == 0))
+    {
+        return tape_item(NULL, 0, 0); /* the root has no siblings */
+    }
+
+    next = tape_skip(item.tape, item.index);
+    return tape_element(item.tape, next, (item.key != 0) ? '{' : '[');
+}
+
+CJSON_PUBLIC(const char *) cJSON_TapeGetKey(cJSON_TapeItem item)
+{
+    if ((item.tape == NULL) || (item.key == 0))
+    {
+        return NULL;
+    }
+
+    return item.tape->strings + tape_offset(item.tape->entries[item.key]);
+}
+
+CJSON_PUBLIC(cJSON_TapeItem) cJSON_TapeGetObjectItemCaseSensitive(cJSON_TapeItem object, const char *string)
+{
+    cJSON_TapeItem member;
+
+    if ((cJSON_TapeType(object) != cJSON_Object) || (string == NULL))
+    {
+        return tape_item(NULL, 0, 0);
+    }
+
+    for (member = cJSON_TapeChild(object); member.tape != NULL; member = cJSON_TapeNext(member))
+    {
+        if (strcmp(cJSON_TapeGetKey(member), string) == 0)
         {
-            /* shift left to make place for the next nibble */
-            h = h << 4;
+            return member;
+        }
+    }
+
+    return member;
+}
+
+CJSON_PUBLIC(int) cJSON_TapeGetArraySize(cJSON_TapeItem array)
+{
+    cJSON_TapeItem element;
+    size_t size = 0;
+    unsigned char tag = 0;
+
+    if (array.tape == NULL)
+    {
+        return 0;
+    }
+    tag = tape_tag(tape_item_entry(array));
+    if ((tag != '[') && (tag != '{'))
+    {
+        return 0;
+    }
+
+    size = tape_count(tape_item_entry(array));
+    if (size == TAPE_MAX_COUNT)
+    {
+        /* saturated, count them */
+        size = 0;
+        for (element = cJSON_TapeChild(array); element.tape != NULL; element = cJSON_TapeNext(element))
+        {
+            size++;
+        }
+    }
+
+    return (int)size;
+}
+
+CJSON_PUBLIC(cJSON_TapeItem) cJSON_TapeGetArrayItem(cJSON_TapeItem array, int index)
+{
+    cJSON_TapeItem element = cJSON_TapeChild(array);
+
+    if (index < 0)
+    {
+        return tape_item(NULL, 0, 0);
+    }
+
+    while ((element.tape != NULL) && (index > 0))
+    {
+        index--;
+        element = cJSON_TapeNext(element);
+    }
+
+    return element;
+}
+
+CJSON_PUBLIC(const char *) cJSON_TapeGetStringValue(cJSON_TapeItem item)
+{
+    if (cJSON_TapeType(item) != cJSON_String)
+    {
+        return NULL;
+    }
+
+    return item.tape->strings + tape_offset(tape_item_entry(item));
+}
+
+CJSON_PUBLIC(double) cJSON_TapeGetNumberValue(cJSON_TapeItem item)
+{
+    double number = 0;
+
+    if (cJSON_TapeType(item) != cJSON_Number)
+    {
+        return (double) NAN;
+    }
+
+    if (tape_tag(tape_item_entry(item)) == 'l')
+    {
+        return (double)(int64_t)item.tape->entries[item.index + 1];
+    }
+    memcpy(&number, &item.tape->entries[item.index + 1], sizeof(number));
+
+    return number;
+}
+
+CJSON_PUBLIC(int64_t) cJSON_TapeGetInt64Value(cJSON_TapeItem item)
+{
+    if (cJSON_TapeType(item) != cJSON_Number)
+    {
+        return 0;
+    }
+
+    if (tape_tag(tape_item_entry(item)) == 'l')
+    {
+        return (int64_t)item.tape->entries[item.index + 1];
+    }
+
+    return int64_from_double(cJSON_TapeGetNumberValue(item));
+}
+
+static cJSON_Cursor cursor_item(const char * const json, size_t length, size_t offset, size_t key, size_t depth)
+{
+    cJSON_Cursor item;
+
+    item.json = json;
+    item.length = length;
+    item.offset = offset;
+    item.key = key;
+    item.depth = depth;
+
+    return item;
+}
+
+/* first non whitespace character at or after offset, the document has been checked so there always is one inside containers */
+static size_t cursor_skip_whitespace(const cJSON_Cursor item, size_t offset)
+{
+    const unsigned char * const content = (const unsigned char*)item.json;
+
+    while ((offset < item.length) && (content[offset] <= 32))
+    {
+        offset++;
+    }
+
+    return offset;
+}
+
+/* the character behind the string literal whose opening quote is at offset */
+static size_t cursor_skip_string(const cJSON_Cursor item, size_t offset)
+{
+    const unsigned char * const content = (const unsigned char*)item.json;
+    const unsigned char *pointer = content + offset + 1;
+
+    for (;;)
+    {
+        /* scan_string stops in front of the word holding the quote, the rest is stepped over here */
+        pointer = scan_string(pointer, content + item.length);
+        while ((*pointer != '\"') && (*pointer != '\\'))
+        {
+            pointer++;
+        }
+        if (*pointer == '\"')
+        {
+            break;
+        }
+        pointer += 2;
+    }
+
+    return (size_t)(pointer - content) + 1;
+}
+
+/* the character behind the value of item. Only quotes and brackets are looked at, everything else has been checked. */
+static size_t cursor_skip(const cJSON_Cursor item)
+{
+    const unsigned char * const content = (const unsigned char*)item.json;
+    size_t offset = item.offset;
+    size_t depth = 0;
+
+    do
+    {
+        switch (content[offset])
+        {
+            case '\"':
+                offset = cursor_skip_string(item, offset);
+                break;
+
+            case '[':
+            case '{':
+                depth++;
+                offset++;
+                break;
+
+            case ']':
+            case '}':
+                depth--;
+                offset++;
+                break;
+
+            default:
+                if (depth > 0)
+                {
+                    offset++;
+                    break;
+                }
+                /* a number or literal on its own */
+                while ((offset < item.length) && (content[offset] > 32) && (content[offset] != ',') && (content[offset] != ']') && (content[offset] != '}'))
+                {
+                    offset++;
+                }
+                break;
         }
     }
+    while (depth > 0);
 
-    return h;
+    return offset;
 }
 
-/* converts a UTF-16 literal to UTF-8
- * A literal can be one or two sequences of the form \uXXXX */
-static unsigned char utf16_literal_to_utf8(const unsigned char * const input_pointer, const unsigned char * const input_end, unsigned char **output_pointer)
+/* the element starting at offset of a container that item is in (object) or that item is (child), invalid on its end */
+static cJSON_Cursor cursor_element(const cJSON_Cursor item, size_t offset, cJSON_bool object, size_t depth)
 {
-    long unsigned int codepoint = 0;
-    unsigned int first_code = 0;
-    const unsigned char *first_sequence = input_pointer;
-    unsigned char utf8_length = 0;
-    unsigned char utf8_position = 0;
-    unsigned char sequence_length = 0;
-    unsigned char first_byte_mark = 0;
+    const unsigned char * const content = (const unsigned char*)item.json;
+    size_t key = 0;
 
-    if ((input_end - first_sequence) < 6)
+    if ((content[offset] == ']') || (content[offset] == '}'))
     {
-        /* input ends unexpectedly */
-        goto fail;
+        return cursor_item(NULL, 0, 0, 0, 0);
+    }
+    if (object)
+    {
+        /* step over the name and the colon */
+        key = offset;
+        offset = cursor_skip_whitespace(item, cursor_skip_string(item, offset));
+        offset = cursor_skip_whitespace(item, offset + 1);
     }
 
-    /* get the first utf16 sequence */
-    first_code = parse_hex4(first_sequence + 2);
+    return cursor_item(item.json, item.length, offset, key, depth);
+}
 
-    /* check that the code is valid */
-    if (((first_code >= 0xDC00) && (first_code <= 0xDFFF)))
+/* a parse buffer positioned at offset */
+static void cursor_buffer(const cJSON_Cursor item, size_t offset, parse_buffer * const buffer)
+{
+    memset(buffer, '\0', sizeof(*buffer));
+    buffer->content = (const unsigned char*)item.json;
+    buffer->length = item.length;
+    buffer->offset = offset;
+    buffer->hooks = global_hooks;
+}
+
+/* unescape the string literal with its opening quote at offset */
+static const char *cursor_copy_string(const cJSON_Cursor item, size_t offset, char * const output, size_t output_size, cJSON_bool * const truncated)
+{
+    parse_buffer buffer;
+    const unsigned char *string_end = NULL;
+    size_t skipped_bytes = 0;
+
+    if ((output == NULL) || (output_size == 0))
     {
-        goto fail;
+        return NULL;
     }
 
-    /* UTF16 surrogate pair */
-    if ((first_code >= 0xD800) && (first_code <= 0xDBFF))
+    cursor_buffer(item, offset, &buffer);
+    string_end = find_string_end(&buffer, &skipped_bytes);
+    if ((string_end == NULL) || (unescape_string(buffer_at_offset(&buffer) + 1, string_end, (unsigned char*)output, output_size, truncated, NULL) == NULL))
     {
-        const unsigned char *second_sequence = first_sequence + 6;
-        unsigned int second_code = 0;
-        sequence_length = 12; /* \uXXXX\uXXXX */
+        return NULL;
+    }
 
-        if ((input_end - second_sequence) < 6)
+    return output;
+}
+
+/* compare the member name of item to string, names without escapes are compared where they are */
+static cJSON_bool cursor_key_equals(const cJSON_Cursor item, const char * const string)
+{
+    const unsigned char *name = (const unsigned char*)item.json + item.key + 1;
+    const unsigned char *expected = (const unsigned char*)string;
+    unsigned char unescaped[CJSON_DECODE_NAME_LENGTH];
+    cJSON_bool truncated = false;
+
+    for (;;)
+    {
+        if (*name == '\\')
         {
-            /* input ends unexpectedly */
-            goto fail;
+            break;
         }
-
-        if ((second_sequence[0] != '\\') || (second_sequence[1] != 'u'))
+        if (*name == '\"')
         {
-            /* missing second half of the surrogate pair */
-            goto fail;
+            return *expected == '\0';
         }
-
-        /* get the second utf16 sequence */
-        second_code = parse_hex4(second_sequence + 2);
-        /* check that the code is valid */
-        if ((second_code < 0xDC00) || (second_code > 0xDFFF))
+        if (*name != *expected)
         {
-            /* invalid second half of the surrogate pair */
-            goto fail;
+            return false;
         }
+        name++;
+        expected++;
+    }
 
+    /* names that don't fit can't be compared */
+    if ((cursor_copy_string(item, item.key, (char*)unescaped, sizeof(unescaped), &truncated) == NULL) || truncated)
+    {
+        return false;
+    }
 
-        /* calculate the unicode codepoint from the surrogate pair */
-        codepoint = 0x10000 + (((first_code & 0x3FF) << 10) | (second_code & 0x3FF));
+    return strcmp((const char*)unescaped, string) == 0;
+}
+
+CJSON_PUBLIC(cJSON_Cursor) cJSON_CursorRoot(const char *value, size_t buffer_length)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+    size_t start = 0;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if ((value == NULL) || (buffer_length == 0))
+    {
+        return cursor_item(NULL, 0, 0, 0, 0);
     }
-    else
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.hooks = global_hooks;
+
+    buffer_skip_whitespace(skip_utf8_bom(&buffer));
+    start = buffer.offset;
+    if (!skip_value(&buffer))
     {
-        sequence_length = 6; /* \uXXXX */
-        codepoint = first_code;
+        cJSON_ParseError parse_error = { 0, cJSON_ErrorNone };
+        record_parse_error(&buffer, value, NULL, &parse_error);
+        publish_parse_error(value, &parse_error);
+        return cursor_item(NULL, 0, 0, 0, 0);
     }
 
-    /* encode as UTF-8
-     * takes at maximum 4 bytes to encode:
-     * 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx */
-    if (codepoint < 0x80)
+    return cursor_item(value, buffer_length, start, 0, 0);
+}
+
+CJSON_PUBLIC(int) cJSON_CursorType(cJSON_Cursor item)
+{
+    if (item.json == NULL)
     {
-        /* normal ascii, encoding 0xxxxxxx */
-        utf8_length = 1;
+        return cJSON_Invalid;
     }
-    else if (codepoint < 0x800)
+
+    switch (item.json[item.offset])
     {
-        /* two bytes, encoding 110xxxxx 10xxxxxx */
-        utf8_length = 2;
-        first_byte_mark = 0xC0; /* 11000000 */
+        case 'f':
+            return cJSON_False;
+        case 't':
+            return cJSON_True;
+        case 'n':
+            return cJSON_NULL;
+        case '\"':
+            return cJSON_String;
+        case '[':
+            return cJSON_Array;
+        case '{':
+            return cJSON_Object;
+        default:
+            return cJSON_Number;
     }
-    else if (codepoint < 0x10000)
+}
+
+CJSON_PUBLIC(cJSON_Cursor) cJSON_CursorChild(cJSON_Cursor item)
+{
+    const int type = cJSON_CursorType(item);
+
+    if ((type != cJSON_Array) && (type != cJSON_Object))
     {
-        /* three bytes, encoding 1110xxxx 10xxxxxx 10xxxxxx */
-        utf8_length = 3;
-        first_byte_mark = 0xE0; /* 11100000 */
+        return cursor_item(NULL, 0, 0, 0, 0);
     }
-    else if (codepoint <= 0x10FFFF)
+
+    return cursor_element(item, cursor_skip_whitespace(item, item.offset + 1), type == cJSON_Object, item.depth + 1);
+}
+
+CJSON_PUBLIC(cJSON_Cursor) cJSON_CursorNext(cJSON_Cursor item)
+{
+    size_t next = 0;
+
+    if ((item.json == NULL) || (item.depth == 0))
     {
-        /* four bytes, encoding 1110xxxx 10xxxxxx 10xxxxxx 10xxxxxx */
-        utf8_length = 4;
-        first_byte_mark = 0xF0; /* 11110000 */
+        return cursor_item(NULL, 0, 0, 0, 0); /* the root has no siblings */
     }
-    else
+
+    next = cursor_skip_whitespace(item, cursor_skip(item));
+    if (item.json[next] != ',')
     {
-        /* invalid unicode codepoint */
-        goto fail;
+        return cursor_item(NULL, 0, 0, 0, 0);
     }
 
-    /* encode as utf8 */
-    for (utf8_position = (unsigned char)(utf8_length - 1); utf8_position > 0; utf8_position--)
+    return cursor_element(item, cursor_skip_whitespace(item, next + 1), item.key != 0, item.depth);
+}
+
+CJSON_PUBLIC(cJSON_Cursor) cJSON_CursorGetObjectItemCaseSensitive(cJSON_Cursor object, const char *string)
+{
+    if (cJSON_CursorType(object) != cJSON_Object)
     {
-        /* 10xxxxxx */
-        (*output_pointer)[utf8_position] = (unsigned char)((codepoint | 0x80) & 0xBF);
-        codepoint >>= 6;
+        return cursor_item(NULL, 0, 0, 0, 0);
     }
-    /* encode first byte */
-    if (utf8_length > 1)
+
+    return cJSON_CursorFindCaseSensitive(cJSON_CursorChild(object), string);
+}
+
+CJSON_PUBLIC(cJSON_Cursor) cJSON_CursorFindCaseSensitive(cJSON_Cursor member, const char *string)
+{
+    if ((member.key == 0) || (string == NULL))
     {
-        (*output_pointer)[0] = (unsigned char)((codepoint | first_byte_mark) & 0xFF);
+        return cursor_item(NULL, 0, 0, 0, 0);
     }
-    else
+
+    for (; member.json != NULL; member = cJSON_CursorNext(member))
     {
-        (*output_pointer)[0] = (unsigned char)(codepoint & 0x7F);
+        if (cursor_key_equals(member, string))
+        {
+            return member;
+        }
     }
 
-    *output_pointer += utf8_length;
+    return member;
+}
 
-    return sequence_length;
+CJSON_PUBLIC(int) cJSON_CursorGetArraySize(cJSON_Cursor array)
+{
+    cJSON_Cursor element;
+    int size = 0;
 
-fail:
-    return 0;
+    for (element = cJSON_CursorChild(array); element.json != NULL; element = cJSON_CursorNext(element))
+    {
+        size++;
+    }
+
+    return size;
 }
 
-/* Parse the input text into an unescaped cinput, and populate item. */
-static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_buffer)
+CJSON_PUBLIC(cJSON_Cursor) cJSON_CursorGetArrayItem(cJSON_Cursor array, int index)
 {
-    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
-    const unsigned char *input_end = buffer_at_offset(input_buffer) + 1;
-    unsigned char *output_pointer = NULL;
-    unsigned char *output = NULL;
+    cJSON_Cursor element = cJSON_CursorChild(array);
 
-    /* not a string */
-    if (buffer_at_offset(input_buffer)[0] != '\"')
+    if (index < 0)
     {
-        goto fail;
+        return cursor_item(NULL, 0, 0, 0, 0);
     }
 
+    while ((element.json != NULL) && (index > 0))
     {
-        /* calculate approximate size of the output (overestimate) */
-        size_t allocation_length = 0;
-        size_t skipped_bytes = 0;
-        while (((size_t)(input_end - input_buffer->content) < input_buffer->length) && (*input_end != '\"'))
-        {
-            /* is escape sequence */
-            if (input_end[0] == '\\')
-            {
-                if ((size_t)(input_end + 1 - input_buffer->content) >= input_buffer->length)
-                {
-                    /* prevent buffer overflow when last input character is a backslash */
-                    goto fail;
-                }
-                skipped_bytes++;
-                input_end++;
-            }
-            input_end++;
-        }
-        if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
-        {
-            goto fail; /* string ended unexpectedly */
-        }
+        index--;
+        element = cJSON_CursorNext(element);
+    }
 
-        /* This is at most how much we need for the output */
-        allocation_length = (size_t) (input_end - buffer_at_offset(input_buffer)) - skipped_bytes;
-        output = (unsigned char*)input_buffer->hooks.allocate(allocation_length + sizeof(""));
-        if (output == NULL)
-        {
-            goto fail; /* allocation failure */
-        }
+    return element;
+}
+
+CJSON_PUBLIC(const char *) cJSON_CursorGetKey(cJSON_Cursor item, char *buffer, size_t buffer_size)
+{
+    cJSON_bool truncated = false;
+
+    if ((item.json == NULL) || (item.key == 0))
+    {
+        return NULL;
     }
 
-    output_pointer = output;
-    /* loop through the string literal */
-    while (input_pointer < input_end)
+    return cursor_copy_string(item, item.key, buffer, buffer_size, &truncated);
+}
+
+CJSON_PUBLIC(const char *) cJSON_CursorGetString(cJSON_Cursor item, char *buffer, size_t buffer_size)
+{
+    cJSON_bool truncated = false;
+
+    if (cJSON_CursorType(item) != cJSON_String)
     {
-        if (*input_pointer != '\\')
-        {
-            *output_pointer++ = *input_pointer++;
-        }
-        /* escape sequence */
-        else
-        {
-            unsigned char sequence_length = 2;
-            if ((input_end - input_pointer) < 1)
-            {
-                goto fail;
-            }
+        return NULL;
+    }
 
-            switch (input_pointer[1])
-            {
-                case 'b':
-                    *output_pointer++ = '\b';
-                    break;
-                case 'f':
-                    *output_pointer++ = '\f';
-                    break;
-                case 'n':
-                    *output_pointer++ = '\n';
-                    break;
-                case 'r':
-                    *output_pointer++ = '\r';
-                    break;
-                case 't':
-                    *output_pointer++ = '\t';
-                    break;
-                case '\"':
-                case '\\':
-                case '/':
-                    *output_pointer++ = input_pointer[1];
-                    break;
+    return cursor_copy_string(item, item.offset, buffer, buffer_size, &truncated);
+}
 
-                /* UTF-16 literal */
-                case 'u':
-                    sequence_length = utf16_literal_to_utf8(input_pointer, input_end, &output_pointer);
-                    if (sequence_length == 0)
-                    {
-                        /* failed to convert UTF16-literal to UTF-8 */
-                        goto fail;
-                    }
-                    break;
+CJSON_PUBLIC(double) cJSON_CursorGetNumberValue(cJSON_Cursor item)
+{
+    parse_buffer buffer;
+    cJSON scratch;
+
+    if (cJSON_CursorType(item) != cJSON_Number)
+    {
+        return (double) NAN;
+    }
+
+    cursor_buffer(item, item.offset, &buffer);
+    memset(&scratch, '\0', sizeof(scratch));
+    parse_number(&scratch, &buffer);
+
+    return scratch.valuedouble;
+}
+
+CJSON_PUBLIC(int64_t) cJSON_CursorGetInt64Value(cJSON_Cursor item)
+{
+    parse_buffer buffer;
+    cJSON scratch;
+
+    if (cJSON_CursorType(item) != cJSON_Number)
+    {
+        return 0;
+    }
+
+    cursor_buffer(item, item.offset, &buffer);
+    memset(&scratch, '\0', sizeof(scratch));
+    parse_number(&scratch, &buffer);
+
+    return scratch.valueint64;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CursorToItem(cJSON_Cursor item)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+    cJSON_ParseError parse_error = { 0, cJSON_ErrorNone };
+    cJSON *value = NULL;
+
+    if (item.json == NULL)
+    {
+        return NULL;
+    }
+
+    buffer.hooks = global_hooks;
+
+    value = parse_document(&buffer, item.json + item.offset, item.length - item.offset, NULL, false, &parse_error);
+    publish_parse_error(item.json + item.offset, &parse_error);
+
+    return value;
+}
+
+static cJSON_bool add_item_to_array(cJSON *array, cJSON *item);
+
+/* State of the incremental parser between chunks */
+typedef enum
+{
+    push_value, /* a value is expected */
+    push_value_or_end, /* right after '[' */
+    push_name, /* a member name is expected */
+    push_name_or_end, /* right after '{' */
+    push_colon,
+    push_comma_or_end,
+    push_done, /* the document is complete, only whitespace may follow */
+    push_failed
+} push_state;
+
+/* Kind of token that was cut off at the end of a chunk */
+typedef enum
+{
+    push_token_none,
+    push_token_string,
+    push_token_bare /* number or literal */
+} push_token;
+
+struct cJSON_PushParser
+{
+    internal_hooks hooks;
+    push_state state;
+    cJSON *root;
+    /* open arrays and objects, innermost last */
+    cJSON **stack;
+    size_t depth;
+    size_t stack_size;
+    /* member name waiting for its value */
+    unsigned char *name;
+    cJSON_bool name_shared; /* name is interned, not owned by the parser */
+    /* a token that is split across chunks is collected here */
+    push_token token_type;
+    cJSON_bool escaped;
+    unsigned char *token;
+    size_t token_length;
+    size_t token_size;
+};
+
+CJSON_PUBLIC(cJSON_PushParser *) cJSON_PushParserCreate(void)
+{
+    cJSON_PushParser *parser = NULL;
 
-                default:
-                    goto fail;
-            }
-            input_pointer += sequence_length;
-        }
+    profile_at(cJSON_SitePush);
+    parser = (cJSON_PushParser*)global_hooks.allocate(sizeof(cJSON_PushParser));
+    if (parser == NULL)
+    {
+        return NULL;
     }
 
-    /* zero terminate the output */
-    *output_pointer = '\0';
-
-    item->type = cJSON_String;
-    item->valuestring = (char*)output;
+    memset(parser, '\0', sizeof(cJSON_PushParser));
+    parser->hooks = global_hooks;
+    parser->state = push_value;
+    parser->token_type = push_token_none;
 
-    input_buffer->offset = (size_t) (input_end - input_buffer->content);
-    input_buffer->offset++;
+    return parser;
+}
 
-    return true;
+CJSON_PUBLIC(void) cJSON_PushParserReset(cJSON_PushParser *parser)
+{
+    if (parser == NULL)
+    {
+        return;
+    }
 
-fail:
-    if (output != NULL)
+    if (parser->root != NULL)
+    {
+        cJSON_Delete(parser->root);
+        parser->root = NULL;
+    }
+    if ((parser->name != NULL) && !parser->name_shared)
     {
-        input_buffer->hooks.deallocate(output);
+        parser->hooks.deallocate(parser->name);
     }
+    parser->name = NULL;
 
-    if (input_pointer != NULL)
+    /* the stack and token buffers are kept for the next document */
+    parser->state = push_value;
+    parser->depth = 0;
+    parser->token_type = push_token_none;
+    parser->escaped = false;
+    parser->token_length = 0;
+}
+
+CJSON_PUBLIC(void) cJSON_PushParserDelete(cJSON_PushParser *parser)
+{
+    if (parser == NULL)
     {
-        input_buffer->offset = (size_t)(input_pointer - input_buffer->content);
+        return;
     }
 
-    return false;
+    cJSON_PushParserReset(parser);
+    if (parser->stack != NULL)
+    {
+        parser->hooks.deallocate(parser->stack);
+    }
+    if (parser->token != NULL)
+    {
+        parser->hooks.deallocate(parser->token);
+    }
+    parser->hooks.deallocate(parser);
 }
 
-/* Render the cstring provided to an escaped version that can be printed. */
-static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffer * const output_buffer)
+/* grow a buffer owned by the parser to at least needed bytes */
+static cJSON_bool push_grow(const cJSON_PushParser * const parser, void **buffer, size_t * const size, size_t used, size_t needed)
 {
-    const unsigned char *input_pointer = NULL;
-    unsigned char *output = NULL;
-    unsigned char *output_pointer = NULL;
-    size_t output_length = 0;
-    /* numbers of additional characters needed for escaping */
-    size_t escape_characters = 0;
+    unsigned char *grown = NULL;
+    size_t new_size = (*size > 0) ? *size : 16;
 
-    if (output_buffer == NULL)
+    if (needed <= *size)
     {
-        return false;
+        return true;
     }
 
-    /* empty string */
-    if (input == NULL)
+    while (new_size < needed)
     {
-        output = ensure(output_buffer, sizeof("\"\""));
-        if (output == NULL)
+        if (new_size > (((size_t)-1) / 2))
         {
             return false;
         }
-        strcpy((char*)output, "\"\"");
-
-        return true;
+        new_size *= 2;
     }
 
-    /* set "flag" to 1 if something needs to be escaped */
-    for (input_pointer = input; *input_pointer; input_pointer++)
+    profile_at(cJSON_SitePush);
+    if (parser->hooks.reallocate != NULL)
     {
-        switch (*input_pointer)
+        grown = (unsigned char*)parser->hooks.reallocate(*buffer, new_size);
+        if (grown == NULL)
         {
-            case '\"':
-            case '\\':
-            case '\b':
-            case '\f':
-            case '\n':
-            case '\r':
-            case '\t':
-                /* one character escape sequence */
-                escape_characters++;
-                break;
-            default:
-                if (*input_pointer < 32)
-                {
-                    /* UTF-16 escape sequence uXXXX */
-                    escape_characters += 5;
-                }
-                break;
+            return false;
         }
     }
-    output_length = (size_t)(input_pointer - input) + escape_characters;
-
-    output = ensure(output_buffer, output_length + sizeof("\"\""));
-    if (output == NULL)
+    else
     {
-        return false;
+        grown = (unsigned char*)parser->hooks.allocate(new_size);
+        if (grown == NULL)
+        {
+            return false;
+        }
+        if (*buffer != NULL)
+        {
+            memcpy(grown, *buffer, used);
+            parser->hooks.deallocate(*buffer);
+        }
     }
 
-    /* no characters have to be escaped */
-    if (escape_characters == 0)
-    {
-        output[0] = '\"';
-        memcpy(output + 1, input, output_length);
-        output[output_length + 1] = '\"';
-        output[output_length + 2] = '\0';
+    *buffer = grown;
+    *size = new_size;
+
+    return true;
+}
+
+/* attach a new item to the innermost open container, or make it the root */
+static cJSON_bool push_add_item(cJSON_PushParser * const parser, cJSON * const item)
+{
+    cJSON *container = NULL;
 
+    if (parser->depth == 0)
+    {
+        parser->root = item;
         return true;
     }
 
-    output[0] = '\"';
-    output_pointer = output + 1;
-    /* copy the string */
-    for (input_pointer = input; *input_pointer != '\0'; (void)input_pointer++, output_pointer++)
+    container = parser->stack[parser->depth - 1];
+    if (cJSON_IsObject(container))
     {
-        if ((*input_pointer > 31) && (*input_pointer != '\"') && (*input_pointer != '\\'))
-        {
-            /* normal character, copy */
-            *output_pointer = *input_pointer;
-        }
-        else
+        item->string = (char*)parser->name;
+        if (parser->name_shared)
         {
-            /* character needs to be escaped */
-            *output_pointer++ = '\\';
-            switch (*input_pointer)
-            {
-                case '\\':
-                    *output_pointer = '\\';
-                    break;
-                case '\"':
-                    *output_pointer = '\"';
-                    break;
-                case '\b':
-                    *output_pointer = 'b';
-                    break;
-                case '\f':
-                    *output_pointer = 'f';
-                    break;
-                case '\n':
-                    *output_pointer = 'n';
-                    break;
-                case '\r':
-                    *output_pointer = 'r';
-                    break;
-                case '\t':
-                    *output_pointer = 't';
-                    break;
-                default:
-                    /* escape and print as unicode codepoint */
-                    sprintf((char*)output_pointer, "u%04x", *input_pointer);
-                    output_pointer += 4;
-                    break;
-            }
+            item->type |= cJSON_StringIsConst;
         }
+        parser->name = NULL;
     }
-    output[output_length + 1] = '\"';
-    output[output_length + 2] = '\0';
 
-    return true;
+    return add_item_to_array(container, item);
 }
 
-/* Invoke print_string_ptr (which is useful) on an item. */
-static cJSON_bool print_string(const cJSON * const item, printbuffer * const p)
+/* a value just ended, find out what comes next */
+static void push_value_done(cJSON_PushParser * const parser)
 {
-    return print_string_ptr((unsigned char*)item->valuestring, p);
+    parser->state = (parser->depth == 0) ? push_done : push_comma_or_end;
 }
 
-/* Predeclare these prototypes. */
-static cJSON_bool parse_value(cJSON * const item, parse_buffer * const input_buffer);
-static cJSON_bool print_value(const cJSON * const item, printbuffer * const output_buffer);
-static cJSON_bool parse_array(cJSON * const item, parse_buffer * const input_buffer);
-static cJSON_bool print_array(const cJSON * const item, printbuffer * const output_buffer);
-static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_buffer);
-static cJSON_bool print_object(const cJSON * const item, printbuffer * const output_buffer);
-
-/* Utility to jump whitespace and cr/lf */
-static parse_buffer *buffer_skip_whitespace(parse_buffer * const buffer)
+/* parse a complete string or bare token that starts at token */
+static cJSON_bool push_complete_token(cJSON_PushParser * const parser, push_token token_type, const unsigned char * const token, size_t length)
 {
-    if ((buffer == NULL) || (buffer->content == NULL))
-    {
-        return NULL;
-    }
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+    cJSON *item = NULL;
+
+    buffer.content = token;
+    buffer.length = length;
+    buffer.hooks = parser->hooks;
 
-    if (cannot_access_at_index(buffer, 0))
+    if ((token_type == push_token_string) && ((parser->state == push_name) || (parser->state == push_name_or_end)))
     {
-        return buffer;
+        parser->name = parse_key(&buffer, &parser->name_shared);
+        if (parser->name == NULL)
+        {
+            return false;
+        }
+        parser->state = push_colon;
+        return true;
     }
 
-    while (can_access_at_index(buffer, 0) && (buffer_at_offset(buffer)[0] <= 32))
+    item = cJSON_New_Item(&parser->hooks);
+    if (item == NULL)
     {
-       buffer->offset++;
+        return false;
     }
 
-    if (buffer->offset == buffer->length)
+    if (((token_type == push_token_string) && !parse_string(item, &buffer))
+        || ((token_type == push_token_bare) && (!parse_value(item, &buffer) || (buffer.offset != length)))
+        || !push_add_item(parser, item))
     {
-        buffer->offset--;
+        if (item != parser->root)
+        {
+            cJSON_Delete(item);
+        }
+        return false;
     }
 
-    return buffer;
+    push_value_done(parser);
+
+    return true;
 }
 
-/* skip the UTF-8 BOM (byte order mark) if it is at the beginning of a buffer */
-static parse_buffer *skip_utf8_bom(parse_buffer * const buffer)
+/* characters that can continue a number or a literal */
+static cJSON_bool is_bare_character(unsigned char character)
 {
-    if ((buffer == NULL) || (buffer->content == NULL) || (buffer->offset != 0))
+    return ((character >= '0') && (character <= '9')) || ((character >= 'a') && (character <= 'z'))
+        || (character == '-') || (character == '+') || (character == '.') || (character == 'E');
+}
+
+/* Scan the current token from position on.
+ * Returns the position just past the token and sets complete, or returns length if the chunk ends first. */
+static size_t push_scan_token(cJSON_PushParser * const parser, const unsigned char * const input, size_t position, size_t length, cJSON_bool * const complete)
+{
+    *complete = false;
+
+    if (parser->token_type == push_token_string)
     {
-        return NULL;
+        for (; position < length; position++)
+        {
+            if (!parser->escaped)
+            {
+                position = (size_t)(scan_string(input + position, input + length) - input);
+                if (position == length)
+                {
+                    break;
+                }
+            }
+
+            if (parser->escaped)
+            {
+                parser->escaped = false;
+            }
+            else if (input[position] == '\\')
+            {
+                parser->escaped = true;
+            }
+            else if (input[position] == '\"')
+            {
+                *complete = true;
+                return position + 1;
+            }
+        }
+        return length;
     }
 
-    if (can_access_at_index(buffer, 4) && (strncmp((const char*)buffer_at_offset(buffer), "\xEF\xBB\xBF", 3) == 0))
+    while ((position < length) && is_bare_character(input[position]))
     {
-        buffer->offset += 3;
+        position++;
     }
+    *complete = (position < length);
 
-    return buffer;
+    return position;
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated)
+/* open a new array or object */
+static cJSON_bool push_open(cJSON_PushParser * const parser, int type)
 {
-    size_t buffer_length;
+    void *stack = parser->stack;
+    cJSON *item = NULL;
 
-    if (NULL == value)
+    if (parser->depth >= CJSON_NESTING_LIMIT)
     {
-        return NULL;
+        return false; /* to deeply nested */
+    }
+    if (!push_grow(parser, &stack, &parser->stack_size, parser->depth * sizeof(cJSON*), (parser->depth + 1) * sizeof(cJSON*)))
+    {
+        return false;
     }
+    parser->stack = (cJSON**)stack;
 
-    /* Adding null character size due to require_null_terminated. */
-    buffer_length = strlen(value) + sizeof("");
+    item = cJSON_New_Item(&parser->hooks);
+    if (item == NULL)
+    {
+        return false;
+    }
+    item->type = type;
+    if (!push_add_item(parser, item))
+    {
+        cJSON_Delete(item);
+        return false;
+    }
 
-    return cJSON_ParseWithLengthOpts(value, buffer_length, return_parse_end, require_null_terminated);
+    parser->stack[parser->depth++] = item;
+    parser->state = (type == cJSON_Array) ? push_value_or_end : push_name_or_end;
+
+    return true;
 }
 
-/* Parse an object - create a new root, and populate. */
-CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+/* close the innermost array or object */
+static cJSON_bool push_close(cJSON_PushParser * const parser, unsigned char closing)
 {
-    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 } };
-    cJSON *item = NULL;
+    if ((parser->depth == 0) || ((parser->stack[parser->depth - 1]->type & 0xFF) != ((closing == ']') ? cJSON_Array : cJSON_Object)))
+    {
+        return false;
+    }
 
-    /* reset error position */
-    global_error.json = NULL;
-    global_error.position = 0;
+    parser->depth--;
+    push_value_done(parser);
 
-    if (value == NULL || 0 == buffer_length)
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_PushParserFeed(cJSON_PushParser *parser, const char *chunk, size_t length)
+{
+    const unsigned char *input = (const unsigned char*)chunk;
+    size_t position = 0;
+    cJSON_bool complete = false;
+
+    if ((parser == NULL) || ((chunk == NULL) && (length > 0)) || (parser->state == push_failed))
     {
-        goto fail;
+        return false;
     }
 
-    buffer.content = (const unsigned char*)value;
-    buffer.length = buffer_length;
-    buffer.offset = 0;
-    buffer.hooks = global_hooks;
+    while (position < length)
+    {
+        size_t token_start = position;
+
+        if (parser->token_type == push_token_none)
+        {
+            unsigned char character = input[position];
+            if (character <= 32)
+            {
+                position++;
+                continue;
+            }
+
+            switch (parser->state)
+            {
+                case push_value_or_end:
+                    if (character == ']')
+                    {
+                        if (!push_close(parser, character))
+                        {
+                            goto fail;
+                        }
+                        position++;
+                        continue;
+                    }
+                    /* fall through */
+                case push_value:
+                    if ((character == '[') || (character == '{'))
+                    {
+                        if (!push_open(parser, (character == '[') ? cJSON_Array : cJSON_Object))
+                        {
+                            goto fail;
+                        }
+                        position++;
+                        continue;
+                    }
+                    if (character == '\"')
+                    {
+                        parser->token_type = push_token_string;
+                        position++;
+                    }
+                    else if (is_bare_character(character))
+                    {
+                        parser->token_type = push_token_bare;
+                    }
+                    else
+                    {
+                        goto fail;
+                    }
+                    break;
+
+                case push_name_or_end:
+                    if (character == '}')
+                    {
+                        if (!push_close(parser, character))
+                        {
+                            goto fail;
+                        }
+                        position++;
+                        continue;
+                    }
+                    /* fall through */
+                case push_name:
+                    if (character != '\"')
+                    {
+                        goto fail;
+                    }
+                    parser->token_type = push_token_string;
+                    position++;
+                    break;
+
+                case push_colon:
+                    if (character != ':')
+                    {
+                        goto fail;
+                    }
+                    parser->state = push_value;
+                    position++;
+                    continue;
+
+                case push_comma_or_end:
+                    if (character == ',')
+                    {
+                        parser->state = cJSON_IsObject(parser->stack[parser->depth - 1]) ? push_name : push_value;
+                    }
+                    else if (!push_close(parser, character))
+                    {
+                        goto fail;
+                    }
+                    position++;
+                    continue;
 
-    item = cJSON_New_Item(&global_hooks);
-    if (item == NULL) /* memory fail */
-    {
-        goto fail;
-    }
+                default:
+                    goto fail; /* garbage after the document */
+            }
+            parser->escaped = false;
+        }
 
-    if (!parse_value(item, buffer_skip_whitespace(skip_utf8_bom(&buffer))))
-    {
-        /* parse failure. ep is set. */
-        goto fail;
-    }
+        position = push_scan_token(parser, input, position, length, &complete);
+        if ((parser->token_length == 0) && complete)
+        {
+            /* the whole token is in this chunk, parse it where it is */
+            if (!push_complete_token(parser, parser->token_type, input + token_start, position - token_start))
+            {
+                goto fail;
+            }
+            parser->token_type = push_token_none;
+            continue;
+        }
 
-    /* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator */
-    if (require_null_terminated)
-    {
-        buffer_skip_whitespace(&buffer);
-        if ((buffer.offset >= buffer.length) || buffer_at_offset(&buffer)[0] != '\0')
+        /* collect the token until its end arrives */
         {
-            goto fail;
+            void *token = parser->token;
+            if (!push_grow(parser, &token, &parser->token_size, parser->token_length, parser->token_length + (position - token_start)))
+            {
+                goto fail;
+            }
+            parser->token = (unsigned char*)token;
+        }
+        memcpy(parser->token + parser->token_length, input + token_start, position - token_start);
+        parser->token_length += position - token_start;
+
+        if (complete)
+        {
+            if (!push_complete_token(parser, parser->token_type, parser->token, parser->token_length))
+            {
+                goto fail;
+            }
+            parser->token_type = push_token_none;
+            parser->token_length = 0;
         }
-    }
-    if (return_parse_end)
-    {
-        *return_parse_end = (const char*)buffer_at_offset(&buffer);
     }
 
-    return item;
+    return true;
 
 fail:
-    if (item != NULL)
+    parser->state = push_failed;
+
+    return false;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_PushParserFinish(cJSON_PushParser *parser)
+{
+    cJSON *document = NULL;
+
+    if (parser == NULL)
     {
-        cJSON_Delete(item);
+        return NULL;
     }
 
-    if (value != NULL)
+    /* a number or literal at the very end of the input has nothing after it to end it */
+    if ((parser->state != push_failed) && (parser->token_type == push_token_bare))
     {
-        error local_error;
-        local_error.json = (const unsigned char*)value;
-        local_error.position = 0;
-
-        if (buffer.offset < buffer.length)
+        if (push_complete_token(parser, push_token_bare, parser->token, parser->token_length))
         {
-            local_error.position = buffer.offset;
+            parser->token_type = push_token_none;
         }
-        else if (buffer.length > 0)
-        {
-            local_error.position = buffer.length - 1;
-        }
-
-        if (return_parse_end != NULL)
+        else
         {
-            *return_parse_end = (const char*)local_error.json + local_error.position;
+            parser->state = push_failed;
         }
-
-        global_error = local_error;
     }
 
-    return NULL;
-}
+    if ((parser->state == push_done) && (parser->token_type == push_token_none))
+    {
+        document = parser->root;
+        parser->root = NULL;
+    }
 
-/* Default options for cJSON_Parse */
-CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value)
-{
-    return cJSON_ParseWithOpts(value, 0, 0);
-}
+    cJSON_PushParserReset(parser);
 
-CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_length)
-{
-    return cJSON_ParseWithLengthOpts(value, buffer_length, 0, 0);
+    return document;
 }
 
 #define cjson_min(a, b) (((a) < (b)) ? (a) : (b))
@@ -1198,6 +5189,7 @@ static unsigned char *print(const cJSON * const item, cJSON_bool format, const i
     memset(buffer, 0, sizeof(buffer));
 
     /* create buffer */
+    profile_at(cJSON_SitePrint);
     buffer->buffer = (unsigned char*) hooks->allocate(default_buffer_size);
     buffer->length = default_buffer_size;
     buffer->format = format;
@@ -1225,6 +5217,7 @@ static unsigned char *print(const cJSON * const item, cJSON_bool format, const i
     }
     else /* otherwise copy the JSON over to a new buffer */
     {
+        profile_at(cJSON_SitePrint);
         printed = (unsigned char*) hooks->allocate(buffer->offset + 1);
         if (printed == NULL)
         {
@@ -1266,13 +5259,14 @@ CJSON_PUBLIC(char *) cJSON_PrintUnformatted(const cJSON *item)
 
 CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON_bool fmt)
 {
-    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0 };
 
     if (prebuffer < 0)
     {
         return NULL;
     }
 
+    profile_at(cJSON_SitePrint);
     p.buffer = (unsigned char*)global_hooks.allocate((size_t)prebuffer);
     if (!p.buffer)
     {
@@ -1296,7 +5290,7 @@ CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON
 
 CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format)
 {
-    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0 };
 
     if ((length < 0) || (buffer == NULL))
     {
@@ -1310,36 +5304,359 @@ CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buffer, cons
     p.format = format;
     p.hooks = global_hooks;
 
-    return print_value(item, &p);
+    return print_value(item, &p);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_PrintToSink(const cJSON *item, cJSON_bool format, char *buffer, size_t buffer_size, cJSON_PrintSink sink, void *context)
+{
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0 };
+
+    if ((item == NULL) || (buffer == NULL) || (buffer_size < CJSON_PRINT_SINK_MIN_SIZE) || (buffer_size > INT_MAX) || (sink == NULL))
+    {
+        return false;
+    }
+
+    p.buffer = (unsigned char*)buffer;
+    p.length = buffer_size;
+    p.offset = 0;
+    p.noalloc = true;
+    p.format = format;
+    p.hooks = global_hooks;
+    p.sink = sink;
+    p.sink_context = context;
+
+    if (!print_value(item, &p))
+    {
+        return false;
+    }
+    update_offset(&p);
+
+    /* hand over whatever is left */
+    return flush_print_buffer(&p);
+}
+
+static cJSON_bool count_printed(const char *chunk, size_t length, void *context)
+{
+    (void)chunk;
+    *(size_t*)context += length;
+
+    return true;
+}
+
+CJSON_PUBLIC(size_t) cJSON_PrintedLength(const cJSON *item, cJSON_bool format)
+{
+    char buffer[128];
+    size_t length = 0;
+
+    if (!cJSON_PrintToSink(item, format, buffer, sizeof(buffer), count_printed, &length))
+    {
+        return 0;
+    }
+
+    return length;
+}
+
+CJSON_PUBLIC(void) cJSON_WriterInit(cJSON_Writer *writer, char *buffer, size_t size)
+{
+    if (writer == NULL)
+    {
+        return;
+    }
+
+    writer->buffer = buffer;
+    writer->size = size;
+    writer->length = 0;
+    writer->objects = 0;
+    writer->depth = 0;
+    writer->need_comma = false;
+    writer->need_value = false;
+    writer->failed = (buffer == NULL) || (size == 0);
+    if (!writer->failed)
+    {
+        buffer[0] = '\0';
+    }
+}
+
+/* append length bytes, keeping room for the terminator */
+static cJSON_bool writer_append(cJSON_Writer * const writer, const char *bytes, size_t length)
+{
+    if ((writer->size - writer->length) <= length)
+    {
+        writer->failed = true;
+        return false;
+    }
+
+    memcpy(writer->buffer + writer->length, bytes, length);
+    writer->length += length;
+    writer->buffer[writer->length] = '\0';
+
+    return true;
+}
+
+static cJSON_bool writer_in_object(const cJSON_Writer * const writer)
+{
+    return (writer->depth > 0) && ((writer->objects >> (writer->depth - 1)) & 1);
+}
+
+/* check that a value may follow and separate it from the previous one */
+static cJSON_bool writer_begin_value(cJSON_Writer * const writer)
+{
+    if ((writer == NULL) || writer->failed)
+    {
+        return false;
+    }
+
+    if (writer_in_object(writer) ? !writer->need_value : ((writer->depth == 0) && writer->need_comma))
+    {
+        /* a member without a key or a second root */
+        writer->failed = true;
+        return false;
+    }
+    if (writer->need_comma && !writer->need_value && !writer_append(writer, ",", 1))
+    {
+        return false;
+    }
+    writer->need_value = false;
+    writer->need_comma = true;
+
+    return true;
+}
+
+static cJSON_bool writer_value(cJSON_Writer * const writer, const char *text, size_t length)
+{
+    return writer_begin_value(writer) && writer_append(writer, text, length);
+}
+
+static cJSON_bool writer_open(cJSON_Writer * const writer, const cJSON_bool object)
+{
+    if (!writer_begin_value(writer))
+    {
+        return false;
+    }
+    if (writer->depth >= CJSON_WRITER_DEPTH)
+    {
+        writer->failed = true;
+        return false;
+    }
+
+    if (object)
+    {
+        writer->objects |= 1UL << writer->depth;
+    }
+    else
+    {
+        writer->objects &= ~(1UL << writer->depth);
+    }
+    writer->depth++;
+    writer->need_comma = false;
+
+    return writer_append(writer, object ? "{" : "[", 1);
+}
+
+static cJSON_bool writer_close(cJSON_Writer * const writer, const cJSON_bool object)
+{
+    if ((writer == NULL) || writer->failed)
+    {
+        return false;
+    }
+    if ((writer->depth == 0) || (writer_in_object(writer) != object) || writer->need_value)
+    {
+        writer->failed = true;
+        return false;
+    }
+
+    writer->depth--;
+    writer->need_comma = true;
+
+    return writer_append(writer, object ? "}" : "]", 1);
+}
+
+/* write string between quotes, escaped like print_string_ptr does */
+static cJSON_bool writer_string(cJSON_Writer * const writer, const char * const string)
+{
+    const unsigned char *input_pointer = (const unsigned char*)string;
+    const unsigned char *input_end = NULL;
+    unsigned char sequence[7];
+
+    if (string == NULL)
+    {
+        writer->failed = true;
+        return false;
+    }
+    input_end = input_pointer + strlen(string);
+
+    if (!writer_append(writer, "\"", 1))
+    {
+        return false;
+    }
+    for (;;)
+    {
+        const unsigned char *run_start = input_pointer;
+        input_pointer = scan_string(input_pointer, input_end);
+        while ((input_pointer < input_end) && (*input_pointer > 31) && (*input_pointer != '\"') && (*input_pointer != '\\'))
+        {
+            input_pointer++;
+        }
+
+        if (!writer_append(writer, (const char*)run_start, (size_t)(input_pointer - run_start)))
+        {
+            return false;
+        }
+        if (input_pointer == input_end)
+        {
+            break;
+        }
+
+        if (!writer_append(writer, (const char*)sequence, print_escape_sequence(*input_pointer, sequence)))
+        {
+            return false;
+        }
+        input_pointer++;
+    }
+
+    return writer_append(writer, "\"", 1);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteBeginObject(cJSON_Writer *writer)
+{
+    return writer_open(writer, true);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteEndObject(cJSON_Writer *writer)
+{
+    return writer_close(writer, true);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteBeginArray(cJSON_Writer *writer)
+{
+    return writer_open(writer, false);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteEndArray(cJSON_Writer *writer)
+{
+    return writer_close(writer, false);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteKey(cJSON_Writer *writer, const char *key)
+{
+    if ((writer == NULL) || writer->failed)
+    {
+        return false;
+    }
+    if (!writer_in_object(writer) || writer->need_value)
+    {
+        writer->failed = true;
+        return false;
+    }
+
+    if (writer->need_comma && !writer_append(writer, ",", 1))
+    {
+        return false;
+    }
+    writer->need_value = true;
+
+    return writer_string(writer, key) && writer_append(writer, ":", 1);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteString(cJSON_Writer *writer, const char *string)
+{
+    return writer_begin_value(writer) && writer_string(writer, string);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteInt64(cJSON_Writer *writer, int64_t number)
+{
+    unsigned char number_buffer[21];
+    int length = print_int64(number_buffer, number);
+
+    return writer_value(writer, (const char*)number_buffer, (size_t)length);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteInt64String(cJSON_Writer *writer, int64_t number)
+{
+    unsigned char number_buffer[23];
+    int length = print_int64(number_buffer + 1, number);
+
+    number_buffer[0] = '\"';
+    number_buffer[length + 1] = '\"';
+
+    return writer_value(writer, (const char*)number_buffer, (size_t)length + 2);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteNumber(cJSON_Writer *writer, double number)
+{
+    unsigned char number_buffer[26];
+    int length = 0;
+
+    /* same choices as print_number */
+    if (isnan(number) || isinf(number))
+    {
+        return writer_value(writer, "null", 4);
+    }
+    if ((number >= -9223372036854775808.0) && (number < 9223372036854775808.0) && (number == (double)(int64_t)number))
+    {
+        length = print_int64(number_buffer, (int64_t)number);
+    }
+    else
+    {
+        length = print_double(number_buffer, number);
+    }
+
+    return writer_value(writer, (const char*)number_buffer, (size_t)length);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteBool(cJSON_Writer *writer, cJSON_bool boolean)
+{
+    return boolean ? writer_value(writer, "true", 4) : writer_value(writer, "false", 5);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteNull(cJSON_Writer *writer)
+{
+    return writer_value(writer, "null", 4);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteRaw(cJSON_Writer *writer, const char *json, size_t length)
+{
+    if ((writer != NULL) && ((json == NULL) || (length == 0)))
+    {
+        writer->failed = true;
+        return false;
+    }
+
+    return writer_value(writer, json, length);
 }
 
-/* Parser core - when encountering text, process appropriately. */
-static cJSON_bool parse_value(cJSON * const item, parse_buffer * const input_buffer)
+CJSON_PUBLIC(size_t) cJSON_WriterFinish(cJSON_Writer *writer)
 {
-    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    if ((writer == NULL) || writer->failed || (writer->depth != 0) || !writer->need_comma)
     {
-        return false; /* no input */
+        return 0;
     }
 
+    return writer->length;
+}
+
+/* Parse a value that isn't an array or object. */
+static cJSON_bool parse_scalar(cJSON * const item, parse_buffer * const input_buffer)
+{
     /* parse the different types of values */
     /* null */
     if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "null", 4) == 0))
     {
-        item->type = cJSON_NULL;
+        item->type |= cJSON_NULL;
         input_buffer->offset += 4;
         return true;
     }
     /* false */
     if (can_read(input_buffer, 5) && (strncmp((const char*)buffer_at_offset(input_buffer), "false", 5) == 0))
     {
-        item->type = cJSON_False;
+        item->type |= cJSON_False;
         input_buffer->offset += 5;
         return true;
     }
     /* true */
     if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "true", 4) == 0))
     {
-        item->type = cJSON_True;
+        item->type |= cJSON_True;
         item->valueint = 1;
         input_buffer->offset += 4;
         return true;
@@ -1354,30 +5671,173 @@ static cJSON_bool parse_value(cJSON * const item, parse_buffer * const input_buf
     {
         return parse_number(item, input_buffer);
     }
-    /* array */
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '['))
+    return false;
+}
+
+/* Append a new member to container and, for objects, parse its name.
+ * Expects the opening bracket or comma at the offset and leaves the offset at the member's value. */
+static cJSON *parse_member(cJSON * const container, parse_buffer * const input_buffer)
+{
+    cJSON *new_item = parse_new_item(input_buffer);
+    cJSON_bool shared_key = false;
+
+    if (new_item == NULL)
+    {
+        return NULL; /* allocation failure */
+    }
+
+    /* attach it right away, a failed parse deletes it with the rest of the document */
+    if (container->child == NULL)
     {
-        return parse_array(item, input_buffer);
+        container->child = new_item;
     }
-    /* object */
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '{'))
+    else
     {
-        return parse_object(item, input_buffer);
+        container->child->prev->next = new_item;
+        new_item->prev = container->child->prev;
     }
+    container->child->prev = new_item;
 
-    return false;
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if ((container->type & 0xFF) != cJSON_Object)
+    {
+        return new_item;
+    }
+
+    /* parse the name of the child */
+    new_item->string = (char*)parse_key(input_buffer, &shared_key);
+    if (new_item->string == NULL)
+    {
+        return NULL; /* failed to parse name */
+    }
+    if (shared_key)
+    {
+        new_item->type |= cJSON_StringIsConst;
+    }
+    buffer_skip_whitespace(input_buffer);
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+    {
+        return NULL; /* invalid object */
+    }
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+
+    return new_item;
 }
 
-/* Render a value to text. */
-static cJSON_bool print_value(const cJSON * const item, printbuffer * const output_buffer)
+/* Parser core - when encountering text, process appropriately.
+ * Arrays and objects are walked with an explicit stack of the open containers instead of recursing.
+ * On failure, whatever was built so far stays attached to item for the caller to delete. */
+static cJSON_bool parse_value(cJSON * const item, parse_buffer * const input_buffer)
 {
-    unsigned char *output = NULL;
+    cJSON *inline_frames[CJSON_WALK_INLINE_DEPTH];
+    walk_stack stack;
+    cJSON *current_item = item;
+    cJSON *container = NULL;
+    cJSON_bool status = false;
 
-    if ((item == NULL) || (output_buffer == NULL))
+    if ((input_buffer == NULL) || (input_buffer->content == NULL))
     {
-        return false;
+        return false; /* no input */
+    }
+
+    walk_init(&stack, inline_frames, sizeof(cJSON*), &(input_buffer->hooks));
+    for (;;)
+    {
+        unsigned char opening = can_access_at_index(input_buffer, 0) ? buffer_at_offset(input_buffer)[0] : '\0';
+
+        if ((opening == '[') || (opening == '{'))
+        {
+            if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+            {
+                input_buffer->error = cJSON_ErrorDepth;
+                goto done; /* to deeply nested */
+            }
+            input_buffer->depth++;
+            current_item->type |= (opening == '[') ? cJSON_Array : cJSON_Object;
+
+            input_buffer->offset++;
+            buffer_skip_whitespace(input_buffer);
+            /* check if we skipped to the end of the buffer */
+            if (cannot_access_at_index(input_buffer, 0))
+            {
+                input_buffer->offset--;
+                goto done;
+            }
+
+            if (buffer_at_offset(input_buffer)[0] != ((opening == '[') ? ']' : '}'))
+            {
+                cJSON **frame = (cJSON**)walk_push(&stack);
+                if (frame == NULL)
+                {
+                    input_buffer->error = cJSON_ErrorMemory;
+                    goto done; /* allocation failure */
+                }
+                *frame = current_item;
+
+                /* step back to character in front of the first element */
+                input_buffer->offset--;
+                current_item = parse_member(current_item, input_buffer);
+                if (current_item == NULL)
+                {
+                    goto done;
+                }
+                continue;
+            }
+
+            /* empty array or object */
+            input_buffer->depth--;
+            input_buffer->offset++;
+        }
+        else if (!parse_scalar(current_item, input_buffer))
+        {
+            goto done;
+        }
+
+        /* current_item is complete, go on with the next member of the innermost container or close it */
+        while (stack.depth > 0)
+        {
+            container = *(cJSON**)walk_top(&stack);
+            buffer_skip_whitespace(input_buffer);
+            if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','))
+            {
+                break;
+            }
+            if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != (((container->type & 0xFF) == cJSON_Array) ? ']' : '}')))
+            {
+                goto done; /* expected end of array or object */
+            }
+
+            input_buffer->depth--;
+            input_buffer->offset++;
+            stack.depth--;
+        }
+        if (stack.depth == 0)
+        {
+            status = true;
+            goto done;
+        }
+
+        current_item = parse_member(container, input_buffer);
+        if (current_item == NULL)
+        {
+            goto done;
+        }
     }
 
+done:
+    walk_release(&stack);
+
+    return status;
+}
+
+/* Render a value that isn't an array or object to text. */
+static cJSON_bool print_scalar(const cJSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char *output = NULL;
+
     switch ((item->type) & 0xFF)
     {
         case cJSON_NULL:
@@ -1411,422 +5871,257 @@ static cJSON_bool print_value(const cJSON * const item, printbuffer * const outp
             return print_number(item, output_buffer);
 
         case cJSON_Raw:
-        {
-            size_t raw_length = 0;
             if (item->valuestring == NULL)
             {
                 return false;
             }
-
-            raw_length = strlen(item->valuestring) + sizeof("");
-            output = ensure(output_buffer, raw_length);
-            if (output == NULL)
-            {
-                return false;
-            }
-            memcpy(output, item->valuestring, raw_length);
-            return true;
-        }
+            return print_bytes(output_buffer, (const unsigned char*)item->valuestring, strlen(item->valuestring));
 
         case cJSON_String:
             return print_string(item, output_buffer);
 
-        case cJSON_Array:
-            return print_array(item, output_buffer);
-
-        case cJSON_Object:
-            return print_object(item, output_buffer);
-
         default:
             return false;
     }
 }
 
-/* Build an array from input text. */
-static cJSON_bool parse_array(cJSON * const item, parse_buffer * const input_buffer)
+/* Render the opening bracket of an array or object. */
+static cJSON_bool print_open(const cJSON * const item, printbuffer * const output_buffer)
 {
-    cJSON *head = NULL; /* head of the linked list */
-    cJSON *current_item = NULL;
-
-    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
-    {
-        return false; /* to deeply nested */
-    }
-    input_buffer->depth++;
-
-    if (buffer_at_offset(input_buffer)[0] != '[')
-    {
-        /* not an array */
-        goto fail;
-    }
-
-    input_buffer->offset++;
-    buffer_skip_whitespace(input_buffer);
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ']'))
-    {
-        /* empty array */
-        goto success;
-    }
-
-    /* check if we skipped to the end of the buffer */
-    if (cannot_access_at_index(input_buffer, 0))
-    {
-        input_buffer->offset--;
-        goto fail;
-    }
+    unsigned char *output_pointer = NULL;
+    size_t length = 0;
 
-    /* step back to character in front of the first element */
-    input_buffer->offset--;
-    /* loop through the comma separated array elements */
-    do
+    if ((item->type & 0xFF) == cJSON_Array)
     {
-        /* allocate next item */
-        cJSON *new_item = cJSON_New_Item(&(input_buffer->hooks));
-        if (new_item == NULL)
+        output_pointer = ensure(output_buffer, 1);
+        if (output_pointer == NULL)
         {
-            goto fail; /* allocation failure */
+            return false;
         }
 
-        /* attach next item to list */
-        if (head == NULL)
-        {
-            /* start the linked list */
-            current_item = head = new_item;
-        }
-        else
-        {
-            /* add to the end and advance */
-            current_item->next = new_item;
-            new_item->prev = current_item;
-            current_item = new_item;
-        }
+        *output_pointer = '[';
+        output_buffer->offset++;
+        output_buffer->depth++;
 
-        /* parse next value */
-        input_buffer->offset++;
-        buffer_skip_whitespace(input_buffer);
-        if (!parse_value(current_item, input_buffer))
-        {
-            goto fail; /* failed to parse value */
-        }
-        buffer_skip_whitespace(input_buffer);
+        return true;
     }
-    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
 
-    if (cannot_access_at_index(input_buffer, 0) || buffer_at_offset(input_buffer)[0] != ']')
+    length = (size_t) (output_buffer->format ? 2 : 1); /* fmt: {\n */
+    output_pointer = ensure(output_buffer, length + 1);
+    if (output_pointer == NULL)
     {
-        goto fail; /* expected end of array */
-    }
-
-success:
-    input_buffer->depth--;
-
-    if (head != NULL) {
-        head->prev = current_item;
+        return false;
     }
 
-    item->type = cJSON_Array;
-    item->child = head;
-
-    input_buffer->offset++;
-
-    return true;
-
-fail:
-    if (head != NULL)
+    *output_pointer++ = '{';
+    output_buffer->depth++;
+    if (output_buffer->format)
     {
-        cJSON_Delete(head);
+        *output_pointer++ = '\n';
     }
+    output_buffer->offset += length;
 
-    return false;
+    return true;
 }
 
-/* Render an array to text */
-static cJSON_bool print_array(const cJSON * const item, printbuffer * const output_buffer)
+/* Render the closing bracket of an array or object. */
+static cJSON_bool print_close(const cJSON * const item, printbuffer * const output_buffer)
 {
     unsigned char *output_pointer = NULL;
-    size_t length = 0;
-    cJSON *current_element = item->child;
-
-    if (output_buffer == NULL)
-    {
-        return false;
-    }
+    const cJSON_bool object = ((item->type & 0xFF) == cJSON_Object);
 
-    /* Compose the output array. */
-    /* opening square bracket */
-    output_pointer = ensure(output_buffer, 1);
-    if (output_pointer == NULL)
+    if (object && output_buffer->format && !print_indentation(output_buffer, output_buffer->depth - 1))
     {
         return false;
     }
-
-    *output_pointer = '[';
-    output_buffer->offset++;
-    output_buffer->depth++;
-
-    while (current_element != NULL)
-    {
-        if (!print_value(current_element, output_buffer))
-        {
-            return false;
-        }
-        update_offset(output_buffer);
-        if (current_element->next)
-        {
-            length = (size_t) (output_buffer->format ? 2 : 1);
-            output_pointer = ensure(output_buffer, length + 1);
-            if (output_pointer == NULL)
-            {
-                return false;
-            }
-            *output_pointer++ = ',';
-            if(output_buffer->format)
-            {
-                *output_pointer++ = ' ';
-            }
-            *output_pointer = '\0';
-            output_buffer->offset += length;
-        }
-        current_element = current_element->next;
-    }
-
     output_pointer = ensure(output_buffer, 2);
     if (output_pointer == NULL)
     {
         return false;
     }
-    *output_pointer++ = ']';
+    *output_pointer++ = object ? '}' : ']';
     *output_pointer = '\0';
     output_buffer->depth--;
 
     return true;
 }
 
-/* Build an object from the text. */
-static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_buffer)
+/* Render what comes before the value of a member: the indentation and key of object members. */
+static cJSON_bool print_member_start(const cJSON * const container, const cJSON * const member, printbuffer * const output_buffer)
 {
-    cJSON *head = NULL; /* linked list head */
-    cJSON *current_item = NULL;
-
-    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
-    {
-        return false; /* to deeply nested */
-    }
-    input_buffer->depth++;
-
-    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '{'))
-    {
-        goto fail; /* not an object */
-    }
-
-    input_buffer->offset++;
-    buffer_skip_whitespace(input_buffer);
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '}'))
-    {
-        goto success; /* empty object */
-    }
+    unsigned char *output_pointer = NULL;
+    size_t length = 0;
 
-    /* check if we skipped to the end of the buffer */
-    if (cannot_access_at_index(input_buffer, 0))
+    if ((container->type & 0xFF) != cJSON_Object)
     {
-        input_buffer->offset--;
-        goto fail;
+        return true;
     }
 
-    /* step back to character in front of the first element */
-    input_buffer->offset--;
-    /* loop through the comma separated array elements */
-    do
+    if (output_buffer->format && !print_indentation(output_buffer, output_buffer->depth))
     {
-        /* allocate next item */
-        cJSON *new_item = cJSON_New_Item(&(input_buffer->hooks));
-        if (new_item == NULL)
-        {
-            goto fail; /* allocation failure */
-        }
-
-        /* attach next item to list */
-        if (head == NULL)
-        {
-            /* start the linked list */
-            current_item = head = new_item;
-        }
-        else
-        {
-            /* add to the end and advance */
-            current_item->next = new_item;
-            new_item->prev = current_item;
-            current_item = new_item;
-        }
-
-        /* parse the name of the child */
-        input_buffer->offset++;
-        buffer_skip_whitespace(input_buffer);
-        if (!parse_string(current_item, input_buffer))
-        {
-            goto fail; /* failed to parse name */
-        }
-        buffer_skip_whitespace(input_buffer);
-
-        /* swap valuestring and string, because we parsed the name */
-        current_item->string = current_item->valuestring;
-        current_item->valuestring = NULL;
-
-        if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
-        {
-            goto fail; /* invalid object */
-        }
-
-        /* parse the value */
-        input_buffer->offset++;
-        buffer_skip_whitespace(input_buffer);
-        if (!parse_value(current_item, input_buffer))
-        {
-            goto fail; /* failed to parse value */
-        }
-        buffer_skip_whitespace(input_buffer);
+        return false;
     }
-    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
 
-    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '}'))
+    /* print key */
+    if (!print_string_ptr((unsigned char*)member->string, output_buffer))
     {
-        goto fail; /* expected end of object */
-    }
-
-success:
-    input_buffer->depth--;
-
-    if (head != NULL) {
-        head->prev = current_item;
-    }
-
-    item->type = cJSON_Object;
-    item->child = head;
-
-    input_buffer->offset++;
-    return true;
+        return false;
+    }
+    update_offset(output_buffer);
 
-fail:
-    if (head != NULL)
+    length = (size_t) (output_buffer->format ? 2 : 1);
+    output_pointer = ensure(output_buffer, length);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+    *output_pointer++ = ':';
+    if (output_buffer->format)
     {
-        cJSON_Delete(head);
+        *output_pointer++ = '\t';
     }
+    output_buffer->offset += length;
 
-    return false;
+    return true;
 }
 
-/* Render an object to text. */
-static cJSON_bool print_object(const cJSON * const item, printbuffer * const output_buffer)
+/* Render what follows the value of a member: the comma if it isn't the last one, and a newline in formatted objects. */
+static cJSON_bool print_member_end(const cJSON * const container, const cJSON * const member, printbuffer * const output_buffer)
 {
     unsigned char *output_pointer = NULL;
     size_t length = 0;
-    cJSON *current_item = item->child;
 
-    if (output_buffer == NULL)
+    update_offset(output_buffer);
+    if ((container->type & 0xFF) == cJSON_Array)
     {
-        return false;
+        if (member->next)
+        {
+            length = (size_t) (output_buffer->format ? 2 : 1);
+            output_pointer = ensure(output_buffer, length + 1);
+            if (output_pointer == NULL)
+            {
+                return false;
+            }
+            *output_pointer++ = ',';
+            if(output_buffer->format)
+            {
+                *output_pointer++ = ' ';
+            }
+            *output_pointer = '\0';
+            output_buffer->offset += length;
+        }
+
+        return true;
     }
 
-    /* Compose the output: */
-    length = (size_t) (output_buffer->format ? 2 : 1); /* fmt: {\n */
+    /* print comma if not last */
+    length = ((size_t)(output_buffer->format ? 1 : 0) + (size_t)(member->next ? 1 : 0));
     output_pointer = ensure(output_buffer, length + 1);
     if (output_pointer == NULL)
     {
         return false;
     }
+    if (member->next)
+    {
+        *output_pointer++ = ',';
+    }
 
-    *output_pointer++ = '{';
-    output_buffer->depth++;
     if (output_buffer->format)
     {
         *output_pointer++ = '\n';
     }
+    *output_pointer = '\0';
     output_buffer->offset += length;
 
-    while (current_item)
+    return true;
+}
+
+/* Render a value to text. Arrays and objects are walked with an explicit stack of the open containers instead of recursing. */
+static cJSON_bool print_value(const cJSON * const item, printbuffer * const output_buffer)
+{
+    const cJSON *inline_frames[CJSON_WALK_INLINE_DEPTH];
+    walk_stack stack;
+    const cJSON *current_item = item;
+    const cJSON *container = NULL;
+    cJSON_bool status = false;
+
+    if ((item == NULL) || (output_buffer == NULL))
+    {
+        return false;
+    }
+
+    walk_init(&stack, (void*)inline_frames, sizeof(cJSON*), &(output_buffer->hooks));
+    for (;;)
     {
-        if (output_buffer->format)
+        if (((current_item->type & 0xFF) == cJSON_Array) || ((current_item->type & 0xFF) == cJSON_Object))
         {
-            size_t i;
-            output_pointer = ensure(output_buffer, output_buffer->depth);
-            if (output_pointer == NULL)
+            if (!print_open(current_item, output_buffer))
             {
-                return false;
+                goto done;
             }
-            for (i = 0; i < output_buffer->depth; i++)
+            if (current_item->child != NULL)
             {
-                *output_pointer++ = '\t';
-            }
-            output_buffer->offset += output_buffer->depth;
-        }
-
-        /* print key */
-        if (!print_string_ptr((unsigned char*)current_item->string, output_buffer))
-        {
-            return false;
-        }
-        update_offset(output_buffer);
+                const cJSON **frame = (const cJSON**)walk_push(&stack);
+                if (frame == NULL)
+                {
+                    goto done;
+                }
+                *frame = current_item;
 
-        length = (size_t) (output_buffer->format ? 2 : 1);
-        output_pointer = ensure(output_buffer, length);
-        if (output_pointer == NULL)
-        {
-            return false;
+                current_item = current_item->child;
+                if (!print_member_start(*frame, current_item, output_buffer))
+                {
+                    goto done;
+                }
+                continue;
+            }
+            if (!print_close(current_item, output_buffer))
+            {
+                goto done;
+            }
         }
-        *output_pointer++ = ':';
-        if (output_buffer->format)
+        else if (!print_scalar(current_item, output_buffer))
         {
-            *output_pointer++ = '\t';
+            goto done;
         }
-        output_buffer->offset += length;
 
-        /* print value */
-        if (!print_value(current_item, output_buffer))
+        /* current_item is done, go on with its next sibling or close the innermost container */
+        while (stack.depth > 0)
         {
-            return false;
-        }
-        update_offset(output_buffer);
+            container = *(const cJSON**)walk_top(&stack);
+            if (!print_member_end(container, current_item, output_buffer))
+            {
+                goto done;
+            }
+            if (current_item->next != NULL)
+            {
+                break;
+            }
 
-        /* print comma if not last */
-        length = ((size_t)(output_buffer->format ? 1 : 0) + (size_t)(current_item->next ? 1 : 0));
-        output_pointer = ensure(output_buffer, length + 1);
-        if (output_pointer == NULL)
-        {
-            return false;
-        }
-        if (current_item->next)
-        {
-            *output_pointer++ = ',';
+            stack.depth--;
+            if (!print_close(container, output_buffer))
+            {
+                goto done;
+            }
+            current_item = container;
         }
-
-        if (output_buffer->format)
+        if (stack.depth == 0)
         {
-            *output_pointer++ = '\n';
+            status = true;
+            goto done;
         }
-        *output_pointer = '\0';
-        output_buffer->offset += length;
 
         current_item = current_item->next;
-    }
-
-    output_pointer = ensure(output_buffer, output_buffer->format ? (output_buffer->depth + 1) : 2);
-    if (output_pointer == NULL)
-    {
-        return false;
-    }
-    if (output_buffer->format)
-    {
-        size_t i;
-        for (i = 0; i < (output_buffer->depth - 1); i++)
+        if (!print_member_start(container, current_item, output_buffer))
         {
-            *output_pointer++ = '\t';
+            goto done;
         }
     }
-    *output_pointer++ = '}';
-    *output_pointer = '\0';
-    output_buffer->depth--;
 
-    return true;
+done:
+    walk_release(&stack);
+
+    return status;
 }
 
 /* Get Array size/item / object item. */
@@ -1882,6 +6177,139 @@ CJSON_PUBLIC(cJSON *) cJSON_GetArrayItem(const cJSON *array, int index)
     return get_array_item(array, (size_t)index);
 }
 
+/* FNV-1a hash of a key */
+static unsigned long hash_key(const unsigned char *key)
+{
+    unsigned long hash = 2166136261UL;
+
+    for (; *key != '\0'; key++)
+    {
+        hash ^= *key;
+        hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+    }
+
+    return hash;
+}
+
+/* Build the lookup index of an object, it is kept in the keyindex of the object
+ * and dropped by object_index_invalidate whenever the members change. Only
+ * cJSON_IndexObject builds one, so lookups never write to the object. */
+static object_index *object_index_build(cJSON * const object)
+{
+    object_index *index = NULL;
+    cJSON *current_element = NULL;
+    size_t count = 0;
+    size_t capacity = 1;
+    size_t i = 0;
+
+    for (current_element = object->child; current_element != NULL; current_element = current_element->next)
+    {
+        if (current_element->string == NULL)
+        {
+            /* the linear search stops at nameless members, keep its behaviour */
+            return NULL;
+        }
+        count++;
+    }
+
+    if (count < CJSON_OBJECT_INDEX_THRESHOLD)
+    {
+        return NULL;
+    }
+
+    /* keep the table at most half full */
+    while (capacity < (count * 2))
+    {
+        capacity *= 2;
+    }
+
+    profile_at(cJSON_SiteIndex);
+    index = (object_index*)global_hooks.allocate(sizeof(object_index) + (capacity * sizeof(object_index_slot)));
+    if (index == NULL)
+    {
+        return NULL;
+    }
+    index->mask = capacity - 1;
+    index->slots = (object_index_slot*)(void*)(index + 1);
+    memset(index->slots, '\0', capacity * sizeof(object_index_slot));
+
+    for (current_element = object->child; current_element != NULL; current_element = current_element->next)
+    {
+        unsigned long hash = hash_key((const unsigned char*)current_element->string);
+
+        for (i = hash & index->mask; index->slots[i].item != NULL; i = (i + 1) & index->mask)
+        {
+            if ((index->slots[i].hash == hash) && (strcmp(index->slots[i].item->string, current_element->string) == 0))
+            {
+                break; /* duplicate name, the first one wins like in the linear search */
+            }
+        }
+        if (index->slots[i].item == NULL)
+        {
+            index->slots[i].hash = hash;
+            index->slots[i].item = current_element;
+        }
+    }
+
+    object->keyindex = index;
+
+    return index;
+}
+
+static void object_index_invalidate(cJSON * const object)
+{
+    if ((object != NULL) && (object->keyindex != NULL))
+    {
+        global_hooks.deallocate(object->keyindex);
+        object->keyindex = NULL;
+    }
+}
+
+static cJSON *object_index_find_hashed(const object_index * const index, const char * const name, const unsigned long hash)
+{
+    size_t i = 0;
+
+    for (i = hash & index->mask; index->slots[i].item != NULL; i = (i + 1) & index->mask)
+    {
+        if ((index->slots[i].item->string == name)
+            || ((index->slots[i].hash == hash) && (strcmp(name, index->slots[i].item->string) == 0)))
+        {
+            return index->slots[i].item;
+        }
+    }
+
+    return NULL;
+}
+
+static cJSON *object_index_find(const object_index * const index, const char * const name)
+{
+    return object_index_find_hashed(index, name, hash_key((const unsigned char*)name));
+}
+
+/* The index a lookup on object can use. A reference shares its members with the object it
+ * refers to, and changes made through that object only drop that object's index, so a
+ * reference never has one of its own. */
+static const object_index *object_index_of(const cJSON * const object)
+{
+    if ((CJSON_OBJECT_INDEX_THRESHOLD == 0) || (object->type & cJSON_IsReference))
+    {
+        return NULL;
+    }
+
+    return (const object_index*)object->keyindex;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IndexObject(cJSON *object)
+{
+    if ((object == NULL) || ((object->type & 0xFF) != cJSON_Object) || (object->type & cJSON_IsReference)
+        || (CJSON_OBJECT_INDEX_THRESHOLD == 0))
+    {
+        return false;
+    }
+
+    return (object->keyindex != NULL) || (object_index_build(object) != NULL);
+}
+
 static cJSON *get_object_item(const cJSON * const object, const char * const name, const cJSON_bool case_sensitive)
 {
     cJSON *current_element = NULL;
@@ -1891,10 +6319,21 @@ static cJSON *get_object_item(const cJSON * const object, const char * const nam
         return NULL;
     }
 
+    if (case_sensitive && ((object->type & 0xFF) == cJSON_Object))
+    {
+        const object_index *index = object_index_of(object);
+        if (index != NULL)
+        {
+            return object_index_find(index, name);
+        }
+    }
+
     current_element = object->child;
     if (case_sensitive)
     {
-        while ((current_element != NULL) && (current_element->string != NULL) && (strcmp(name, current_element->string) != 0))
+        /* interned keys usually match by address */
+        while ((current_element != NULL) && (current_element->string != NULL)
+            && (current_element->string != name) && (strcmp(name, current_element->string) != 0))
         {
             current_element = current_element->next;
         }
@@ -1924,9 +6363,170 @@ CJSON_PUBLIC(cJSON *) cJSON_GetObjectItemCaseSensitive(const cJSON * const objec
     return get_object_item(object, string, true);
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_HasObjectItem(const cJSON *object, const char *string)
-{
-    return cJSON_GetObjectItem(object, string) ? 1 : 0;
+CJSON_PUBLIC(cJSON_bool) cJSON_HasObjectItem(const cJSON *object, const char *string)
+{
+    return cJSON_GetObjectItem(object, string) ? 1 : 0;
+}
+
+/* Append the key between start and end to query, unescaping "~0" and "~1" for JSON Pointers. */
+static cJSON_bool query_add_step(cJSON_Query * const query, const char *start, const char * const end, const cJSON_bool pointer)
+{
+    cJSON_QueryStep *step = NULL;
+    char *key = NULL;
+    size_t used = 0;
+    size_t length = 0;
+    size_t i = 0;
+
+    if (query->step_count >= CJSON_QUERY_MAX_STEPS)
+    {
+        return false;
+    }
+    step = &query->steps[query->step_count];
+    if (query->step_count > 0)
+    {
+        const cJSON_QueryStep * const previous = &query->steps[query->step_count - 1];
+        used = previous->key + strlen(query->keys + previous->key) + 1;
+    }
+    key = query->keys + used;
+
+    for (; start < end; start++)
+    {
+        char character = *start;
+        if (pointer && (character == '~'))
+        {
+            if (((start + 1) == end) || ((start[1] != '0') && (start[1] != '1')))
+            {
+                return false; /* invalid escape */
+            }
+            start++;
+            character = (*start == '0') ? '~' : '/';
+        }
+        if ((used + length + 1) >= CJSON_QUERY_KEY_BYTES)
+        {
+            return false;
+        }
+        key[length++] = character;
+    }
+    key[length] = '\0';
+
+    step->key = used;
+    step->hash = hash_key((const unsigned char*)key);
+    step->interned = NULL;
+#if CJSON_INTERN_LIMIT > 0
+    if (intern.enabled)
+    {
+        step->interned = intern_find((const unsigned char*)key, length);
+    }
+#endif
+
+    /* "0" or digits without a leading zero */
+    step->index = -1;
+    if ((length > 0) && ((key[0] != '0') || (length == 1)))
+    {
+        int index = 0;
+        for (i = 0; (i < length) && (key[i] >= '0') && (key[i] <= '9') && (index <= ((INT_MAX - 9) / 10)); i++)
+        {
+            index = (index * 10) + (key[i] - '0');
+        }
+        if (i == length)
+        {
+            step->index = index;
+        }
+    }
+
+    query->step_count++;
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_CompileQuery(cJSON_Query *query, const char *path)
+{
+    const char *segment = NULL;
+    char separator = '.';
+
+    if ((query == NULL) || (path == NULL))
+    {
+        return false;
+    }
+    query->step_count = 0;
+
+    if (*path == '\0')
+    {
+        return true; /* the root itself */
+    }
+    if (*path == '/')
+    {
+        separator = '/';
+        path++;
+    }
+
+    for (;;)
+    {
+        for (segment = path; (*path != '\0') && (*path != separator); path++)
+        {
+            /* find the end of the key */
+        }
+        /* empty keys are only allowed in pointers */
+        if (((segment == path) && (separator == '.')) || !query_add_step(query, segment, path, separator == '/'))
+        {
+            query->step_count = 0;
+            return false;
+        }
+        if (*path == '\0')
+        {
+            return true;
+        }
+        path++;
+    }
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_GetQueryItem(const cJSON *root, const cJSON_Query *query)
+{
+    const cJSON *current = root;
+    size_t i = 0;
+
+    if ((root == NULL) || (query == NULL))
+    {
+        return NULL;
+    }
+
+    for (i = 0; (i < query->step_count) && (current != NULL); i++)
+    {
+        const cJSON_QueryStep * const step = &query->steps[i];
+        const char * const name = (step->interned != NULL) ? step->interned : (query->keys + step->key);
+        const object_index *index = NULL;
+
+        if ((current->type & 0xFF) == cJSON_Array)
+        {
+            current = (step->index >= 0) ? get_array_item(current, (size_t)step->index) : NULL;
+            continue;
+        }
+        if ((current->type & 0xFF) != cJSON_Object)
+        {
+            return NULL;
+        }
+
+        index = object_index_of(current);
+        if (index != NULL)
+        {
+            current = object_index_find_hashed(index, name, step->hash);
+            continue;
+        }
+
+        /* small objects are searched like get_object_item does, the first byte rules out most keys without a call */
+        current = current->child;
+        while ((current != NULL) && (current->string != NULL) && (current->string != name)
+            && ((current->string[0] != name[0]) || (strcmp(name, current->string) != 0)))
+        {
+            current = current->next;
+        }
+        if ((current != NULL) && (current->string == NULL))
+        {
+            current = NULL;
+        }
+    }
+
+    return (cJSON*)cast_away_const(current);
 }
 
 /* Utility for array list handling. */
@@ -1953,7 +6553,9 @@ static cJSON *create_reference(const cJSON *item, const internal_hooks * const h
 
     memcpy(reference, item, sizeof(cJSON));
     reference->string = NULL;
+    reference->type &= ~(cJSON_IsArena | cJSON_IsArenaRoot | cJSON_ArenaKeyIsHeap);
     reference->type |= cJSON_IsReference;
+    reference->keyindex = NULL; /* the lookup index belongs to the referenced object */
     reference->next = reference->prev = NULL;
     return reference;
 }
@@ -1967,6 +6569,7 @@ static cJSON_bool add_item_to_array(cJSON *array, cJSON *item)
         return false;
     }
 
+    object_index_invalidate(array);
     child = array->child;
     /*
      * To find the last item in array quickly, we use prev in array
@@ -1997,22 +6600,6 @@ CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToArray(cJSON *array, cJSON *item)
     return add_item_to_array(array, item);
 }
 
-#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
-    #pragma GCC diagnostic push
-#endif
-#ifdef __GNUC__
-#pragma GCC diagnostic ignored "-Wcast-qual"
-#endif
-/* helper function to cast away const */
-static void* cast_away_const(const void* string)
-{
-    return (void*)string;
-}
-#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
-    #pragma GCC diagnostic pop
-#endif
-
-
 static cJSON_bool add_item_to_object(cJSON * const object, const char * const string, cJSON * const item, const internal_hooks * const hooks, const cJSON_bool constant_key)
 {
     char *new_key = NULL;
@@ -2026,7 +6613,7 @@ static cJSON_bool add_item_to_object(cJSON * const object, const char * const st
     if (constant_key)
     {
         new_key = (char*)cast_away_const(string);
-        new_type = item->type | cJSON_StringIsConst;
+        new_type = (item->type | cJSON_StringIsConst) & ~cJSON_ArenaKeyIsHeap;
     }
     else
     {
@@ -2037,9 +6624,14 @@ static cJSON_bool add_item_to_object(cJSON * const object, const char * const st
         }
 
         new_type = item->type & ~cJSON_StringIsConst;
+        if (item->type & cJSON_IsArena)
+        {
+            /* the arena can't grow from here, so the key is on the heap */
+            new_type |= cJSON_ArenaKeyIsHeap;
+        }
     }
 
-    if (!(item->type & cJSON_StringIsConst) && (item->string != NULL))
+    if (owns_key(item))
     {
         hooks->deallocate(item->string);
     }
@@ -2196,6 +6788,7 @@ CJSON_PUBLIC(cJSON *) cJSON_DetachItemViaPointer(cJSON *parent, cJSON * const it
         return NULL;
     }
 
+    object_index_invalidate(parent);
     if (item != parent->child)
     {
         /* not the first element */
@@ -2285,6 +6878,8 @@ CJSON_PUBLIC(cJSON_bool) cJSON_InsertItemInArray(cJSON *array, int which, cJSON
         return false;
     }
 
+    object_index_invalidate(array);
+
     newitem->next = after_inserted;
     newitem->prev = after_inserted->prev;
     after_inserted->prev = newitem;
@@ -2311,6 +6906,7 @@ CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemViaPointer(cJSON * const parent, cJSON
         return true;
     }
 
+    object_index_invalidate(parent);
     replacement->next = item->next;
     replacement->prev = item->prev;
 
@@ -2366,7 +6962,7 @@ static cJSON_bool replace_item_in_object(cJSON *object, const char *string, cJSO
     }
 
     /* replace the name in the replacement */
-    if (!(replacement->type & cJSON_StringIsConst) && (replacement->string != NULL))
+    if (owns_key(replacement))
     {
         cJSON_free(replacement->string);
     }
@@ -2377,6 +6973,10 @@ static cJSON_bool replace_item_in_object(cJSON *object, const char *string, cJSO
     }
 
     replacement->type &= ~cJSON_StringIsConst;
+    if (replacement->type & cJSON_IsArena)
+    {
+        replacement->type |= cJSON_ArenaKeyIsHeap;
+    }
 
     return cJSON_ReplaceItemViaPointer(object, get_object_item(object, string, case_sensitive), replacement);
 }
@@ -2445,18 +7045,22 @@ CJSON_PUBLIC(cJSON *) cJSON_CreateNumber(double num)
         item->valuedouble = num;
 
         /* use saturation in case of overflow */
-        if (num >= INT_MAX)
-        {
-            item->valueint = INT_MAX;
-        }
-        else if (num <= (double)INT_MIN)
-        {
-            item->valueint = INT_MIN;
-        }
-        else
-        {
-            item->valueint = (int)num;
-        }
+        item->valueint = int_from_double(num);
+        item->valueint64 = int64_from_double(num);
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateInt64(int64_t num)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if(item)
+    {
+        item->type = cJSON_Number | cJSON_NumberIsInt64;
+        item->valueint64 = num;
+        item->valuedouble = (double)num;
+        item->valueint = int_from_int64(num);
     }
 
     return item;
@@ -2712,29 +7316,19 @@ CJSON_PUBLIC(cJSON *) cJSON_CreateStringArray(const char *const *strings, int co
     return a;
 }
 
-/* Duplication */
-CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse)
+/* Copy a single item without its members. */
+static cJSON *duplicate_item(const cJSON * const item)
 {
-    cJSON *newitem = NULL;
-    cJSON *child = NULL;
-    cJSON *next = NULL;
-    cJSON *newchild = NULL;
-
-    /* Bail on bad ptr */
-    if (!item)
-    {
-        goto fail;
-    }
-    /* Create new item */
-    newitem = cJSON_New_Item(&global_hooks);
+    cJSON *newitem = cJSON_New_Item(&global_hooks);
     if (!newitem)
     {
         goto fail;
     }
     /* Copy over all vars */
-    newitem->type = item->type & (~cJSON_IsReference);
+    newitem->type = item->type & (~(cJSON_IsReference | cJSON_IsArena | cJSON_IsArenaRoot | cJSON_ArenaKeyIsHeap));
     newitem->valueint = item->valueint;
     newitem->valuedouble = item->valuedouble;
+    newitem->valueint64 = item->valueint64;
     if (item->valuestring)
     {
         newitem->valuestring = (char*)cJSON_strdup((unsigned char*)item->valuestring, &global_hooks);
@@ -2751,47 +7345,103 @@ CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse)
             goto fail;
         }
     }
+
+    return newitem;
+
+fail:
+    if (newitem != NULL)
+    {
+        cJSON_Delete(newitem);
+    }
+
+    return NULL;
+}
+
+typedef struct
+{
+    const cJSON *item;
+    cJSON *copy;
+} duplicate_frame;
+
+/* Duplication, walking the members with an explicit stack of the containers being copied */
+CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse)
+{
+    duplicate_frame inline_frames[CJSON_WALK_INLINE_DEPTH];
+    walk_stack stack;
+    duplicate_frame *frame = NULL;
+    cJSON *newitem = NULL;
+    cJSON *copy = NULL;
+    cJSON *newchild = NULL;
+
+    /* Bail on bad ptr */
+    if (!item)
+    {
+        return NULL;
+    }
+    newitem = duplicate_item(item);
     /* If non-recursive, then we're done! */
-    if (!recurse)
+    if (!newitem || !recurse)
     {
         return newitem;
     }
-    /* Walk the ->next chain for the child. */
-    child = item->child;
-    while (child != NULL)
+
+    walk_init(&stack, inline_frames, sizeof(duplicate_frame), &global_hooks);
+    copy = newitem;
+    for (;;)
     {
-        newchild = cJSON_Duplicate(child, true); /* Duplicate (with recurse) each item in the ->next chain */
+        if (item->child != NULL)
+        {
+            frame = (duplicate_frame*)walk_push(&stack);
+            if (frame == NULL)
+            {
+                goto fail;
+            }
+            frame->item = item;
+            frame->copy = copy;
+            item = item->child;
+        }
+        else
+        {
+            /* go on with the next member, climbing out of the containers whose last member is done */
+            while ((stack.depth > 0) && (item->next == NULL))
+            {
+                item = ((duplicate_frame*)walk_top(&stack))->item;
+                stack.depth--;
+            }
+            if (stack.depth == 0)
+            {
+                break;
+            }
+            item = item->next;
+        }
+
+        newchild = duplicate_item(item);
         if (!newchild)
         {
             goto fail;
         }
-        if (next != NULL)
+        /* the copy of the container keeps its last member in child->prev */
+        copy = ((duplicate_frame*)walk_top(&stack))->copy;
+        if (copy->child == NULL)
         {
-            /* If newitem->child already set, then crosswire ->prev and ->next and move on */
-            next->next = newchild;
-            newchild->prev = next;
-            next = newchild;
+            copy->child = newchild;
         }
         else
         {
-            /* Set newitem->child and move to it */
-            newitem->child = newchild;
-            next = newchild;
+            copy->child->prev->next = newchild;
+            newchild->prev = copy->child->prev;
         }
-        child = child->next;
-    }
-    if (newitem && newitem->child)
-    {
-        newitem->child->prev = newchild;
+        copy->child->prev = newchild;
+        copy = newchild;
     }
 
+    walk_release(&stack);
+
     return newitem;
 
 fail:
-    if (newitem != NULL)
-    {
-        cJSON_Delete(newitem);
-    }
+    walk_release(&stack);
+    cJSON_Delete(newitem);
 
     return NULL;
 }
@@ -2993,7 +7643,8 @@ CJSON_PUBLIC(cJSON_bool) cJSON_IsRaw(const cJSON * const item)
     return (item->type & 0xFF) == cJSON_Raw;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON * const a, const cJSON * const b, const cJSON_bool case_sensitive)
+/* Compare two items without looking at their members. */
+static cJSON_bool compare_item(const cJSON * const a, const cJSON * const b)
 {
     if ((a == NULL) || (b == NULL) || ((a->type & 0xFF) != (b->type & 0xFF)))
     {
@@ -3029,10 +7680,12 @@ CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON * const a, const cJSON * cons
         case cJSON_False:
         case cJSON_True:
         case cJSON_NULL:
+        case cJSON_Array:
+        case cJSON_Object:
             return true;
 
         case cJSON_Number:
-            if (compare_double(a->valuedouble, b->valuedouble))
+            if (compare_double(a->valuedouble, b->valuedouble) && (a->valueint64 == b->valueint64))
             {
                 return true;
             }
@@ -3051,71 +7704,338 @@ CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON * const a, const cJSON * cons
 
             return false;
 
-        case cJSON_Array:
+        default:
+            return false;
+    }
+}
+
+typedef struct
+{
+    const cJSON *a;
+    const cJSON *b;
+    /* members to look at next */
+    const cJSON *a_element;
+    const cJSON *b_element;
+} compare_frame;
+
+/* Hand out the next pair of members of the containers in frame that have to be equal.
+ * Returns false when there are none left, with *mismatch set if a member has no counterpart. */
+static cJSON_bool compare_next_pair(compare_frame * const frame, const cJSON_bool case_sensitive, const cJSON **a_member, const cJSON **b_member, cJSON_bool * const mismatch)
+{
+    if ((frame->a->type & 0xFF) == cJSON_Array)
+    {
+        if ((frame->a_element == NULL) || (frame->b_element == NULL))
         {
-            cJSON *a_element = a->child;
-            cJSON *b_element = b->child;
+            /* one of the arrays is longer than the other */
+            *mismatch = (frame->a_element != frame->b_element);
+            return false;
+        }
+        *a_member = frame->a_element;
+        *b_member = frame->b_element;
+        frame->a_element = frame->a_element->next;
+        frame->b_element = frame->b_element->next;
+        return true;
+    }
 
-            for (; (a_element != NULL) && (b_element != NULL);)
-            {
-                if (!cJSON_Compare(a_element, b_element, case_sensitive))
-                {
-                    return false;
-                }
+    /* every member of a has to be found in b */
+    if (frame->a_element != NULL)
+    {
+        /* TODO This has O(n^2) runtime without an object index, which is horrible! */
+        *a_member = frame->a_element;
+        *b_member = get_object_item(frame->b, frame->a_element->string, case_sensitive);
+        frame->a_element = frame->a_element->next;
+        *mismatch = (*b_member == NULL);
+        return !*mismatch;
+    }
+
+    /* and every member of b in a, to prevent true comparison if a is a subset of b */
+    while (frame->b_element != NULL)
+    {
+        *b_member = frame->b_element;
+        *a_member = get_object_item(frame->a, frame->b_element->string, case_sensitive);
+        frame->b_element = frame->b_element->next;
+        if (*a_member == NULL)
+        {
+            *mismatch = true;
+            return false;
+        }
+        /* unless a lookup of its name in b finds another (earlier) member, the pair was compared above */
+        if (get_object_item(frame->b, (*b_member)->string, case_sensitive) != *b_member)
+        {
+            return true;
+        }
+    }
+
+    *mismatch = false;
+    return false;
+}
 
-                a_element = a_element->next;
-                b_element = b_element->next;
+/* Comparison, walking the members with an explicit stack of the containers being compared */
+CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON * const a, const cJSON * const b, const cJSON_bool case_sensitive)
+{
+    compare_frame inline_frames[CJSON_WALK_INLINE_DEPTH];
+    walk_stack stack;
+    compare_frame *frame = NULL;
+    const cJSON *a_member = a;
+    const cJSON *b_member = b;
+    cJSON_bool mismatch = false;
+    cJSON_bool equal = false;
+
+    walk_init(&stack, inline_frames, sizeof(compare_frame), &global_hooks);
+    for (;;)
+    {
+        if (!compare_item(a_member, b_member))
+        {
+            goto done;
+        }
+        if ((a_member != b_member) && (((a_member->type & 0xFF) == cJSON_Array) || ((a_member->type & 0xFF) == cJSON_Object)))
+        {
+            frame = (compare_frame*)walk_push(&stack);
+            if (frame == NULL)
+            {
+                goto done; /* can't tell, so not equal */
             }
+            frame->a = a_member;
+            frame->b = b_member;
+            frame->a_element = a_member->child;
+            frame->b_element = b_member->child;
+        }
 
-            /* one of the arrays is longer than the other */
-            if (a_element != b_element) {
-                return false;
+        while ((stack.depth > 0) && !compare_next_pair((compare_frame*)walk_top(&stack), case_sensitive, &a_member, &b_member, &mismatch))
+        {
+            if (mismatch)
+            {
+                goto done;
             }
+            stack.depth--;
+        }
+        if (stack.depth == 0)
+        {
+            equal = true;
+            goto done;
+        }
+    }
+
+done:
+    walk_release(&stack);
+
+    return equal;
+}
+
+/* JSON Pointer of the member being patched, it starts out in the caller's inline_text and grows into heap blocks */
+typedef struct
+{
+    char *text;
+    char *inline_text;
+    size_t length;
+    size_t size;
+} patch_path;
+
+/* Append "/key" with '~' and '/' escaped as in RFC 6901, returns false if the path can't grow */
+static cJSON_bool patch_path_append(patch_path * const path, const char *key)
+{
+    size_t needed = path->length + 2; /* '/' and the terminator */
+    const char *character = NULL;
+
+    for (character = key; *character != '\0'; character++)
+    {
+        needed += ((*character == '~') || (*character == '/')) ? 2 : 1;
+    }
+    if (needed > path->size)
+    {
+        size_t size = (needed > (path->size * 2)) ? needed : (path->size * 2);
+        char *text = (char*)global_hooks.allocate(size);
+        if (text == NULL)
+        {
+            return false;
+        }
+        memcpy(text, path->text, path->length);
+        if (path->text != path->inline_text)
+        {
+            global_hooks.deallocate(path->text);
+        }
+        path->text = text;
+        path->size = size;
+    }
+
+    path->text[path->length++] = '/';
+    for (character = key; *character != '\0'; character++)
+    {
+        if ((*character == '~') || (*character == '/'))
+        {
+            path->text[path->length++] = '~';
+            path->text[path->length++] = (*character == '~') ? '0' : '1';
+        }
+        else
+        {
+            path->text[path->length++] = *character;
+        }
+    }
+    path->text[path->length] = '\0';
+
+    return true;
+}
+
+typedef struct
+{
+    cJSON *target; /* object the members of the patch are merged into */
+    const cJSON *member; /* next member of the patch */
+    size_t path_length; /* length of the pointer to target */
+    cJSON_bool quiet; /* target is new and was reported as a whole */
+} merge_frame;
+
+/* Merge patch (RFC 7386), walking the patch objects with an explicit stack of the target objects they go into */
+CJSON_PUBLIC(cJSON_bool) cJSON_ApplyMergePatch(cJSON **target, const cJSON *patch, cJSON_PatchChanged changed, void *context)
+{
+    merge_frame inline_frames[CJSON_WALK_INLINE_DEPTH];
+    char inline_path[64];
+    walk_stack stack;
+    patch_path path;
+    merge_frame *frame = NULL;
+    const cJSON *member = NULL;
+    cJSON *object = NULL;
+    cJSON *existing = NULL;
+    cJSON *replacement = NULL;
+    cJSON_bool quiet = false;
+    cJSON_bool success = false;
+    int change = cJSON_PatchAdded;
+
+    if ((target == NULL) || (patch == NULL))
+    {
+        return false;
+    }
+
+    inline_path[0] = '\0';
+    path.text = inline_path;
+    path.inline_text = inline_path;
+    path.length = 0;
+    path.size = sizeof(inline_path);
 
+    /* anything but an object replaces the whole document, and so does an object patch of something else */
+    if (!cJSON_IsObject(patch) || !cJSON_IsObject(*target))
+    {
+        if (!cJSON_IsObject(patch) && (*target != NULL) && cJSON_Compare(*target, patch, true))
+        {
+            return true;
+        }
+        replacement = cJSON_IsObject(patch) ? cJSON_CreateObject() : cJSON_Duplicate(patch, true);
+        if (replacement == NULL)
+        {
+            return false;
+        }
+        change = (*target == NULL) ? cJSON_PatchAdded : cJSON_PatchReplaced;
+        cJSON_Delete(*target);
+        *target = replacement;
+        if (changed != NULL)
+        {
+            changed(path.text, change, context);
+        }
+        if (!cJSON_IsObject(patch))
+        {
             return true;
         }
+        quiet = true;
+    }
 
-        case cJSON_Object:
+    walk_init(&stack, inline_frames, sizeof(merge_frame), &global_hooks);
+    frame = (merge_frame*)walk_push(&stack);
+    frame->target = *target;
+    frame->member = patch->child;
+    frame->path_length = 0;
+    frame->quiet = quiet;
+    while (stack.depth > 0)
+    {
+        frame = (merge_frame*)walk_top(&stack);
+        member = frame->member;
+        if (member == NULL)
         {
-            cJSON *a_element = NULL;
-            cJSON *b_element = NULL;
-            cJSON_ArrayForEach(a_element, a)
-            {
-                /* TODO This has O(n^2) runtime, which is horrible! */
-                b_element = get_object_item(b, a_element->string, case_sensitive);
-                if (b_element == NULL)
-                {
-                    return false;
-                }
+            stack.depth--;
+            continue;
+        }
+        frame->member = member->next;
+        if (member->string == NULL)
+        {
+            continue;
+        }
+        object = frame->target;
+        quiet = frame->quiet || (changed == NULL);
+        existing = get_object_item(object, member->string, true);
+        replacement = NULL;
 
-                if (!cJSON_Compare(a_element, b_element, case_sensitive))
-                {
-                    return false;
-                }
+        if (cJSON_IsNull(member))
+        {
+            if (existing == NULL)
+            {
+                continue;
             }
-
-            /* doing this twice, once on a and b to prevent true comparison if a subset of b
-             * TODO: Do this the proper way, this is just a fix for now */
-            cJSON_ArrayForEach(b_element, b)
+            cJSON_Delete(cJSON_DetachItemViaPointer(object, existing));
+            change = cJSON_PatchRemoved;
+        }
+        else if (cJSON_IsObject(member) && cJSON_IsObject(existing))
+        {
+            /* merged member by member, only the members that change are reported */
+            replacement = existing;
+        }
+        else
+        {
+            /* an object patch goes into an empty object with its key, so its null members are dropped */
+            if (!cJSON_IsObject(member) && (existing != NULL) && cJSON_Compare(existing, member, true))
             {
-                a_element = get_object_item(a, b_element->string, case_sensitive);
-                if (a_element == NULL)
-                {
-                    return false;
-                }
-
-                if (!cJSON_Compare(b_element, a_element, case_sensitive))
-                {
-                    return false;
-                }
+                continue;
+            }
+            replacement = cJSON_IsObject(member) ? duplicate_item(member) : cJSON_Duplicate(member, true);
+            if (replacement == NULL)
+            {
+                goto done;
+            }
+            if (existing != NULL)
+            {
+                cJSON_ReplaceItemViaPointer(object, existing, replacement);
+                change = cJSON_PatchReplaced;
+            }
+            else
+            {
+                add_item_to_array(object, replacement);
+                change = cJSON_PatchAdded;
             }
+        }
 
-            return true;
+        if (!quiet)
+        {
+            path.length = frame->path_length;
+            if (!patch_path_append(&path, member->string))
+            {
+                goto done;
+            }
+            if (replacement != existing)
+            {
+                changed(path.text, change, context);
+            }
+        }
+        if (cJSON_IsObject(member))
+        {
+            quiet = quiet || (replacement != existing);
+            frame = (merge_frame*)walk_push(&stack);
+            if (frame == NULL)
+            {
+                goto done;
+            }
+            frame->target = replacement;
+            frame->member = member->child;
+            frame->path_length = path.length;
+            frame->quiet = quiet;
         }
+    }
+    success = true;
 
-        default:
-            return false;
+done:
+    walk_release(&stack);
+    if (path.text != path.inline_text)
+    {
+        global_hooks.deallocate(path.text);
     }
+
+    return success;
 }
 
 CJSON_PUBLIC(void *) cJSON_malloc(size_t size)
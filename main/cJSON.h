@@ -84,6 +84,7 @@ then using the CJSON_API_VISIBILITY flag to "export" the same symbols the way CJ
 #define CJSON_VERSION_PATCH 17
 
 #include <stddef.h>
+#include <stdint.h>
 
 /* cJSON Types: */
 #define cJSON_Invalid (0)
@@ -98,6 +99,14 @@ then using the CJSON_API_VISIBILITY flag to "export" the same symbols the way CJ
 
 #define cJSON_IsReference 256
 #define cJSON_StringIsConst 512
+/* the item, its key and its valuestring live in an arena block (see cJSON_ParseWithLengthArena) */
+#define cJSON_IsArena 1024
+/* the item is the root of an arena document, deleting it releases the whole arena */
+#define cJSON_IsArenaRoot 2048
+/* the key of an arena item was set after parsing and is on the heap, cJSON_Delete frees it */
+#define cJSON_ArenaKeyIsHeap 4096
+/* valueint64 holds the number exactly, it was parsed from an integer or set through cJSON_CreateInt64/cJSON_SetIntValue */
+#define cJSON_NumberIsInt64 8192
 
 /* The cJSON structure: */
 typedef struct cJSON
@@ -117,9 +126,14 @@ typedef struct cJSON
     int valueint;
     /* The item's number, if type==cJSON_Number */
     double valuedouble;
+    /* The item's number as an exact 64 bit integer (saturated for larger or fractional numbers), use cJSON_GetInt64Value */
+    int64_t valueint64;
 
     /* The item's name string, if this item is the child of, or is in the list of subitems of an object. */
     char *string;
+
+    /* Private key lookup index of an object (see cJSON_GetObjectItemCaseSensitive), owned by cJSON. Leave it alone. */
+    void *keyindex;
 } cJSON;
 
 typedef struct cJSON_Hooks
@@ -131,8 +145,146 @@ typedef struct cJSON_Hooks
 
 typedef int cJSON_bool;
 
+/* Slab pool behind the allocation hooks, see cJSON_InitHooksWithPool */
+typedef struct cJSON_PoolConfig
+{
+    size_t node_count; /* slots for cJSON items */
+    size_t string_count; /* slots for strings and other small blocks */
+    size_t string_size; /* bytes per string slot, including the terminator */
+    void *memory; /* cJSON_PoolMemorySize bytes owned by the caller, or NULL to take them from malloc_fn once */
+    /* optional, wrap every pool operation when items are created or deleted from several threads */
+    void (*lock)(void *context);
+    void (*unlock)(void *context);
+    void *lock_context;
+} cJSON_PoolConfig;
+
+/* Counters of one slab */
+typedef struct cJSON_PoolStats
+{
+    size_t live; /* slots in use */
+    size_t peak; /* highest live count since the pool was installed */
+    size_t total; /* allocations served by the pool */
+    size_t fallback; /* allocations that fitted a slot but found the slab empty */
+} cJSON_PoolStats;
+
+/* Field types for cJSON_DecodeObject */
+#define cJSON_FieldInt     0 /* int, saturated like valueint */
+#define cJSON_FieldInt64   1 /* int64_t */
+#define cJSON_FieldDouble  2 /* double */
+#define cJSON_FieldBool    3 /* cJSON_bool */
+#define cJSON_FieldString  4 /* char array of size bytes, always zero terminated */
+
+/* Describes where cJSON_DecodeObject stores the value of the member called name. */
+typedef struct cJSON_Field
+{
+    const char *name;
+    int type;
+    size_t offset; /* offsetof the destination in the caller's struct */
+    size_t size; /* only used by cJSON_FieldString */
+} cJSON_Field;
+
+/* Bits available in the found mask of cJSON_DecodeObject */
+#define CJSON_DECODE_MAX_FIELDS 32
+/* Member names at least this long are skipped by cJSON_DecodeObject */
+#ifndef CJSON_DECODE_NAME_LENGTH
+#define CJSON_DECODE_NAME_LENGTH 64
+#endif
+
+/* Reasons in cJSON_ParseError */
+#define cJSON_ErrorNone     0
+#define cJSON_ErrorSyntax   1 /* not valid JSON, or nothing to parse */
+#define cJSON_ErrorDepth    2 /* nested deeper than CJSON_NESTING_LIMIT */
+#define cJSON_ErrorMemory   3 /* an allocation failed */
+#define cJSON_ErrorTrailing 4 /* something other than whitespace follows the value, with require_null_terminated */
+
+/* Where and why a parse stopped, owned by the caller so parses on other threads can't overwrite it. */
+typedef struct cJSON_ParseError
+{
+    size_t position; /* offset into the input, 0 if reason is cJSON_ErrorNone */
+    int reason;
+} cJSON_ParseError;
+
+/* Steps and bytes of key text (a terminator per key included) a compiled cJSON_Query can hold */
+#ifndef CJSON_QUERY_MAX_STEPS
+#define CJSON_QUERY_MAX_STEPS 8
+#endif
+#ifndef CJSON_QUERY_KEY_BYTES
+#define CJSON_QUERY_KEY_BYTES 96
+#endif
+
+typedef struct cJSON_QueryStep
+{
+    size_t key; /* offset of the key text in keys */
+    const char *interned; /* the interned copy of the key, if there is one */
+    unsigned long hash;
+    int index; /* the key as an array index, -1 if it isn't one */
+} cJSON_QueryStep;
+
+/* A path resolved once by cJSON_CompileQuery and applied to many documents. Treat the members as private. */
+typedef struct cJSON_Query
+{
+    size_t step_count;
+    cJSON_QueryStep steps[CJSON_QUERY_MAX_STEPS];
+    char keys[CJSON_QUERY_KEY_BYTES];
+} cJSON_Query;
+
+/* Receives printed text in chunks from cJSON_PrintToSink. Return 0 to abort the print. */
+typedef cJSON_bool (*cJSON_PrintSink)(const char *chunk, size_t length, void *context);
+
+/* Smallest scratch buffer cJSON_PrintToSink accepts */
+#define CJSON_PRINT_SINK_MIN_SIZE 32
+
+/* Containers a cJSON_Writer can have open at once */
+#define CJSON_WRITER_DEPTH 32
+
+/* Writes compact JSON straight into a fixed buffer, see cJSON_WriterInit. Treat the members as private. */
+typedef struct cJSON_Writer
+{
+    char *buffer;
+    size_t size;
+    size_t length; /* bytes written, the terminator is kept after them */
+    unsigned long objects; /* bit per open container: set for objects, clear for arrays */
+    int depth;
+    cJSON_bool need_comma;
+    cJSON_bool need_value; /* a key has been written */
+    cJSON_bool failed; /* overflow or misuse, every further call is ignored */
+} cJSON_Writer;
+
+/* Allocation sites counted when cJSON.c is built with CJSON_PROFILE_ALLOCATIONS */
+#define cJSON_SiteOther  0 /* cJSON_malloc and anything not listed below */
+#define cJSON_SiteItem   1 /* cJSON items */
+#define cJSON_SiteString 2 /* keys and string values */
+#define cJSON_SiteArena  3 /* arena blocks */
+#define cJSON_SiteIndex  4 /* object hash indexes */
+#define cJSON_SitePrint  5 /* print buffers */
+#define cJSON_SitePush   6 /* push parsers, their stacks and token buffers */
+#define cJSON_SitePool   7 /* slab pool memory */
+#define cJSON_SiteTape   8 /* tapes */
+#define cJSON_SiteWalk   9 /* stacks of parse, print, duplicate and compare nested deeper than CJSON_WALK_INLINE_DEPTH */
+#define CJSON_PROFILE_SITES 10
+
+/* Requested sizes are counted in buckets of up to 16, 32, ... 1024 bytes and one for anything larger */
+#define CJSON_PROFILE_BUCKETS 8
+
+/* Counters of one allocation site */
+typedef struct cJSON_AllocationSite
+{
+    const char *name;
+    unsigned long allocations;
+    unsigned long reallocations;
+    unsigned long frees;
+    size_t bytes; /* requested in total */
+    size_t live_bytes;
+    size_t peak_live_bytes;
+    unsigned long histogram[CJSON_PROFILE_BUCKETS];
+    /* allocations made by all sites while the freed blocks were live, divide by frees for the mean lifetime */
+    unsigned long lifetime;
+} cJSON_AllocationSite;
+
 /* Limits how deeply nested arrays/objects can be before cJSON rejects to parse them.
- * This is to prevent stack overflows. */
+ * Parse, print, duplicate, compare and delete don't recurse, so this no longer bounds their stack use:
+ * they keep the first CJSON_WALK_INLINE_DEPTH (default 8) levels on the stack and take a heap block
+ * (cJSON_SiteWalk) for deeper documents. cJSON_Compare returns false if it can't get one. */
 #ifndef CJSON_NESTING_LIMIT
 #define CJSON_NESTING_LIMIT 1000
 #endif
@@ -142,6 +294,30 @@ CJSON_PUBLIC(const char*) cJSON_Version(void);
 
 /* Supply malloc, realloc and free functions to cJSON */
 CJSON_PUBLIC(void) cJSON_InitHooks(cJSON_Hooks* hooks);
+/* Like cJSON_InitHooks, but items and allocations of up to string_size bytes are taken from fixed size slabs first.
+ * hooks (NULL for malloc/free) serve everything else and a slab that runs empty. Install it before creating
+ * any items and only replace it (with either function) once all of them are deleted. Returns 0 if the pool could not be set up. */
+CJSON_PUBLIC(cJSON_bool) cJSON_InitHooksWithPool(cJSON_Hooks* hooks, const cJSON_PoolConfig *config);
+/* Bytes of pool memory needed for config */
+CJSON_PUBLIC(size_t) cJSON_PoolMemorySize(const cJSON_PoolConfig *config);
+/* Copy the counters of the installed pool, either pointer may be NULL */
+CJSON_PUBLIC(void) cJSON_GetPoolStats(cJSON_PoolStats *nodes, cJSON_PoolStats *strings);
+/* Share the text of parsed object keys instead of copying it for every item. Keys found in the intern table are
+ * pointed to and flagged cJSON_StringIsConst, so lookups by the same pointer skip the compare.
+ * The count keys are added by reference and must outlive every parsed tree (literals do), up to CJSON_INTERN_LIMIT keys.
+ * Parsing only looks keys up and never adds any, so parses can run on several threads at once, but this is not
+ * thread safe itself: call it before parsing starts elsewhere.
+ * Interned keys are never released. Returns 0 if a key didn't fit, interning is on regardless. */
+CJSON_PUBLIC(cJSON_bool) cJSON_InternKeys(const char * const *keys, size_t count);
+/* Number of keys in the intern table */
+CJSON_PUBLIC(size_t) cJSON_InternedKeyCount(void);
+/* Copy the counters of up to count allocation sites, indexed by cJSON_Site*. Returns the number copied,
+ * which is 0 unless cJSON.c is built with CJSON_PROFILE_ALLOCATIONS. Reset zeroes all but the live bytes. */
+CJSON_PUBLIC(size_t) cJSON_GetAllocationProfile(cJSON_AllocationSite *sites, size_t count);
+CJSON_PUBLIC(void) cJSON_ResetAllocationProfile(void);
+/* Optional, wrap every update and copy of the counters when cJSON allocates on several threads. The lock is only
+ * held around the counters, never around the hooks. Set it before any allocation happens on a second thread. */
+CJSON_PUBLIC(void) cJSON_SetAllocationProfileLock(void (*lock)(void *context), void (*unlock)(void *context), void *context);
 
 /* Memory Management: the caller is always responsible to free the results from all variants of cJSON_Parse (with cJSON_Delete) and cJSON_Print (with stdlib free, cJSON_Hooks.free_fn, or cJSON_free as appropriate). The exception is cJSON_PrintPreallocated, where the caller has full responsibility of the buffer. */
 /* Supply a block of JSON, and this returns a cJSON object you can interrogate. */
@@ -151,6 +327,118 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_len
 /* If you supply a ptr in return_parse_end and parsing fails, then return_parse_end will contain a pointer to the error so will match cJSON_GetErrorPtr(). */
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated);
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated);
+/* Reentrant cJSON_ParseWithLengthOpts: the outcome goes to the caller's error (which may be NULL) instead of cJSON_GetErrorPtr,
+ * so nothing shared is written and parses can run on several threads at once. The other ...WithError functions are
+ * reentrant the same way; every parse without one (the tape and cursor included) writes the error cJSON_GetErrorPtr reads. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithError(const char *value, size_t buffer_length, cJSON_bool require_null_terminated, cJSON_ParseError *error);
+/* Parse into a single arena: all items, keys and strings of the document are placed in one block and released
+ * together by calling cJSON_Delete on the returned root.
+ * If arena is NULL, one block big enough for the whole document is allocated with the hooks.
+ * Otherwise the caller's block of arena_size bytes is used and a heap block is only chained on when it runs out.
+ * Items of an arena document must not be moved into other documents, and their strings can only be shortened.
+ * A key given to an arena item later (cJSON_AddItemToObject, cJSON_ReplaceItemInObject) is put on the heap and
+ * flagged cJSON_ArenaKeyIsHeap, so cJSON_Delete frees it with the document. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthArena(const char *value, size_t buffer_length, void *arena, size_t arena_size);
+/* Reentrant cJSON_ParseWithLengthArena, reporting to error like cJSON_ParseWithError. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthArenaWithError(const char *value, size_t buffer_length, void *arena, size_t arena_size, cJSON_ParseError *error);
+/* Returns an arena size that is guaranteed to hold the document parsed from value. */
+CJSON_PUBLIC(size_t) cJSON_ArenaSizeFor(const char *value, size_t buffer_length);
+/* Parse in place: strings and keys are unescaped inside value and point into it instead of being copied.
+ * value must stay valid for as long as the document is used and its contents are undefined after parsing.
+ * String values are flagged cJSON_IsReference and keys cJSON_StringIsConst, so cJSON_Delete leaves them alone.
+ * cJSON_Duplicate copies the string values but, as for any constant key, keeps pointing to the keys in value. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseInSitu(char *value, size_t buffer_length);
+/* Reentrant cJSON_ParseInSitu, reporting to error like cJSON_ParseWithError. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseInSituWithError(char *value, size_t buffer_length, cJSON_ParseError *error);
+/* Decode a flat object straight into the caller's struct in a single pass without allocating.
+ * The members named in fields are stored at their offset from destination, everything else (including nested values) is skipped.
+ * Bit i of found is set if fields[i] was stored; missing members, members of another type and repeated names leave their destination untouched.
+ * Strings longer than the field are cut short on a character boundary.
+ * Returns 0 if value isn't a valid object, in which case some fields may already have been written. */
+CJSON_PUBLIC(cJSON_bool) cJSON_DecodeObject(const char *value, size_t buffer_length, const cJSON_Field *fields, size_t field_count, void *destination, unsigned long *found);
+/* Reentrant cJSON_DecodeObject, reporting to error like cJSON_ParseWithError. */
+CJSON_PUBLIC(cJSON_bool) cJSON_DecodeObjectWithError(const char *value, size_t buffer_length, const cJSON_Field *fields, size_t field_count, void *destination, unsigned long *found, cJSON_ParseError *error);
+/* Same as cJSON_DecodeObject, but for an object that has already been parsed. Strings are copied out of the object. */
+CJSON_PUBLIC(cJSON_bool) cJSON_DecodeItem(const cJSON *object, const cJSON_Field *fields, size_t field_count, void *destination, unsigned long *found);
+/* Same as cJSON_DecodeItem, but fields[i] is read from where queries[i] leads instead of the member fields[i].name. */
+CJSON_PUBLIC(cJSON_bool) cJSON_DecodeItemWithQueries(const cJSON *root, const cJSON_Query *queries, const cJSON_Field *fields, size_t field_count, void *destination, unsigned long *found);
+
+/* Read-only tape: a document parsed into one block of 8 byte entries (tag and 32 bit offset) followed by its strings.
+ * Containers link to their end, so siblings are found without walking children. Documents are limited to 4 GiB. */
+typedef struct cJSON_Tape cJSON_Tape;
+/* A position on a tape, passed by value. Its type is cJSON_Invalid if tape is NULL (nothing found). */
+typedef struct cJSON_TapeItem
+{
+    const cJSON_Tape *tape;
+    size_t index;
+    size_t key; /* entry of the member name, 0 outside of objects */
+} cJSON_TapeItem;
+CJSON_PUBLIC(cJSON_Tape *) cJSON_ParseTape(const char *value, size_t buffer_length);
+CJSON_PUBLIC(void) cJSON_DeleteTape(cJSON_Tape *tape);
+/* Bytes held by the tape */
+CJSON_PUBLIC(size_t) cJSON_TapeMemorySize(const cJSON_Tape *tape);
+CJSON_PUBLIC(cJSON_TapeItem) cJSON_TapeRoot(const cJSON_Tape *tape);
+/* cJSON_False, cJSON_True, cJSON_NULL, cJSON_Number, cJSON_String, cJSON_Array, cJSON_Object or cJSON_Invalid */
+CJSON_PUBLIC(int) cJSON_TapeType(cJSON_TapeItem item);
+/* Iterate arrays and objects: the first element and the one after item, invalid at the end */
+CJSON_PUBLIC(cJSON_TapeItem) cJSON_TapeChild(cJSON_TapeItem item);
+CJSON_PUBLIC(cJSON_TapeItem) cJSON_TapeNext(cJSON_TapeItem item);
+/* Name of an object member, NULL otherwise */
+CJSON_PUBLIC(const char *) cJSON_TapeGetKey(cJSON_TapeItem item);
+CJSON_PUBLIC(cJSON_TapeItem) cJSON_TapeGetObjectItemCaseSensitive(cJSON_TapeItem object, const char *string);
+CJSON_PUBLIC(int) cJSON_TapeGetArraySize(cJSON_TapeItem array);
+CJSON_PUBLIC(cJSON_TapeItem) cJSON_TapeGetArrayItem(cJSON_TapeItem array, int index);
+/* Same results as cJSON_GetStringValue, cJSON_GetNumberValue and cJSON_GetInt64Value */
+CJSON_PUBLIC(const char *) cJSON_TapeGetStringValue(cJSON_TapeItem item);
+CJSON_PUBLIC(double) cJSON_TapeGetNumberValue(cJSON_TapeItem item);
+CJSON_PUBLIC(int64_t) cJSON_TapeGetInt64Value(cJSON_TapeItem item);
+
+/* On-demand reading: a cursor points into the caller's buffer, which is checked once by cJSON_CursorRoot and must stay
+ * unchanged while cursors into it are in use. Nothing is allocated, values are only read when asked for and
+ * everything passed over is skipped by scanning for brackets and quotes. Escapes in strings are checked when read. */
+typedef struct cJSON_Cursor
+{
+    const char *json; /* NULL if nothing was found */
+    size_t length;
+    size_t offset; /* first character of the value */
+    size_t key; /* opening quote of the member name, 0 outside of objects */
+    size_t depth; /* 0 for the root */
+} cJSON_Cursor;
+/* Invalid if value isn't valid JSON, see cJSON_GetErrorPtr. Anything after the first value is ignored like cJSON_ParseWithLength does. */
+CJSON_PUBLIC(cJSON_Cursor) cJSON_CursorRoot(const char *value, size_t buffer_length);
+/* cJSON_False, cJSON_True, cJSON_NULL, cJSON_Number, cJSON_String, cJSON_Array, cJSON_Object or cJSON_Invalid */
+CJSON_PUBLIC(int) cJSON_CursorType(cJSON_Cursor item);
+/* Iterate arrays and objects: the first element and the one after item, invalid at the end */
+CJSON_PUBLIC(cJSON_Cursor) cJSON_CursorChild(cJSON_Cursor item);
+CJSON_PUBLIC(cJSON_Cursor) cJSON_CursorNext(cJSON_Cursor item);
+CJSON_PUBLIC(cJSON_Cursor) cJSON_CursorGetObjectItemCaseSensitive(cJSON_Cursor object, const char *string);
+/* The first member named string from member on, without going back to the start of the object.
+ * Members read in the order they are sent are found in one pass this way. */
+CJSON_PUBLIC(cJSON_Cursor) cJSON_CursorFindCaseSensitive(cJSON_Cursor member, const char *string);
+CJSON_PUBLIC(int) cJSON_CursorGetArraySize(cJSON_Cursor array);
+CJSON_PUBLIC(cJSON_Cursor) cJSON_CursorGetArrayItem(cJSON_Cursor array, int index);
+/* Unescape the member name or string value into buffer, cut short on a character boundary if it doesn't fit.
+ * Returns buffer, or NULL if there is nothing to copy or the string is invalid. */
+CJSON_PUBLIC(const char *) cJSON_CursorGetKey(cJSON_Cursor item, char *buffer, size_t buffer_size);
+CJSON_PUBLIC(const char *) cJSON_CursorGetString(cJSON_Cursor item, char *buffer, size_t buffer_size);
+/* Same results as cJSON_GetNumberValue and cJSON_GetInt64Value */
+CJSON_PUBLIC(double) cJSON_CursorGetNumberValue(cJSON_Cursor item);
+CJSON_PUBLIC(int64_t) cJSON_CursorGetInt64Value(cJSON_Cursor item);
+/* Parse the value at item into a normal tree (without its member name). The caller owns the returned item. */
+CJSON_PUBLIC(cJSON *) cJSON_CursorToItem(cJSON_Cursor item);
+
+/* Incremental parsing: feed a document in chunks of any size as they arrive and collect it with cJSON_PushParserFinish.
+ * Only a token that is cut off at the end of a chunk is buffered, everything else is added to the document right away. */
+typedef struct cJSON_PushParser cJSON_PushParser;
+CJSON_PUBLIC(cJSON_PushParser *) cJSON_PushParserCreate(void);
+/* Returns 0 once the input can't be valid JSON anymore, further chunks are then ignored until the parser is reset. */
+CJSON_PUBLIC(cJSON_bool) cJSON_PushParserFeed(cJSON_PushParser *parser, const char *chunk, size_t length);
+/* Returns the document if the input fed so far is exactly one complete value, NULL otherwise.
+ * Either way the parser is reset and can take the next document. The caller owns the returned document. */
+CJSON_PUBLIC(cJSON *) cJSON_PushParserFinish(cJSON_PushParser *parser);
+/* Discard whatever has been fed so far. */
+CJSON_PUBLIC(void) cJSON_PushParserReset(cJSON_PushParser *parser);
+CJSON_PUBLIC(void) cJSON_PushParserDelete(cJSON_PushParser *parser);
 
 /* Render a cJSON entity to text for transfer/storage. */
 CJSON_PUBLIC(char *) cJSON_Print(const cJSON *item);
@@ -161,6 +449,33 @@ CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON
 /* Render a cJSON entity to text using a buffer already allocated in memory with given length. Returns 1 on success and 0 on failure. */
 /* NOTE: cJSON is not always 100% accurate in estimating how much memory it will use, so to be safe allocate 5 bytes more than you actually need */
 CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format);
+/* Render a cJSON entity through buffer (at least CJSON_PRINT_SINK_MIN_SIZE bytes), handing each filled chunk to sink.
+ * Nothing is allocated and the text is not zero terminated. Returns 1 on success and 0 on failure. */
+CJSON_PUBLIC(cJSON_bool) cJSON_PrintToSink(const cJSON *item, cJSON_bool format, char *buffer, size_t buffer_size, cJSON_PrintSink sink, void *context);
+/* Length of the text cJSON_Print (format=1) or cJSON_PrintUnformatted (format=0) would produce, without allocating. 0 on failure. */
+CJSON_PUBLIC(size_t) cJSON_PrintedLength(const cJSON *item, cJSON_bool format);
+/* Typed writer: builds a document without items in one pass over buffer and never allocates.
+ * Members of an object are written as a key followed by one value or container. Each call returns 0 once the text
+ * doesn't fit or doesn't nest properly, and the writer then ignores everything up to cJSON_WriterFinish. */
+CJSON_PUBLIC(void) cJSON_WriterInit(cJSON_Writer *writer, char *buffer, size_t size);
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteBeginObject(cJSON_Writer *writer);
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteEndObject(cJSON_Writer *writer);
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteBeginArray(cJSON_Writer *writer);
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteEndArray(cJSON_Writer *writer);
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteKey(cJSON_Writer *writer, const char *key);
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteString(cJSON_Writer *writer, const char *string);
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteInt64(cJSON_Writer *writer, int64_t number);
+/* The number as a string value, for peers that would lose precision reading 64 bit integers as doubles */
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteInt64String(cJSON_Writer *writer, int64_t number);
+/* Written like cJSON_Print writes numbers, NaN and infinity become null */
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteNumber(cJSON_Writer *writer, double number);
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteBool(cJSON_Writer *writer, cJSON_bool boolean);
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteNull(cJSON_Writer *writer);
+/* length bytes of json copied as they are, like cJSON_Raw items they have to be a single valid value */
+CJSON_PUBLIC(cJSON_bool) cJSON_WriteRaw(cJSON_Writer *writer, const char *json, size_t length);
+/* Length of the zero terminated document in buffer, or 0 if it overflowed, is incomplete or was misused. */
+CJSON_PUBLIC(size_t) cJSON_WriterFinish(cJSON_Writer *writer);
+
 /* Delete a cJSON entity and all subentities. */
 CJSON_PUBLIC(void) cJSON_Delete(cJSON *item);
 
@@ -170,14 +485,29 @@ CJSON_PUBLIC(int) cJSON_GetArraySize(const cJSON *array);
 CJSON_PUBLIC(cJSON *) cJSON_GetArrayItem(const cJSON *array, int index);
 /* Get item "string" from object. Case insensitive. */
 CJSON_PUBLIC(cJSON *) cJSON_GetObjectItem(const cJSON * const object, const char * const string);
+/* Case sensitive lookups use the hash index of the object if cJSON_IndexObject gave it one, and never build one,
+ * so lookups are plain reads and may run on several threads at once. */
 CJSON_PUBLIC(cJSON *) cJSON_GetObjectItemCaseSensitive(const cJSON * const object, const char * const string);
+/* Give an object with CJSON_OBJECT_INDEX_THRESHOLD or more members a hash index for case sensitive lookups and queries.
+ * It is dropped again whenever members are added, detached or replaced through the API (index the object again then).
+ * References are never indexed, since they share their members with another object. Returns whether object has an index. */
+CJSON_PUBLIC(cJSON_bool) cJSON_IndexObject(cJSON *object);
 CJSON_PUBLIC(cJSON_bool) cJSON_HasObjectItem(const cJSON *object, const char *string);
+/* Compile path into query: a JSON Pointer (RFC 6901) such as "/schedule/0/firstName", or the same as a dotted path
+ * "schedule.0.firstName". Key hashes and array indices are worked out here, and keys that are interned at this point
+ * are matched by address later. Returns 0 if path is malformed or doesn't fit the query. */
+CJSON_PUBLIC(cJSON_bool) cJSON_CompileQuery(cJSON_Query *query, const char *path);
+/* The item query leads to from root, or NULL. Object members are matched case sensitively. */
+CJSON_PUBLIC(cJSON *) cJSON_GetQueryItem(const cJSON *root, const cJSON_Query *query);
 /* For analysing failed parses. This returns a pointer to the parse error. You'll probably need to look a few chars back to make sense of it. Defined when cJSON_Parse() returns 0. 0 when cJSON_Parse() succeeds. */
+/* Every parse that reports here writes the same static, so use cJSON_ParseWithError when parsing on more than one thread. */
 CJSON_PUBLIC(const char *) cJSON_GetErrorPtr(void);
 
 /* Check item type and return its value */
 CJSON_PUBLIC(char *) cJSON_GetStringValue(const cJSON * const item);
 CJSON_PUBLIC(double) cJSON_GetNumberValue(const cJSON * const item);
+/* Integers are parsed exactly into 64 bits, unlike valueint which saturates at INT_MAX. Returns 0 for non numbers. */
+CJSON_PUBLIC(int64_t) cJSON_GetInt64Value(const cJSON * const item);
 
 /* These functions check the type of an item */
 CJSON_PUBLIC(cJSON_bool) cJSON_IsInvalid(const cJSON * const item);
@@ -197,6 +527,7 @@ CJSON_PUBLIC(cJSON *) cJSON_CreateTrue(void);
 CJSON_PUBLIC(cJSON *) cJSON_CreateFalse(void);
 CJSON_PUBLIC(cJSON *) cJSON_CreateBool(cJSON_bool boolean);
 CJSON_PUBLIC(cJSON *) cJSON_CreateNumber(double num);
+CJSON_PUBLIC(cJSON *) cJSON_CreateInt64(int64_t num);
 CJSON_PUBLIC(cJSON *) cJSON_CreateString(const char *string);
 /* raw json */
 CJSON_PUBLIC(cJSON *) cJSON_CreateRaw(const char *raw);
@@ -254,6 +585,18 @@ CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse);
  * case_sensitive determines if object keys are treated case sensitive (1) or case insensitive (0) */
 CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON * const a, const cJSON * const b, const cJSON_bool case_sensitive);
 
+/* Changes reported by cJSON_ApplyMergePatch */
+#define cJSON_PatchAdded    1
+#define cJSON_PatchReplaced 2
+#define cJSON_PatchRemoved  3
+/* Called with the JSON Pointer (RFC 6901) of a changed value and one of the changes above, "" for the whole document */
+typedef void (*cJSON_PatchChanged)(const char *path, int change, void *context);
+/* Apply a merge patch (RFC 7386) to the document in *target, in place. Members the patch leaves alone or sets to the
+ * value they already have are not touched. A value that is added or replaced as a whole is reported once, members of
+ * objects that were there before are reported one by one. *target has to be a root (or NULL) and may be swapped
+ * for a new one. changed may be NULL. Returns false if memory ran out, *target then holds the changes made so far. */
+CJSON_PUBLIC(cJSON_bool) cJSON_ApplyMergePatch(cJSON **target, const cJSON *patch, cJSON_PatchChanged changed, void *context);
+
 /* Minify a strings, remove blank characters(such as ' ', '\t', '\r', '\n') from strings.
  * The input pointer json cannot point to a read-only address area, such as a string constant, 
  * but should point to a readable and writable address area. */
@@ -271,8 +614,11 @@ CJSON_PUBLIC(cJSON*) cJSON_AddRawToObject(cJSON * const object, const char * con
 CJSON_PUBLIC(cJSON*) cJSON_AddObjectToObject(cJSON * const object, const char * const name);
 CJSON_PUBLIC(cJSON*) cJSON_AddArrayToObject(cJSON * const object, const char * const name);
 
-/* When assigning an integer value, it needs to be propagated to valuedouble too. */
-#define cJSON_SetIntValue(object, number) ((object) ? (object)->valueint = (object)->valuedouble = (number) : (number))
+/* helper for the cJSON_SetIntValue macro */
+CJSON_PUBLIC(int64_t) cJSON_SetIntHelper(cJSON *object, int64_t number);
+/* When assigning an integer value, it needs to be propagated to valuedouble too. valueint64 keeps it exactly,
+ * valueint saturates like it does for parsed numbers. */
+#define cJSON_SetIntValue(object, number) ((object != NULL) ? cJSON_SetIntHelper(object, (int64_t)(number)) : (int64_t)(number))
 /* helper for the cJSON_SetNumberValue macro */
 CJSON_PUBLIC(double) cJSON_SetNumberHelper(cJSON *object, double number);
 #define cJSON_SetNumberValue(object, number) ((object != NULL) ? cJSON_SetNumberHelper(object, (double)number) : (number))
@@ -14,7 +14,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
+#include <strings.h>
 
 /* RTOS Headers */
 #include "freertos/FreeRTOS.h"
@@ -26,6 +28,7 @@
 #include "esp_err.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "esp_random.h"
 #include "esp_http_client.h"
 
 /* Local Headers */
@@ -61,6 +64,13 @@
 
 /* Local Defines */
 #define TIMER_SZ 2 /* Size of Timer Args Array */
+#define RESP_FIELD_SZ 6 /* Size of Response Field Descriptor Array */
+#define RESP_BUF_SZ 1024 /* Largest Response Body Taken (Largest Batch Response is ~560) */
+#define RESP_ARENA_SZ 3072 /* Arena for a Batch Response Tree (28 Items and Their Strings) */
+#define BATCH_SZ (Q_CNT) /* Most Requests in One Batch POST (All xQueueHttp Holds) */
+#define BATCH_ENTRY_SZ 24 /* Bytes per Batch Entry Besides its Body ({"id":255,"body":},) */
+#define BATCH_PATH_SZ 24 /* Size of a Batch Response Field Path ("/body/" and the Name) */
+#define RETRY_SZ (Q_CNT * 2) /* Requests That Can Wait on a Retry at Once */
 #define HTTP_TOUT 250               /* Time in milliseconds*/
 #define RSV_DEF_TOUT 60000000       /* Time in microseconds*/
 #define TIME_DEF_TOUT 86400000000   //  |                  
@@ -71,8 +81,28 @@
 static void oneshotCallback(void *args);
 static void xHttpTask(void *pvParameters);
 static void startRtosHttpConfig(void);
-static bool queuingUartTxData(cJSON *ptr, bool memSafe);
+static void queuingUartTxData(const respData *respPtr);
 static esp_err_t postRespHndlr(esp_http_client_event_handle_t event);
+static void respFinishHndlr(void);
+static void respDecodeHndlr(const char *dataPtr, size_t dataLen);
+static void respDataHndlr(respData *respPtr, bool decoded);
+#ifdef CJSON_PROFILE_ALLOCATIONS
+static void jsonProfileHndlr(void);
+#endif
+static void batchSplitHndlr(const cJSON *batchPtr);
+static void condHeaderHndlr(const char *key, const char *value);
+static void condRequestHndlr(esp_http_client_handle_t client, const condValidators *condPtr);
+static void condResultHndlr(esp_http_client_handle_t client, uint8_t id);
+static postResult sendRequest(esp_http_client_handle_t client, const char *url, const char *body, size_t bodyLen);
+static bool sendBatch(esp_http_client_handle_t client, retryEntry *entryArr, uint8_t reqCnt);
+static void sendAttempt(esp_http_client_handle_t client, retryEntry *entryPtr);
+static void retryStart(retryEntry *entryPtr, requestBodyData *reqPtr);
+static void retryHndlr(retryEntry *entryPtr, postResult result);
+static bool retryBackoff(retryEntry *entryPtr, const retryPolicy *policyPtr);
+static bool retryStore(const retryEntry *entryPtr);
+static void retryDueHndlr(esp_http_client_handle_t client);
+static TickType_t retryWaitTicks(void);
+static char *batchBodyToString(const retryEntry *entryArr, uint8_t reqCnt, size_t *bodyLen);
 
 /* FreeRTOS Local API Handles */
 static SemaphoreHandle_t xSemUartTxGuard;
@@ -84,6 +114,29 @@ QueueHandle_t xQueueUartTx;
 static esp_timer_handle_t reserveRequest;
 static esp_timer_handle_t timeRequest;
 
+/* Receive Buffer for Responses Split Across Several Chunks (Only Used by xHttpTask) */
+static char respBuf[RESP_BUF_SZ];
+static size_t respLen = 0; /* Bytes of the Body Gathered so Far */
+static bool respStreamed = false; /* Body Didn't Come in One Chunk */
+static bool respOverflow = false; /* Body Won't Fit, the Rest of it is Dropped */
+static char respArena[RESP_ARENA_SZ]; /* Holds the Tree of a Batch Response */
+
+/* Batch POST State (Only Used by xHttpTask) */
+static char *batchUrl = NULL;
+static bool batchSupported = true; /* Cleared for Good Once the Server Doesn't Answer a Batch */
+static bool respBatched = false; /* Response Being Received is a Batch Response */
+static bool batchSplit = false; /* Batch Response was Split Into Its Responses */
+static uint8_t batchPending = 0; /* Bits of the Request IDs Still Waiting on a Response */
+
+/* Conditional Request State (Only Used by xHttpTask) */
+static condValidators condArr[POST_STATE_SZ]; /* Validators of the Last Response Passed On per Request ID */
+static condValidators condRecv; /* Validators of the Response Being Received */
+static bool respQueued = false; /* Response Being Received Made it Onto xQueueUartTx */
+
+/* Requests Waiting on a Retry (Only Used by xHttpTask) */
+static retryEntry retryArr[RETRY_SZ];
+static retryStats retryStatsArr[POST_STATE_SZ];
+
 /* Local Constant Logging String */
 static const char TAG[TAG_LEN_9] = "ESP_HTTP";
 
@@ -94,6 +147,37 @@ static const timerArgsStruct timerArgsArr[TIMER_SZ] =
     {RSV_ID, &reserveRequest},
 };
 
+/* Constant Array of Retry Policies (Indexed by Request ID) */
+static const retryPolicy retryPolicies[POST_STATE_SZ] =
+{
+    {"time", 1000, 15000, 60000, MAX_ATMPT}, /* Background, Only Has to Beat the Next Sync */
+    {"reserve", 1000, 15000, 30000, MAX_ATMPT}, /* Background, Only Has to Beat the Next Poll */
+    {"code", 100, 400, 2000, MAX_ATMPT}, /* Someone is Waiting at the Door */
+};
+
+/* Constant Array of Request IDs Sent as Conditional Requests (Indexed by Request ID) */
+static const bool condEnabled[POST_STATE_SZ] =
+{
+    false, /* Server Time Differs Every Time */
+    true, /* Reservation Info Rarely Changes Between Polls */
+    false, /* Every Access Code Has to be Checked */
+};
+
+/* Constant Array of Response Field Descriptors (Order Matches respFieldBits) */
+static const cJSON_Field respFields[RESP_FIELD_SZ] =
+{
+    {"id", cJSON_FieldInt, offsetof(respData, id), 0},
+    {"responseCode", cJSON_FieldInt, offsetof(respData, responseCode), 0},
+    {"serverTime", cJSON_FieldInt64, offsetof(respData, serverTime), 0},
+    {"firstName", cJSON_FieldString, offsetof(respData, firstName), NAME_LEN},
+    {"unixStartTime", cJSON_FieldInt64, offsetof(respData, unixStartTime), 0},
+    {"unixEndTime", cJSON_FieldInt64, offsetof(respData, unixEndTime), 0},
+};
+
+/* respFields[] Members Inside the "body" of a Batch Response Entry (Same Order as respFields) */
+static const char *bodyKey = "body";
+static cJSON_Query batchQueries[RESP_FIELD_SZ];
+
 
 
 /* The startHttpConfig() function configures the two oneshot timers that call
@@ -151,10 +235,17 @@ void startHttpConfig(void)
 **
 ** Return:
 **  none
+**
+** Notes: The response member names are interned, so batch responses don't
+** copy their keys into the arena. The paths to them under "body" are then
+** compiled into batchQueries[], which keeps the interned addresses and key
+** hashes so each entry of a batch response is decoded without hashing or
+** comparing any names. cJSON_InternKeys() must not run while another task
+** parses, which holds here since this runs before xHttpTask is created.
 */
 static void startRtosHttpConfig(void)
 {
-    if(!(xQueueUartTx = xQueueCreate(Q_CNT, sizeof(requestBodyData*))))
+    if(!(xQueueUartTx = xQueueCreate(Q_CNT, sizeof(respData))))
     {
         ESP_LOGW(TAG, "%s xQueueUartTx %s", heapFail, rtrnNewLine);
     }
@@ -164,6 +255,19 @@ static void startRtosHttpConfig(void)
         ESP_LOGW(TAG, "%s xSemUartTxGuard %s", heapFail, rtrnNewLine);
     }
 
+    cJSON_InternKeys(&bodyKey, 1);
+    for(uint8_t i = 0; i < RESP_FIELD_SZ; i++)
+    {
+        char batchPath[BATCH_PATH_SZ];
+
+        cJSON_InternKeys(&respFields[i].name, 1);
+        snprintf(batchPath, BATCH_PATH_SZ, "/%s/%s", bodyKey, respFields[i].name);
+        if(!cJSON_CompileQuery(&batchQueries[i], batchPath))
+        {
+            ESP_LOGW(TAG, "Query %s Compile Fail%s", respFields[i].name, rtrnNewLine);
+        }
+    }
+
     xTaskCreatePinnedToCore(&xHttpTask, "HTTP_TASK", STACK_DEPTH, 0, HTTP_PRIO, 0, 0);
 }
 
@@ -214,47 +318,45 @@ static void oneshotCallback(void *args)
 ** to the queue. 
 **
 ** Parameters:
-**  ptr - pointer to a cJSON object
-**  memSafe - boolean variable that states whether or not queue allocation has failed
+**  respPtr - pointer to the decoded response struct
 **
 ** Return:
-**  Boolean specifying if the queue failed and if the cJSON object needs to be "freed"
+**  none
 **
-** Notes: The cJSON library is used to format the JSON string received in the 
-** response into a struct like object whose values can be accessed. The reason
-** memSafe is used here is because if this fails to queue, then we need to free
-** up the memory allocated by creating the cJSON object!
+** Notes: The queue holds copies of the respData struct itself rather than
+** a pointer, so there is nothing to free if queuing fails (the struct simply
+** lives on the stack of the caller). respQueued is only set once the copy is
+** queued, so the validators of a response that never reached the UART aren't kept.
 */
-static bool queuingUartTxData(cJSON *ptr, bool memSafe)
+static void queuingUartTxData(const respData *respPtr)
 {
     if(xSemaphoreTake(xSemUartTxGuard, DEF_PEND))
     {
-        if(!xQueueSendToBack(xQueueUartTx, (void*) &ptr, DEF_PEND))
+        if(!xQueueSendToBack(xQueueUartTx, (void*) respPtr, DEF_PEND))
         {
             ESP_LOGE(TAG, "%sxQueueUartTx%s", queueSendFail, rtrnNewLine);
             xSemaphoreGive(xSemUartTxGuard);
-            memSafe = false;
         }
-        /* Don't want memory freed if there is no failure! */  
+        else
+        {
+            respQueued = true;
+        }
     }
     else
     {
         ESP_LOGW(TAG, "xQueueUartTx%s%s", queueFullFail, rtrnNewLine);
-        memSafe = false;
     }
-
-    return memSafe;
 }
 
 
 
 /* The postRespHndlr() function is called upon any HTTP event, but only
-** executes its functionality when the Event ID is 'HTTP_EVENT_ON_DATA'.
-** Once the data is received from the response, it is handled here by 
-** making it into a cJSON object (info on cJSOn purpose in queuingUartTxData()
-** function notes). After checking that the responseID and responseCode exist,
-** we pass it to a switch statement that handles the different response codes
-** (of which only three are viable).
+** executes its functionality for the headers sent, header, data, and finish events.
+** When the whole response arrives in a single 'HTTP_EVENT_ON_DATA' event (and
+** isn't the answer to a batch POST), it is decoded right there into a respData
+** struct using the respFields[] descriptor table. Otherwise (the body is split
+** across TCP segments or sent with chunked encoding) each chunk is copied onto
+** the end of respBuf and the gathered body is picked up on 'HTTP_EVENT_ON_FINISH'.
 **
 ** Parameters:
 **  event - the struct for an HTTP event
@@ -262,58 +364,407 @@ static bool queuingUartTxData(cJSON *ptr, bool memSafe)
 ** Return:
 ** A typedef integer that represents a status code for ESP-IDF
 **
-** Notes: For cJSON objects, you only need to free the original object
-** (in this case responsePtr) you created and not the 'sub-objects' that
-** branch from it (like responseId). Further details on the meaning of
-** certain response codes can be found in the Django Python code (specifically
-** the views.py file). Remember, the timer IDs correspond to the POST response
-** IDs, so if the POST fails, we can restart the timers here.
+** Notes: cJSON_DecodeObjectWithError() does a single pass over the response and only
+** stores the six fields we care about (everything else is skipped), so no cJSON
+** object is built and the heap is not touched at all. Where and why decoding failed
+** is kept in parseErr on this task's stack rather than in cJSON's shared error
+** pointer, so parses on the other core can't clobber it. Only one request is ever
+** in flight, so a single static respBuf serves all of them. A body that won't fit
+** in it (going by the Content-Length header when there is one, otherwise by the
+** chunks themselves) is flagged on the first chunk that would overrun it, and every
+** chunk after that is dropped without being copied. The buffer is reset once the
+** headers of every request are sent (the connection is kept alive between requests,
+** so a connect event only comes with a new socket) so that a partial response from
+** a failed attempt can't leak into the next one. The ETag and Last-Modified
+** headers are handed to condHeaderHndlr() as they arrive. A 304 response has no
+** body, so no data event comes with it and nothing is decoded.
 */
 static esp_err_t postRespHndlr(esp_http_client_event_handle_t event)
 {
-    bool memSafe = true;
-    if((event->event_id) == HTTP_EVENT_ON_DATA)
+    switch(event->event_id)
     {
-        cJSON *responsePtr = cJSON_ParseWithLength(event->data, \
-                                                        event->data_len);
+        case HTTP_EVENT_HEADERS_SENT:
+            respLen = 0;
+            respStreamed = false;
+            respOverflow = false;
+            respQueued = false;
+            memset(&condRecv, 0, sizeof(condRecv));
+            break;
 
-        cJSON *responseId = cJSON_GetObjectItemCaseSensitive(responsePtr, "id");
+        case HTTP_EVENT_ON_HEADER:
+            condHeaderHndlr(event->header_key, event->header_value);
+            break;
 
-        cJSON *responseCode = cJSON_GetObjectItemCaseSensitive(responsePtr, \
-                                                                    "responseCode");
-        
-        if(!(cJSON_IsNumber(responseCode)) ||
-            !(cJSON_IsNumber(responseId)))
+        case HTTP_EVENT_ON_DATA:
+            if(!respStreamed && !respBatched && \
+                !esp_http_client_is_chunked_response(event->client) && \
+                (esp_http_client_get_content_length(event->client) == event->data_len))
+            {
+                respDecodeHndlr(event->data, event->data_len);
+            }
+            else
+            {
+                respOverflow = respOverflow || \
+                               (!respStreamed && (esp_http_client_get_content_length(event->client) > RESP_BUF_SZ)) || \
+                               ((size_t)event->data_len > (RESP_BUF_SZ - respLen));
+                respStreamed = true;
+
+                if(!respOverflow)
+                {
+                    memcpy(&respBuf[respLen], event->data, event->data_len);
+                    respLen += event->data_len;
+                }
+            }
+            break;
+
+        case HTTP_EVENT_ON_FINISH:
+            if(respStreamed)
+            {
+                respFinishHndlr();
+            }
+            break;
+
+        default:
+            break;
+    } /* End Switch Statement */
+
+    return ESP_OK;
+}
+
+
+
+/* The respFinishHndlr() function passes a response that arrived in several
+** chunks on from respBuf, where postRespHndlr() gathered it. A single response
+** goes through respDecodeHndlr() like one that came in one chunk.
+**
+** Parameters:
+**  none
+**
+** Return:
+**  none
+**
+** Notes: Batch responses always come through here. They are parsed into the
+** static respArena and handed to batchSplitHndlr(), and cJSON_Delete() then only
+** lets go of the arena, so no heap is used for them either. cJSON_ArenaSizeFor()
+** is checked first, so a body that could outgrow respArena is turned away rather
+** than having cJSON chain a heap block on. A response that overflowed respBuf
+** is reported as not decoded. For a batch this leaves batchSplit unset, which has
+** sendBatch() fall back on single requests (a batch answer that big is most likely
+** an error page anyway). cJSON walks the tree without recursing, so the stack this
+** needs doesn't grow with the nesting of the response. The high-water mark logged
+** at debug level is what STACK_DEPTH can be trimmed against.
+*/
+static void respFinishHndlr(void)
+{
+    respStreamed = false;
+
+    if(respOverflow)
+    {
+        respData response = {0};
+
+        ESP_LOGW(TAG, "Response Over %u Bytes Dropped%s", (unsigned)RESP_BUF_SZ, rtrnNewLine);
+        if(!respBatched)
         {
-            ESP_LOGE(TAG, "JSON Fail in Response Handler%s", rtrnNewLine);
-            cJSON_Delete(responsePtr);
-            return ESP_OK;
+            respDataHndlr(&response, false);
         }
-        
-        switch(responseCode->valueint)
+    }
+    else if(!respBatched)
+    {
+        respDecodeHndlr(respBuf, respLen);
+    }
+    else if(cJSON_ArenaSizeFor(respBuf, respLen) <= RESP_ARENA_SZ)
+    {
+        cJSON_ParseError parseErr;
+        cJSON *batchPtr = cJSON_ParseWithLengthArenaWithError(respBuf, respLen, respArena, RESP_ARENA_SZ, &parseErr);
+
+        if(batchPtr == NULL)
+        {
+            ESP_LOGW(TAG, "Batch JSON Fail at Byte %u, Reason %d%s", \
+                     (unsigned)parseErr.position, parseErr.reason, rtrnNewLine);
+        }
+        batchSplitHndlr(batchPtr);
+        cJSON_Delete(batchPtr); /* Only Releases the Arena */
+    }
+    else
+    {
+        ESP_LOGW(TAG, "Batch Response Over %u Arena Bytes Dropped%s", (unsigned)RESP_ARENA_SZ, rtrnNewLine);
+    }
+
+#ifdef CJSON_PROFILE_ALLOCATIONS
+    jsonProfileHndlr();
+#endif
+    ESP_LOGD(TAG, "Stack High-Water Mark %u Bytes Free%s", \
+             (unsigned)uxTaskGetStackHighWaterMark(NULL), rtrnNewLine);
+}
+
+
+
+/* The respDecodeHndlr() function decodes a whole single (not batched) response
+** body into a respData struct using the respFields[] descriptor table, and
+** passes it on to respDataHndlr().
+**
+** Parameters:
+**  dataPtr - pointer to the response body (not null terminated)
+**  dataLen - length of the response body in bytes
+**
+** Return:
+**  none
+**
+** Notes: The body is read where it lies, either in the event data of a single
+** chunk or in respBuf, so it is never copied again.
+*/
+static void respDecodeHndlr(const char *dataPtr, size_t dataLen)
+{
+    respData response = {0};
+    cJSON_ParseError parseErr;
+    bool decoded = cJSON_DecodeObjectWithError(dataPtr, dataLen, respFields, RESP_FIELD_SZ, \
+                                               &response, &response.fieldsFound, &parseErr);
+
+    if(!decoded)
+    {
+        ESP_LOGW(TAG, "JSON Fail at Byte %u, Reason %d%s", \
+                 (unsigned)parseErr.position, parseErr.reason, rtrnNewLine);
+    }
+    respDataHndlr(&response, decoded);
+}
+
+
+
+/* The batchSplitHndlr() function splits the response to a batch POST back into
+** the responses to each of the requests in it. Every entry is an object holding
+** the "id" of a request and the "body" the server would have answered it with
+** alone, and each body goes through respDataHndlr() like a single response.
+**
+** Parameters:
+**  batchPtr - pointer to the parsed batch response (NULL if it wasn't JSON)
+**
+** Return:
+**  none
+**
+** Notes: Anything other than an array means the server doesn't know about batch
+** POSTs (a 404 page for instance). batchSplit is then left unset, which is how
+** sendBatch() knows to fall back on sending the requests one by one. The "id" of
+** each entry is crossed off of batchPending, so requests the server skipped can
+** have their timers restarted. Its stored validators are cleared too, since they
+** belong to the last single response and no longer match what goes on to the
+** UART, so the next poll of that request can't be answered with a 304.
+*/
+static void batchSplitHndlr(const cJSON *batchPtr)
+{
+    const cJSON *entryPtr = NULL;
+
+    if(!cJSON_IsArray(batchPtr))
+    {
+        return;
+    }
+    batchSplit = true;
+
+    cJSON_ArrayForEach(entryPtr, batchPtr)
+    {
+        respData response = {0};
+        const cJSON *idPtr = cJSON_GetObjectItemCaseSensitive(entryPtr, respFields[0].name); /* respFields[0] is "id" */
+
+        if(cJSON_IsNumber(idPtr) && (idPtr->valueint >= 0) && \
+            (idPtr->valueint < (int)(sizeof(batchPending) * 8)))
+        {
+            batchPending &= (uint8_t)~(1U << idPtr->valueint);
+            if(idPtr->valueint < POST_STATE_SZ)
+            {
+                memset(&condArr[idPtr->valueint], 0, sizeof(condArr[idPtr->valueint]));
+            }
+        }
+
+        bool decoded = cJSON_IsObject(entryPtr) && \
+                       cJSON_DecodeItemWithQueries(entryPtr, batchQueries, respFields, \
+                                                   RESP_FIELD_SZ, &response, &response.fieldsFound);
+        respDataHndlr(&response, decoded);
+    }
+}
+
+
+
+/* The condHeaderHndlr() function keeps the cache validators (ETag and
+** Last-Modified) of the response being received in condRecv.
+**
+** Parameters:
+**  key - name of the response header
+**  value - value of the response header
+**
+** Return:
+**  none
+**
+** Notes: Header names are case-insensitive. A validator that doesn't fit is
+** left out rather than cut short, since a shortened ETag would never match.
+*/
+static void condHeaderHndlr(const char *key, const char *value)
+{
+    if(!strcasecmp(key, "ETag"))
+    {
+        if(snprintf(condRecv.etag, ETAG_LEN, "%s", value) >= ETAG_LEN)
         {
-            case VALID_RESP:
-                /* Fall-through */
-            case INVALID_RESP:
-                /* Fall-through */
-            case NO_RSV_RESP:
-                memSafe = queuingUartTxData(responsePtr, memSafe);
-                break;
-            
-            default:
-                /* Don't want to wait full default timeout if we failed here! */
-                timerRestart(responseId->valueint, DEF_FAIL_TOUT); /* Access Code Exception Handled in timerRestart()! */
-                ESP_LOGE(TAG, "Invalid - Response Code: %d", responseCode->valueint);
-                break;
-        } /* End Switch Statement */
-
-        if(!memSafe)
+            condRecv.etag[0] = '\0';
+        }
+    }
+    else if(!strcasecmp(key, "Last-Modified"))
+    {
+        if(snprintf(condRecv.lastModified, HTTP_DATE_LEN, "%s", value) >= HTTP_DATE_LEN)
         {
-            cJSON_Delete(responsePtr);
+            condRecv.lastModified[0] = '\0';
         }
     }
+}
 
-    return ESP_OK;
+
+
+/* The condRequestHndlr() function sets the conditional request headers of
+** the next request from the stored validators of its request ID.
+**
+** Parameters:
+**  client - the long-lived HTTP client of the xHttpTask
+**  condPtr - pointer to the validators to send (NULL for an unconditional request)
+**
+** Return:
+**  none
+**
+** Notes: The client keeps its headers between requests, so any that don't
+** apply to this request have to be deleted rather than just left unset.
+*/
+static void condRequestHndlr(esp_http_client_handle_t client, const condValidators *condPtr)
+{
+    if((condPtr != NULL) && (condPtr->etag[0] != '\0'))
+    {
+        esp_http_client_set_header(client, "If-None-Match", condPtr->etag);
+    }
+    else
+    {
+        esp_http_client_delete_header(client, "If-None-Match");
+    }
+
+    if((condPtr != NULL) && (condPtr->lastModified[0] != '\0'))
+    {
+        esp_http_client_set_header(client, "If-Modified-Since", condPtr->lastModified);
+    }
+    else
+    {
+        esp_http_client_delete_header(client, "If-Modified-Since");
+    }
+}
+
+
+
+/* The condResultHndlr() function updates the stored validators of a request
+** ID once a conditional request has been answered.
+**
+** Parameters:
+**  client - the long-lived HTTP client of the xHttpTask
+**  id - ID of the request that was answered
+**
+** Return:
+**  none
+**
+** Notes: A 304 means the data the UART was last sent is still current, so the
+** validators are kept and there's nothing else to do. A 200 whose response made it
+** onto xQueueUartTx replaces them (a server that stops sending them clears them).
+** Any other answer clears them, so the next poll fetches the data in full.
+*/
+static void condResultHndlr(esp_http_client_handle_t client, uint8_t id)
+{
+    int status = esp_http_client_get_status_code(client);
+
+    if(status == 304)
+    {
+        ESP_LOGD(TAG, "%s Not Modified%s", retryPolicies[id].name, rtrnNewLine);
+    }
+    else if((status == 200) && respQueued)
+    {
+        condArr[id] = condRecv;
+    }
+    else
+    {
+        memset(&condArr[id], 0, sizeof(condArr[id]));
+    }
+}
+
+
+
+/* The jsonProfileHndlr() function logs the cJSON allocation counters of every
+** call site that has allocated since boot, so it can be seen which parts of
+** the response path still churn the heap.
+**
+** Parameters:
+**  none
+**
+** Return:
+**  none
+**
+** Notes: The counters only exist when cJSON.c is built with
+** CJSON_PROFILE_ALLOCATIONS (see main/CMakeLists.txt), so this function and
+** its call are only compiled in then. The site array is static because it is
+** 640 bytes on the ESP32, too much for the HTTP task's stack.
+*/
+#ifdef CJSON_PROFILE_ALLOCATIONS
+static void jsonProfileHndlr(void)
+{
+    static cJSON_AllocationSite sites[CJSON_PROFILE_SITES];
+    size_t siteCnt = cJSON_GetAllocationProfile(sites, CJSON_PROFILE_SITES);
+
+    for (size_t i = 0; i < siteCnt; i++)
+    {
+        if (sites[i].allocations == 0)
+        {
+            continue;
+        }
+
+        ESP_LOGI(TAG, "cJSON %s: %lu Allocs, %lu Frees, %u Live Bytes (Peak %u), Mean Lifetime %lu Allocs", \
+                 sites[i].name, sites[i].allocations, sites[i].frees, (unsigned)sites[i].live_bytes, \
+                 (unsigned)sites[i].peak_live_bytes, (sites[i].frees ? (sites[i].lifetime / sites[i].frees) : 0));
+    }
+}
+#endif
+
+
+
+/* The respDataHndlr() function checks that the responseID and responseCode exist
+** in a decoded response, and then passes it to a switch statement that handles the
+** different response codes (of which only three are viable).
+**
+** Parameters:
+**  respPtr - pointer to the decoded response struct
+**  decoded - boolean stating whether the response was valid JSON
+**
+** Return:
+**  none
+**
+** Notes: Further details on the meaning of certain response codes can be found
+** in the Django Python code (specifically the views.py file). Remember, the timer
+** IDs correspond to the POST response IDs, so if the POST fails, we can restart the
+** timers here.
+*/
+static void respDataHndlr(respData *respPtr, bool decoded)
+{
+    if(!decoded || \
+        ((respPtr->fieldsFound & (ID_FIELD | CODE_FIELD)) != (ID_FIELD | CODE_FIELD)))
+    {
+        ESP_LOGE(TAG, "JSON Fail in Response Handler%s", rtrnNewLine);
+        return;
+    }
+    
+    switch(respPtr->responseCode)
+    {
+        case VALID_RESP:
+            /* Fall-through */
+        case INVALID_RESP:
+            /* Fall-through */
+        case NO_RSV_RESP:
+            queuingUartTxData(respPtr);
+            break;
+        
+        default:
+            /* Don't want to wait full default timeout if we failed here! */
+            timerRestart(respPtr->id, DEF_FAIL_TOUT); /* Access Code Exception Handled in timerRestart()! */
+            ESP_LOGE(TAG, "Invalid - Response Code: %d", respPtr->responseCode);
+            break;
+    } /* End Switch Statement */
 }
 
 
@@ -375,7 +826,10 @@ void giveSemUartTxGuard(void)
 ** initial time periods which are equivalent to their failure periods.) The
 ** function pends indefinitely on the xQueueHttp Queue until receiving a pointer to
 ** a typedef struct requestBodyData. It uses the information stored in this struct
-** to fill out the HTTP config.
+** to point the HTTP client at the request's URL and body. Any other requests
+** already waiting in the queue by then (at boot or after a reconnect, the time,
+** reservation and access code requests tend to pile up) are taken along and sent
+** in one batch POST, so they share a single round trip.
 **
 ** Parameters:
 **  none used
@@ -383,50 +837,499 @@ void giveSemUartTxGuard(void)
 ** Return:
 **  none
 **
-** Notes: Redundancy is used by retransmitting HTTP Request 11 times (if they fail) 
-** before stopping Request attempts. The timerRestart() function also makes an appearance here.
+** Notes: A failed request isn't retransmitted right away. It waits in retryArr[]
+** with a backoff set by the retryPolicies[] entry of its ID, and the task goes back
+** to pending on the queue, only for as long as the next retry can wait, so other
+** requests never sit behind a dead server. The timerRestart() function is called for
+** requests that are given up on. A single client is created on the first request and kept for the life of the task, so
+** every request after that goes out over the same HTTP/1.1 keep-alive connection instead of
+** paying for a new socket, buffers and TCP handshake (which is most of the wait at the door
+** for an access code check). If the server closes the connection, the client notices on the
+** next request and connects again by itself. A failed attempt closes it on our end too, so
+** the retry never goes out over a connection that's gone stale. Batching is dropped
+** for good (until reboot) the first time the server doesn't answer a batch, and the
+** requests of that batch are then sent one by one.
 */
 static void xHttpTask(void *pvParameters)
 {
+    esp_http_client_handle_t client = NULL;
+
     esp_timer_start_once(timeRequest, TIME_FAIL_TOUT);
     esp_timer_start_once(reserveRequest, RSV_FAIL_TOUT);
 
     while(true)
     {
-        requestBodyData *dataPtr = 0;
-        uint8_t count;
+        retryEntry entryArr[BATCH_SZ] = {0};
+        uint8_t reqCnt = 0;
         
-        xQueueReceive(xQueueHttp, &dataPtr, portMAX_DELAY);
-        giveSemHttpGuard();
+        if(xQueueReceive(xQueueHttp, &entryArr[0].reqPtr, retryWaitTicks()))
+        {
+            giveSemHttpGuard();
+            retryStart(&entryArr[0], entryArr[0].reqPtr);
+            reqCnt = 1;
+
+            /* Never Waits, Only Takes What's Already Queued */
+            while(batchSupported && (reqCnt < BATCH_SZ) && xQueueReceive(xQueueHttp, &entryArr[reqCnt].reqPtr, 0))
+            {
+                giveSemHttpGuard();
+                retryStart(&entryArr[reqCnt], entryArr[reqCnt].reqPtr);
+                reqCnt++;
+            }
+        }
         
-        esp_http_client_config_t postReqConfig = 
+        if((client == NULL) && (reqCnt > 0)) /* Retries Only Exist Once There's a Client */
         {
-            .url = dataPtr->url,
-            .method = HTTP_METHOD_POST,
-            .cert_pem = NULL,
-            .event_handler = postRespHndlr,
-            .timeout_ms = HTTP_TOUT,
-        };
-
-        esp_http_client_handle_t client = esp_http_client_init(&postReqConfig);
-        esp_http_client_set_post_field(client, dataPtr->jsonStr, (dataPtr->jsonStrLen) - 1);
-        esp_http_client_set_header(client, "Content-Type", "application/json");
-
-        for(count = 0; count < MAX_ATMPT; count++)
+            esp_http_client_config_t postReqConfig = 
+            {
+                .url = entryArr[0].reqPtr->url,
+                .method = HTTP_METHOD_POST,
+                .cert_pem = NULL,
+                .event_handler = postRespHndlr,
+                .timeout_ms = HTTP_TOUT,
+                .keep_alive_enable = true, /* TCP Probes Catch a Dead Server While Idle */
+            };
+
+            client = esp_http_client_init(&postReqConfig);
+            if(client == NULL)
+            {
+                ESP_LOGE(TAG, "HTTP Client %s%s", mallocFail, rtrnNewLine);
+            }
+            else
+            {
+                esp_http_client_set_header(client, "Content-Type", "application/json"); /* Kept Across Requests */
+            }
+        }
+
+        if(client == NULL)
         {
-            if(esp_http_client_perform(client) == ESP_OK)
+            for(uint8_t i = 0; i < reqCnt; i++)
             {
-                break;
+                retryHndlr(&entryArr[i], POST_FATAL); /* Restarts its Timer and Frees it */
             }
+            continue;
         }
-        esp_http_client_cleanup(client);
 
-        if(count == MAX_ATMPT)
+        if((reqCnt < 2) || !sendBatch(client, entryArr, reqCnt))
         {
-            timerRestart(dataPtr->id, DEF_FAIL_TOUT);
+            for(uint8_t i = 0; i < reqCnt; i++)
+            {
+                sendAttempt(client, &entryArr[i]);
+            }
         }
-        
-        /* Used to cleanup the requestBodyData Struct */
-        mallocCleanup(dataPtr, MAX_HEAP);
+
+        retryDueHndlr(client);
+    }
+}
+
+
+
+/* The sendRequest() function points the HTTP client at a URL and body and
+** performs the POST once, sorting out whether a failure is worth retrying.
+**
+** Parameters:
+**  client - the long-lived HTTP client of the xHttpTask
+**  url - the URL to POST to
+**  body - the JSON body of the request
+**  bodyLen - length of body (without the Null Terminator)
+**
+** Return:
+**  A typedef enum postResult on how the attempt went
+**
+** Notes: The client only keeps a pointer to the body, so it has to live until
+** the next request sets another one. Connection, timeout and transport errors
+** may clear up, and so may a 408, 429 or 5xx status. Bad arguments, redirect
+** loops and transports we don't have won't, so those aren't retried.
+*/
+static postResult sendRequest(esp_http_client_handle_t client, const char *url, const char *body, size_t bodyLen)
+{
+    esp_http_client_set_url(client, url);
+    esp_http_client_set_post_field(client, body, bodyLen);
+
+    esp_err_t err = esp_http_client_perform(client);
+
+    if(err == ESP_OK)
+    {
+        int status = esp_http_client_get_status_code(client);
+
+        return ((status == 408) || (status == 429) || (status >= 500)) ? POST_RETRY : POST_DONE;
+    }
+
+    esp_http_client_close(client); /* Next Attempt Reconnects */
+    ESP_LOGD(TAG, "POST Fail %s%s", esp_err_to_name(err), rtrnNewLine);
+
+    switch(err)
+    {
+        case ESP_ERR_INVALID_ARG:
+            /* Fall-through */
+        case ESP_ERR_HTTP_MAX_REDIRECT:
+            /* Fall-through */
+        case ESP_ERR_HTTP_INVALID_TRANSPORT:
+            return POST_FATAL;
+
+        default:
+            return POST_RETRY;
+    } /* End Switch Statement */
+}
+
+
+
+/* The sendAttempt() function makes one attempt at a request and passes the
+** outcome on to retryHndlr().
+**
+** Parameters:
+**  client - the long-lived HTTP client of the xHttpTask
+**  entryPtr - pointer to the retry state of the request
+**
+** Return:
+**  none
+**
+** Notes: Requests whose condEnabled[] entry is set carry the validators of their
+** last response (If-None-Match and If-Modified-Since), so the server can answer
+** a poll with an empty 304 when nothing changed. That skips the decoding, the
+** formatting and the UART transmission of a response we've already passed on.
+*/
+static void sendAttempt(esp_http_client_handle_t client, retryEntry *entryPtr)
+{
+    requestBodyData *reqPtr = entryPtr->reqPtr;
+    bool conditional = condEnabled[reqPtr->id];
+
+    condRequestHndlr(client, conditional ? &condArr[reqPtr->id] : NULL);
+    postResult result = sendRequest(client, reqPtr->url, reqPtr->jsonStr, (reqPtr->jsonStrLen) - 1);
+    if(conditional && (result == POST_DONE))
+    {
+        condResultHndlr(client, reqPtr->id);
+    }
+
+    retryHndlr(entryPtr, result);
+}
+
+
+
+/* The retryStart() function sets up the retry state of a request as it is taken
+** off the xQueueHttp Queue and counts it against its retry policy.
+**
+** Parameters:
+**  entryPtr - pointer to the retry state to fill in
+**  reqPtr - pointer to the requestBodyData struct in dynamic memory
+**
+** Return:
+**  none
+**
+** Notes: The request is owned from here on, it is either freed once it's done
+** with or left waiting in retryArr[]. Its deadline counts from here, so the time
+** it spends in a batch POST (or waiting on the ones queued with it) is part of it.
+*/
+static void retryStart(retryEntry *entryPtr, requestBodyData *reqPtr)
+{
+    entryPtr->reqPtr = reqPtr;
+    entryPtr->dueTime = 0;
+    entryPtr->deadline = esp_timer_get_time() + ((int64_t)retryPolicies[reqPtr->id].deadline * 1000);
+    entryPtr->atmptCnt = 0;
+    retryStatsArr[reqPtr->id].requests++;
+}
+
+
+
+/* The retryHndlr() function decides what happens to a request after an attempt.
+** A request that got its response, or that is given up on, is freed. Otherwise
+** it is (or stays) stored in retryArr[] until its backoff runs out.
+**
+** Parameters:
+**  entryPtr - pointer to the retry state of the request
+**  result - how the attempt went
+**
+** Return:
+**  none
+**
+** Notes: Giving up restarts the timer of the request like the old back-to-back
+** retransmitting did after MAX_ATMPT failures. The counters of the policy are
+** logged at debug level whenever a request is done with.
+*/
+static void retryHndlr(retryEntry *entryPtr, postResult result)
+{
+    requestBodyData *reqPtr = entryPtr->reqPtr;
+    const retryPolicy *policyPtr = &retryPolicies[reqPtr->id];
+    retryStats *statsPtr = &retryStatsArr[reqPtr->id];
+
+    entryPtr->atmptCnt++;
+    statsPtr->attempts++;
+
+    switch(result)
+    {
+        case POST_DONE:
+            statsPtr->successes++;
+            break;
+
+        case POST_RETRY:
+            if(retryBackoff(entryPtr, policyPtr) && retryStore(entryPtr))
+            {
+                statsPtr->retries++;
+                return;
+            }
+            statsPtr->expired++;
+            timerRestart(reqPtr->id, DEF_FAIL_TOUT);
+            break;
+
+        default:
+            statsPtr->rejected++;
+            timerRestart(reqPtr->id, DEF_FAIL_TOUT);
+            break;
+    } /* End Switch Statement */
+
+    ESP_LOGD(TAG, "Retry %s: %lu Requests, %lu Attempts, %lu Retries, %lu OK, %lu Expired, %lu Rejected%s", \
+             policyPtr->name, statsPtr->requests, statsPtr->attempts, statsPtr->retries, \
+             statsPtr->successes, statsPtr->expired, statsPtr->rejected, rtrnNewLine);
+
+    /* Used to cleanup the requestBodyData Struct */
+    mallocCleanup(reqPtr, MAX_HEAP);
+    entryPtr->reqPtr = NULL;
+}
+
+
+
+/* The retryBackoff() function sets when the next attempt at a request is due,
+** using exponential backoff with jitter.
+**
+** Parameters:
+**  entryPtr - pointer to the retry state of the request
+**  policyPtr - pointer to the retry policy of the request
+**
+** Return:
+**  A Boolean that is false if the attempt limit or deadline rules out a retry
+**
+** Notes: The backoff doubles from baseDelay up to maxDelay, and the wait is a
+** random point in its upper half, so requests that failed together (like the
+** ones of a batch) don't all come back at the same moment.
+*/
+static bool retryBackoff(retryEntry *entryPtr, const retryPolicy *policyPtr)
+{
+    uint32_t backoff = policyPtr->maxDelay;
+
+    if(entryPtr->atmptCnt >= policyPtr->maxAtmpt)
+    {
+        return false;
+    }
+
+    if((entryPtr->atmptCnt <= 16) && ((policyPtr->baseDelay << (entryPtr->atmptCnt - 1)) < backoff))
+    {
+        backoff = policyPtr->baseDelay << (entryPtr->atmptCnt - 1);
     }
+    backoff = (backoff / 2) + (esp_random() % ((backoff / 2) + 1));
+    entryPtr->dueTime = esp_timer_get_time() + ((int64_t)backoff * 1000);
+
+    return entryPtr->dueTime < entryPtr->deadline;
+}
+
+
+
+/* The retryStore() function keeps a request that has to be tried again in
+** retryArr[] until it is due.
+**
+** Parameters:
+**  entryPtr - pointer to the retry state of the request
+**
+** Return:
+**  A Boolean that is false if retryArr[] is full
+*/
+static bool retryStore(const retryEntry *entryPtr)
+{
+    if((entryPtr >= retryArr) && (entryPtr < &retryArr[RETRY_SZ]))
+    {
+        return true; /* Already Waiting in retryArr[] */
+    }
+
+    for(uint8_t i = 0; i < RETRY_SZ; i++)
+    {
+        if(retryArr[i].reqPtr == NULL)
+        {
+            retryArr[i] = *entryPtr;
+            return true;
+        }
+    }
+
+    ESP_LOGW(TAG, "No Room to Retry Request %u%s", entryPtr->reqPtr->id, rtrnNewLine);
+    return false;
+}
+
+
+
+/* The retryDueHndlr() function makes the next attempt at every request in
+** retryArr[] whose backoff has run out.
+**
+** Parameters:
+**  client - the long-lived HTTP client of the xHttpTask
+**
+** Return:
+**  none
+*/
+static void retryDueHndlr(esp_http_client_handle_t client)
+{
+    for(uint8_t i = 0; i < RETRY_SZ; i++)
+    {
+        if((retryArr[i].reqPtr != NULL) && (retryArr[i].dueTime <= esp_timer_get_time()))
+        {
+            sendAttempt(client, &retryArr[i]);
+        }
+    }
+}
+
+
+
+/* The retryWaitTicks() function works out how long the xHttpTask can pend on
+** the xQueueHttp Queue before a retry is due.
+**
+** Parameters:
+**  none
+**
+** Return:
+**  The number of ticks to pend for (portMAX_DELAY if no retry is waiting)
+**
+** Notes: The wait is rounded up to whole ticks, so the task doesn't wake a
+** tick early and spin until the retry is due.
+*/
+static TickType_t retryWaitTicks(void)
+{
+    int64_t nextDue = INT64_MAX;
+
+    for(uint8_t i = 0; i < RETRY_SZ; i++)
+    {
+        if((retryArr[i].reqPtr != NULL) && (retryArr[i].dueTime < nextDue))
+        {
+            nextDue = retryArr[i].dueTime;
+        }
+    }
+
+    if(nextDue == INT64_MAX)
+    {
+        return portMAX_DELAY;
+    }
+
+    int64_t waitTime = nextDue - esp_timer_get_time();
+
+    return (waitTime > 0) ? (pdMS_TO_TICKS(waitTime / 1000) + 1) : 0;
+}
+
+
+
+/* The sendBatch() function sends several requests in a single batch POST. Their
+** responses are split back apart by batchSplitHndlr() while the POST runs.
+**
+** Parameters:
+**  client - the long-lived HTTP client of the xHttpTask
+**  entryArr - the retry states of the requests to send, in the order they were queued
+**  reqCnt - the number of requests in entryArr
+**
+** Return:
+**  A Boolean that is false if the requests still have to be sent one by one
+**
+** Notes: If the batch POST fails, each of its requests goes on to retryHndlr() as
+** if its own first attempt had failed the same way, so the retries go out singly
+** within the deadlines their retryStart() set when they were dequeued. A request
+** the server left out of its answer is given up on. Only when the server doesn't
+** do batches are the requests handed back (still owned by the caller) to be sent
+** one by one. A batch is never sent conditionally, since its headers can't
+** speak for each request in it, and its answer clears the stored validators of
+** every request it answers (see batchSplitHndlr()).
+*/
+static bool sendBatch(esp_http_client_handle_t client, retryEntry *entryArr, uint8_t reqCnt)
+{
+    size_t bodyLen = 0;
+    char *bodyStr = NULL;
+    postResult result = POST_FATAL;
+
+    if((batchUrl == NULL) && ((batchUrl = batchUrlToString()) == NULL))
+    {
+        return false;
+    }
+
+    if((bodyStr = batchBodyToString(entryArr, reqCnt, &bodyLen)) == NULL)
+    {
+        return false;
+    }
+
+    batchPending = 0;
+    for(uint8_t i = 0; i < reqCnt; i++)
+    {
+        batchPending |= (uint8_t)(1U << entryArr[i].reqPtr->id);
+    }
+    batchSplit = false;
+    respBatched = true;
+    condRequestHndlr(client, NULL);
+    result = sendRequest(client, batchUrl, bodyStr, bodyLen);
+    respBatched = false;
+    free(bodyStr);
+
+    if((result == POST_DONE) && !batchSplit)
+    {
+        ESP_LOGW(TAG, "Server Can't Batch, Sending Requests One by One%s", rtrnNewLine);
+        batchSupported = false;
+        return false;
+    }
+
+    for(uint8_t i = 0; i < reqCnt; i++)
+    {
+        bool answered = !(batchPending & (1U << entryArr[i].reqPtr->id));
+
+        retryHndlr(&entryArr[i], ((result == POST_DONE) && !answered) ? POST_FATAL : result);
+    }
+
+    return true;
+}
+
+
+
+/* The batchBodyToString() function allocates and writes the body of a batch
+** POST, a JSON array holding an object for each request with its "id" and its
+** usual JSON "body".
+**
+** Parameters:
+**  entryArr - the retry states of the requests to put in the batch
+**  reqCnt - the number of requests in entryArr
+**  bodyLen - set to the length of the body (without the Null Terminator)
+**
+** Return:
+**  A pointer to the body, or NULL if memory allocation or writing failed
+**
+** Notes: The bodies were already written by the xParsingTask, so they are
+** copied in as they are instead of being parsed and written again.
+*/
+static char *batchBodyToString(const retryEntry *entryArr, uint8_t reqCnt, size_t *bodyLen)
+{
+    cJSON_Writer writer;
+    size_t bodySz = 3; /* Brackets and the Null Terminator */
+
+    for(uint8_t i = 0; i < reqCnt; i++)
+    {
+        bodySz += BATCH_ENTRY_SZ + entryArr[i].reqPtr->jsonStrLen;
+    }
+
+    char *bodyStr = (char*) malloc(sizeof(char) * bodySz);
+
+    if(bodyStr == NULL)
+    {
+        ESP_LOGE(TAG, "Batch Body %s%s", mallocFail, rtrnNewLine);
+        return NULL;
+    }
+
+    cJSON_WriterInit(&writer, bodyStr, bodySz);
+    cJSON_WriteBeginArray(&writer);
+    for(uint8_t i = 0; i < reqCnt; i++)
+    {
+        cJSON_WriteBeginObject(&writer);
+        cJSON_WriteKey(&writer, "id");
+        cJSON_WriteInt64(&writer, entryArr[i].reqPtr->id);
+        cJSON_WriteKey(&writer, bodyKey);
+        cJSON_WriteRaw(&writer, entryArr[i].reqPtr->jsonStr, (entryArr[i].reqPtr->jsonStrLen) - 1);
+        cJSON_WriteEndObject(&writer);
+    }
+    cJSON_WriteEndArray(&writer);
+
+    if(!(*bodyLen = cJSON_WriterFinish(&writer)))
+    { /* Only Reachable if BATCH_ENTRY_SZ is Made Too Small */
+        ESP_LOGE(TAG, "Batch Body too large%s", rtrnNewLine);
+        free(bodyStr);
+        return NULL;
+    }
+
+    return bodyStr;
 }
\ No newline at end of file
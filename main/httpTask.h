@@ -33,6 +33,9 @@
 */
 
 #define DEF_FAIL_TOUT 20000000 /* Time in microseconds */
+#define NAME_LEN 32 /* Size of First Name String (Including Null Terminator) */
+#define ETAG_LEN 64 /* Size of a Stored ETag (Including Null Terminator) */
+#define HTTP_DATE_LEN 32 /* Size of a Stored Last-Modified Date (Including Null Terminator) */
 
 /* Function Declarations */
 extern void startHttpConfig(void);
@@ -58,6 +61,74 @@ typedef enum
     CODE_ID,
 } respIdVals;
 
+/* Enum for Decoded POST Response Field Bits */
+typedef enum
+{
+    ID_FIELD = (1 << 0), /* Bits follow the order of respFields[] */
+    CODE_FIELD = (1 << 1),
+    TIME_FIELD = (1 << 2),
+    NAME_FIELD = (1 << 3),
+    START_FIELD = (1 << 4),
+    END_FIELD = (1 << 5),
+} respFieldBits;
+
+/* Typedef Struct for Decoded POST Responses */
+typedef struct
+{
+    int64_t serverTime;
+    int64_t unixStartTime;
+    int64_t unixEndTime;
+    int id;
+    int responseCode;
+    unsigned long fieldsFound; /* respFieldBits of the fields that were present */
+    char firstName[NAME_LEN];
+} respData;
+
+/* Enum for the Outcome of a Single POST Attempt */
+typedef enum
+{
+    POST_DONE, /* A response came back (it may still be an error response) */
+    POST_RETRY, /* Failed in a way that may clear up (timeout, reset, 5xx, ...) */
+    POST_FATAL, /* Failed in a way that sending it again won't fix */
+} postResult;
+
+/* Typedef Struct for a Retry Policy (One per Request ID) */
+typedef struct
+{
+    const char *name;
+    uint32_t baseDelay; /* Backoff Before the First Retry (ms), Doubled Each Retry */
+    uint32_t maxDelay; /* Backoff Never Grows Past This (ms) */
+    uint32_t deadline; /* No Retry Starts Later Than This After the First Attempt (ms) */
+    uint8_t maxAtmpt;
+} retryPolicy;
+
+/* Typedef Struct for the Counters Kept per Retry Policy */
+typedef struct
+{
+    unsigned long requests;
+    unsigned long attempts;
+    unsigned long retries;
+    unsigned long successes;
+    unsigned long expired; /* Gave Up at the Deadline or Attempt Limit */
+    unsigned long rejected; /* Gave Up on an Error That Can't Clear Up */
+} retryStats;
+
+/* Typedef Struct for a Request Waiting on its Next Attempt */
+typedef struct
+{
+    requestBodyData *reqPtr; /* NULL if the Slot is Free */
+    int64_t dueTime; /* esp_timer Time of the Next Attempt (us) */
+    int64_t deadline; /* esp_timer Time Past Which No Attempt Starts (us) */
+    uint8_t atmptCnt;
+} retryEntry;
+
+/* Typedef Struct for the Cache Validators of a Response */
+typedef struct
+{
+    char etag[ETAG_LEN]; /* Empty if the Server Sent None (or One Too Long to Keep) */
+    char lastModified[HTTP_DATE_LEN]; /* Same as Above */
+} condValidators;
+
 /* Typedef Struct for ESP-IDF Timers */
 typedef struct 
 {
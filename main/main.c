@@ -31,6 +31,9 @@
 #include "uartTasks.h"
 #include "ledTask.h"
 
+/* Other Headers */
+#include "cJSON.h"
+
 
 
 /* Variable Naming Abbreviations Legend:
@@ -51,6 +54,13 @@ const char rtrnNewLine[NEWLINE_LEN] = "\r\n";
 
 /* Static Function Declarations */
 static void startTzConfig(void);
+#ifdef CJSON_PROFILE_ALLOCATIONS
+static void jsonProfileLock(void *context);
+static void jsonProfileUnlock(void *context);
+
+/* Guards the cJSON Allocation Counters (Tasks on Both Cores Allocate) */
+static portMUX_TYPE jsonProfileMux = portMUX_INITIALIZER_UNLOCKED;
+#endif
 
 
 
@@ -64,9 +74,15 @@ static void startTzConfig(void);
 **
 ** Return:
 **  none
+**
+** Notes: The cJSON allocation counters get their lock before any task is
+** started, since cJSON must not have it set while another task allocates.
 */
 void app_main(void)
 {
+#ifdef CJSON_PROFILE_ALLOCATIONS
+    cJSON_SetAllocationProfileLock(jsonProfileLock, jsonProfileUnlock, &jsonProfileMux);
+#endif
     startTzConfig();
     startWifiConfig();
     startEspnowConfig();
@@ -92,3 +108,29 @@ static void startTzConfig(void)
     setenv("TZ", "CDT+5", 1);
     tzset();
 }
+
+
+
+/* The jsonProfileLock() and jsonProfileUnlock() functions enter and leave
+** the critical section that guards the cJSON allocation counters.
+**
+** Parameters:
+**  context - pointer to jsonProfileMux
+**
+** Return:
+**  none
+**
+** Notes: cJSON only holds the lock while it updates or copies its counters,
+** never while it allocates, so the critical section stays short.
+*/
+#ifdef CJSON_PROFILE_ALLOCATIONS
+static void jsonProfileLock(void *context)
+{
+    portENTER_CRITICAL((portMUX_TYPE*) context);
+}
+
+static void jsonProfileUnlock(void *context)
+{
+    portEXIT_CRITICAL((portMUX_TYPE*) context);
+}
+#endif
@@ -34,6 +34,9 @@
 #include "parsingTask.h"
 #include "uartTasks.h"
 
+/* Other Headers */
+#include "cJSON.h"
+
 
 
 /* Variable Naming Abbreviations Legend:
@@ -55,14 +58,13 @@
 
 /* Local Defines */
 #define TIME_LEN (POST_STATE_SZ)
+#define BODY_SZ 48 /* Fits One Key and a 64-bit Value as a String */
 
 /* Enum for Local Constant String Sizes */
 typedef enum
 {
     PARSE_RSV_LEN = 15,
     PARSE_CODE_LEN = 18,
-    DEF_RSV_LEN = 21,
-    DEF_CODE_LEN = 25,
     URL_LEN = 31,
     EARLY_FAIL_LEN = 32,
 } localStrLengths;
@@ -74,6 +76,8 @@ static parsingFunc urlToString;
 static parsingFunc parseTime;
 static parsingFunc parseReserve;
 static parsingFunc parseAccessCode;
+static bool writeJsonBody(requestBodyData *reqPtr, const char *keyStr, int64_t value, \
+                            const char *funcNameStr);
 
 /* FreeRTOS Local API Handles */
 static SemaphoreHandle_t xSemParseGuard;
@@ -100,6 +104,9 @@ static const char *urlPaths[POST_STATE_SZ] =
     "value/",
 };
 
+/* URL Path of the Batch Endpoint (Several Requests in One POST) */
+static const char batchPath[] = "batch/";
+
 /* Constant State Array of Pointers to Functions */
 static const parsingFuncPtr reqParseFuncs[POST_STATE_SZ] =
 {
@@ -227,25 +234,7 @@ bool parseReserve(requestBodyData *reqPtr)
 
     if(getTimeBool())
     {
-        size_t timeStrLen = 0;
-        time_t currentTime = getTime();
-
-        /* In case a server time larger than what is expected appears */
-        timeStrLen = snprintf(NULL, 0, "%lld", currentTime);
-
-        reqPtr->jsonStrLen = DEF_RSV_LEN + timeStrLen + 1;
-        reqPtr->jsonStr = (char*) malloc(sizeof(char) * (reqPtr->jsonStrLen));
-
-        if(reqPtr->jsonStr == NULL)
-        {
-            ESP_LOGE(TAG, "%s %s%s", funcNameStr, mallocFail, rtrnNewLine);
-            status = false;
-        }
-        else
-        {
-            snprintf(reqPtr->jsonStr, reqPtr->jsonStrLen, \
-                    "{\"unixStartTime\": \"%lld\"}", currentTime);
-        }
+        status = writeJsonBody(reqPtr, "unixStartTime", getTime(), funcNameStr);
     }
     else
     {
@@ -275,19 +264,7 @@ bool parseAccessCode(requestBodyData *reqPtr)
 
     if(getTimeBool())
     {
-        reqPtr->jsonStrLen = DEF_CODE_LEN + 1;
-        reqPtr->jsonStr = (char*) malloc(sizeof(char) * (reqPtr->jsonStrLen));
-
-        if(reqPtr->jsonStr == NULL)
-        {
-            ESP_LOGE(TAG, "%s %s%s", funcNameStr, mallocFail, rtrnNewLine);
-            status = false;
-        }
-        else
-        {
-            snprintf(reqPtr->jsonStr, reqPtr->jsonStrLen, "{\"accessCode\": \"%ld\"}", \
-                    getAccessCode());
-        }
+        status = writeJsonBody(reqPtr, "accessCode", getAccessCode(), funcNameStr);
     }
     else
     {
@@ -300,6 +277,55 @@ bool parseAccessCode(requestBodyData *reqPtr)
 
 
 
+/* The writeJsonBody() function fills in the body shared by the reservation
+** and access code requests, an object holding a single name/value pair whose
+** value is the number sent as a string. The body is written in one pass
+** straight into its final allocation, with the key and value escaped by cJSON.
+**
+** Parameters:
+**  reqPtr - pointer to the requestBodyData struct in dynamic memory
+**  keyStr - name of the single member of the body
+**  value - number to send as the value
+**  funcNameStr - name of the calling function for logging
+**
+** Return:
+**  A Boolean on the status of memory allocation and writing success
+*/
+static bool writeJsonBody(requestBodyData *reqPtr, const char *keyStr, int64_t value, \
+                            const char *funcNameStr)
+{
+    cJSON_Writer writer;
+    size_t bodyLen = 0;
+
+    reqPtr->jsonStr = (char*) malloc(sizeof(char) * BODY_SZ);
+
+    if(reqPtr->jsonStr == NULL)
+    {
+        ESP_LOGE(TAG, "%s %s%s", funcNameStr, mallocFail, rtrnNewLine);
+        return false;
+    }
+
+    cJSON_WriterInit(&writer, reqPtr->jsonStr, BODY_SZ);
+    cJSON_WriteBeginObject(&writer);
+    cJSON_WriteKey(&writer, keyStr);
+    cJSON_WriteInt64String(&writer, value);
+    cJSON_WriteEndObject(&writer);
+
+    if(!(bodyLen = cJSON_WriterFinish(&writer)))
+    { /* Only Reachable if BODY_SZ is Made Too Small for keyStr */
+        ESP_LOGE(TAG, "%s body too large%s", funcNameStr, rtrnNewLine);
+        free(reqPtr->jsonStr);
+        reqPtr->jsonStr = NULL;
+        return false;
+    }
+
+    reqPtr->jsonStrLen = bodyLen + 1;
+
+    return true;
+}
+
+
+
 /* The queuingParseData() function is used to queue the ID value parsed used to determine
 ** the type of POST Request data to begin preparing. Like all other queuing functions, 
 ** this one uses a Counting Semaphore to guard against queue overflow in addition to 
@@ -395,6 +421,38 @@ bool urlToString(requestBodyData *reqPtr)
 
 
 
+/* The batchUrlToString() function allocates and creates the string
+** that will be used as the URL for a batch HTTP POST Request, which
+** carries the bodies of several requests at once.
+**
+** Parameters:
+**  none
+**
+** Return:
+**  A pointer to the URL string, or NULL if memory allocation failed
+**
+** Notes: The caller owns the string. xHttpTask() makes it once and keeps
+** it, since the URL never changes while running.
+*/
+char *batchUrlToString(void)
+{
+    size_t urlLen = (snprintf(NULL, 0, "%s%s", URL, batchPath)) + 1;
+    char *urlStr = (char*) malloc(sizeof(char) * urlLen);
+
+    if(urlStr == NULL)
+    {
+        ESP_LOGE(TAG, "Batch URL %s%s", mallocFail, rtrnNewLine);
+    }
+    else
+    {
+        snprintf(urlStr, urlLen, "%s%s", URL, batchPath);
+    }
+
+    return urlStr;
+}
+
+
+
 /* The mallocCleanup() function is used to cleanup up each of the dynamically
 ** allocated piece within the typedef struct requestBodyData and the struct 
 ** itself. The value of the heap (i.e., how much has been allocated
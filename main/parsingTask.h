@@ -46,6 +46,7 @@ extern void startParsingConfig(void);
 extern void mallocCleanup(requestBodyData *reqPtr, int8_t mallocCnt);
 extern void queuingParseData(uint8_t idVal);
 extern void giveSemHttpGuard(void);
+extern char *batchUrlToString(void);
 
 /* FreeRTOS Declared API Handles */
 extern QueueHandle_t xQueueHttp;
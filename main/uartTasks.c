@@ -40,9 +40,6 @@
 #include "uartTasks.h"
 #include "ledTask.h"
 
-/* Other Headers */
-#include "cJSON.h"
-
 
 
 /* Variable Naming Abbreviations Legend:
@@ -81,6 +78,8 @@
 
 #define MICRO_SEC_FACTOR 1000000
 
+#define RSV_FIELDS (NAME_FIELD | START_FIELD | END_FIELD) /* Reservation Info Fields */
+
 /* Enum for Local Constant String Sizes */
 typedef enum
 {
@@ -96,9 +95,9 @@ static void xUartRxTask(void *pvParameters);
 static void xUartTxTask(void *pvParameters);
 static void setAccessCode(char *buffer);
 static void setTimeBool(bool localTimeSetBool);
-static void setTime(int serverTime);
+static void setTime(time_t serverTime);
 static void uartRxWorkHndlr(void);
-static char* reserveTimesHndlr(cJSON *reserveTime);
+static char* reserveTimesHndlr(time_t rsvTime);
 static bool espnowMtxHndlr(void);
 static void startUartRtosConfig(void);
 static printingFunc printTime;
@@ -215,7 +214,7 @@ static void startUartRtosConfig(void)
 ** The '\r' acts as the trailing byte.
 **
 ** Parameters:
-**  responsePtr - pointer to the dynamically allocated cJSON object
+**  respPtr - pointer to the decoded response struct
 **
 ** Return:
 **  A pointer to the dynamically allocated time string to be sent via UART
@@ -223,13 +222,12 @@ static void startUartRtosConfig(void)
 ** Notes: Since the system time will only be reset once every twenty-four hours, we also
 ** call the setTime() function in this function.
 */
-char* printTime(cJSON *responsePtr)
+char* printTime(const respData *respPtr)
 {
     char *timeStr = NULL;
     size_t timeStrLen = TIME_LEN; 
-    cJSON *serverTimePtr = cJSON_GetObjectItemCaseSensitive(responsePtr, "serverTime");
 
-    setTime(serverTimePtr->valueint);
+    setTime((time_t) respPtr->serverTime);
     time_t currentTime = getTime();
     struct tm *timePtr = localtime(&currentTime); /* time.h based struct tm */
     
@@ -259,18 +257,17 @@ char* printTime(cJSON *responsePtr)
 ** success or a failure ('3' being success and '4' being failure).
 **
 ** Parameters:
-**  responsePtr - pointer to the dynamically allocated cJSON object
+**  respPtr - pointer to the decoded response struct
 **
 ** Return:
 **  A pointer to the dynamically allocated acces code validation string to be sent via UART
 */
-char* printValid(cJSON *responsePtr)
+char* printValid(const respData *respPtr)
 {
     char *validStr = NULL;
     char *placehldr = NULL;
-    cJSON *responseCode = cJSON_GetObjectItemCaseSensitive(responsePtr, "responseCode");
 
-    placehldr = ((responseCode->valueint) == VALID_RESP) ? "23\r" : "24\r";
+    placehldr = ((respPtr->responseCode) == VALID_RESP) ? "23\r" : "24\r";
 
     validStr = (char*) malloc(sizeof(char) * (strlen(placehldr) + 1));
     if(validStr != NULL)
@@ -296,33 +293,22 @@ char* printValid(cJSON *responsePtr)
 ** print functions.
 **
 ** Parameters:
-**  responsePtr - pointer to the dynamically allocated cJSON object
+**  respPtr - pointer to the decoded response struct
 **
 ** Return:
 **  A pointer to the dynamically allocated reservation text string to be sent via UART
 ** 
-** Notes: If there is no reservation at the time, a default piece of text (handled within
-** the first if statement) is sent instead. Also, if there is no reservation, the reservation
+** Notes: If there is no reservation at the time (any of the name, start time, or end time
+** fields missing), a default piece of text (handled within the first if statement) is sent instead. Also, if there is no reservation, the reservation
 ** info timer will continue to time out every minute until a reservation (that is occurring currently)
 ** has been placed. Otherwise, the timer will not timeout until the end of the current reservation.
 */
-char* printReserve(cJSON *responsePtr)
+char* printReserve(const respData *respPtr)
 {
     size_t reserveStrLen = NO_RSV_LEN;
     char *reserveStr = NULL;
 
-    cJSON * namePtr = cJSON_GetObjectItemCaseSensitive(responsePtr, \
-                                                        "firstName");
-
-    cJSON *startTimeJsonPtr = cJSON_GetObjectItemCaseSensitive(responsePtr, \
-                                                                "unixStartTime");
-
-    cJSON *endTimeJsonPtr = cJSON_GetObjectItemCaseSensitive(responsePtr, \
-                                                                "unixEndTime");
-
-    if(!(cJSON_IsNumber(startTimeJsonPtr)) && \
-        !(cJSON_IsNumber(endTimeJsonPtr)) && \
-        !(cJSON_IsString(namePtr)))
+    if((respPtr->fieldsFound & RSV_FIELDS) != RSV_FIELDS)
     {
         reserveStr = (char*) malloc(sizeof(char) * (reserveStrLen));
         if(reserveStr != NULL)
@@ -338,14 +324,14 @@ char* printReserve(cJSON *responsePtr)
 
     char *startTimeStr = NULL;
     char *endTimeStr = NULL;
-    startTimeStr = reserveTimesHndlr(startTimeJsonPtr);
+    startTimeStr = reserveTimesHndlr((time_t) respPtr->unixStartTime);
 
     if(startTimeStr == NULL)
     {
         return reserveStr;
     }
 
-    endTimeStr = reserveTimesHndlr(endTimeJsonPtr);
+    endTimeStr = reserveTimesHndlr((time_t) respPtr->unixEndTime);
 
     if(endTimeStr == NULL)
     {
@@ -355,17 +341,17 @@ char* printReserve(cJSON *responsePtr)
 
     /* Doing this to ensure sufficient space is allocated for strings */
     reserveStrLen = snprintf(NULL, 0, "1Reserved:\n%s%9s\n%s to %s\r", \
-                            namePtr->valuestring, "", startTimeStr, endTimeStr);
+                            respPtr->firstName, "", startTimeStr, endTimeStr);
 
     reserveStr = (char*) malloc(sizeof(char) * (reserveStrLen + 1));
 
     if(reserveStr != NULL)
     {
         snprintf(reserveStr, reserveStrLen + 1, "1Reserved:\n%s%9s\n%s to %s\r", \
-                namePtr->valuestring, "", startTimeStr, endTimeStr);
+                respPtr->firstName, "", startTimeStr, endTimeStr);
         
         /* Cause a timeout at the end of the current reservation */
-        uint64_t nextRsvTime = ((endTimeJsonPtr->valueint) - time(NULL)) * MICRO_SEC_FACTOR;
+        uint64_t nextRsvTime = (respPtr->unixEndTime - time(NULL)) * MICRO_SEC_FACTOR;
         timerRestart(RSV_ID, nextRsvTime);
     }
     else
@@ -415,16 +401,15 @@ static void uartRxWorkHndlr(void)
 ** e.g., 8:45AM. 
 **
 ** Parameters:
-**  reserveTime - a pointer to the unix time value stored in the cJSON object
+**  rsvTime - the unix time value from the decoded response struct
 **
 ** Return:
 **  A pointer to a dynamically allocated string of the 12-hour clock time representation
 */
-static char* reserveTimesHndlr(cJSON *reserveTime)
+static char* reserveTimesHndlr(time_t rsvTime)
 {
     size_t timeStrLen = RSV_TIME_LEN;
     char *reserveTimeStr = NULL;
-    time_t rsvTime = reserveTime->valueint;
 
     reserveTimeStr = (char*) malloc(sizeof(char) * (timeStrLen));
 
@@ -635,17 +620,17 @@ time_t getTime(void)
 ** value.
 **
 ** Parameters:
-**  serverTime - an integer value holding the UNIX server time
+**  serverTime - a time_t value holding the UNIX server time
 **
 ** Return:
 **  none
 ** 
-** Notes: Using basic type since cJSON object only specifies
-** an integer type and nothing more.
+** Notes: The value comes from the 64-bit serverTime field of the
+** decoded response so times past 2038 are not truncated.
 */
-static void setTime(int serverTime)
+static void setTime(time_t serverTime)
 {
-    struct timeval tv = {(time_t) serverTime, 0};
+    struct timeval tv = {serverTime, 0};
 
     settimeofday(&tv, 0);
     setTimeBool(true);
@@ -716,7 +701,7 @@ static void xUartRxTask(void *pvParameters)
 
 
 /* The xUartTxTask() function is used to handle sending data via UART TX events. Once
-** data is received on xQueueUartTx Queue, the ID of the cJSON object passed is used
+** data is received on xQueueUartTx Queue, the ID of the response struct passed is used
 ** to index a state array to its targeted function. This returns a pointer to char
 ** that is then sent to the touchscreen via UART. If the value is an access code
 ** and is also valid, communication via ESP-NOW will be attempted (won't be possible
@@ -732,14 +717,12 @@ static void xUartTxTask(void *pvParameters)
 {
     while(true)
     {
-        cJSON *responsePtr = NULL;
+        respData response;
 
-        xQueueReceive(xQueueUartTx, (void*) &responsePtr, portMAX_DELAY);
+        xQueueReceive(xQueueUartTx, (void*) &response, portMAX_DELAY);
         giveSemUartTxGuard();
 
-        cJSON *responseID = cJSON_GetObjectItemCaseSensitive(responsePtr, "id");
-
-        char *toTxBuf = respPrintFuncs[responseID->valueint](responsePtr);
+        char *toTxBuf = respPrintFuncs[response.id](&response);
         if(toTxBuf != NULL)
         {
             ESP_LOGI(TAG2, "UART MSG: %s", toTxBuf);
@@ -747,15 +730,11 @@ static void xUartTxTask(void *pvParameters)
 
             free(toTxBuf);
 
-            cJSON *responseCode = cJSON_GetObjectItemCaseSensitive(responsePtr, \
-                                                                    "responseCode");
-
-            if((responseID->valueint == CODE_ID) && \
-                (responseCode->valueint == VALID_RESP))
+            if((response.id == CODE_ID) && \
+                (response.responseCode == VALID_RESP))
             {
                 espnowMtxHndlr();
             }
         }
-        cJSON_Delete(responsePtr);
     }
 }
\ No newline at end of file
@@ -27,8 +27,8 @@
 #include "driver/uart.h"
 #include "driver/gpio.h"
 
-/* Other Headers */
-#include "cJSON.h"
+/* Local Headers */
+#include "httpTask.h"
 
 
 
@@ -42,7 +42,7 @@ extern int32_t getAccessCode(void);
 extern time_t getTime(void);
 
 /* Typedefs for Pointer to Function and Function */
-typedef char* (*printingFuncPtr)(cJSON *responsePtr);
-typedef char* (printingFunc)(cJSON *responsePtr);
+typedef char* (*printingFuncPtr)(const respData *respPtr);
+typedef char* (printingFunc)(const respData *respPtr);
 
 #endif /* UARTTASKS_H_ */
\ No newline at end of file
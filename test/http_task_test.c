@@ -0,0 +1,871 @@
+/*
+  Host test of the HTTP task (main/httpTask.c) against stubbed ESP-IDF.
+
+  httpTask.c is included whole so its static state can be reset and
+  looked at between scenarios. The headers under stub/ stand in for
+  ESP-IDF and FreeRTOS, and this file implements them: a clock that
+  only moves when the task waits or a request goes out, xQueueHttp
+  handing out scripted requests at their time, xQueueUartTx collecting
+  the decoded responses, and esp_http_client talking to a stand-in
+  server. The server answers like the Django views would, emits the
+  events the real client does (connect, headers sent, headers, data in
+  chunks, finish) and keeps count of sockets, so the tests can tell a
+  reused keep-alive connection from a new one. xHttpTask never
+  returns, so the queue leaves it with a longjmp once the script is
+  played out and no retry is waiting.
+
+  Scenarios:
+  - keep_alive: requests spread out in time all go over one client and
+    one connection, each with its own URL and body
+  - server_closes: a server that closes the connection after every
+    answer costs a new connection per request, still on the one client
+  - stale_connection: a connection that died without notice fails one
+    attempt, the client closes it and the retry connects again
+  - batch: requests queued together go out as one batch POST, and its
+    answer (split across data events) reaches the UART queue as the
+    responses to each of them
+  - batch_skipped: a request the server left out of its batch answer
+    is given up on and its timer restarted
+  - batch_unsupported: a 404 to the batch POST has its requests, and
+    every one after them, sent one by one
+  - backoff_jitter: the wait before a retry lands in the upper half of
+    its backoff, both when the backoff is zero and at its largest
+  - batch_deadline: the deadlines of batched requests count from when
+    they were dequeued, so a slow failed batch can use one up
+  - batch_validators: a batch answer clears the stored ETag of the
+    reservation poll, so the poll after it isn't answered with a 304
+
+  usage: http_task_test [-v]    (-v prints the task's log)
+*/
+
+#include <setjmp.h>
+
+#include "../main/httpTask.c"
+
+#define MAX_ARRIVALS 8
+#define MAX_ANSWERS 16
+#define ANSWER_SZ 1024
+#define URL_SZ 64
+
+int stub_log_enabled = 0;
+
+/* definitions of what the other tasks and main.c would provide */
+QueueHandle_t xQueueHttp;
+const char mallocFail[MALLOC_LEN] = "Malloc failed";
+const char heapFail[HEAP_LEN] = "Insufficient heap space for";
+const char rtrnNewLine[NEWLINE_LEN] = "\r\n";
+const char queueSendFail[SEND_FAIL_LEN] = "Could not send to ";
+const char queueFullFail[FULL_FAIL_LEN] = " is full";
+
+/* simulated clock */
+static int64_t now_us;
+
+/* a request handed out by xQueueHttp once the clock reaches its time */
+typedef struct
+{
+    int64_t at_us;
+    uint8_t id;
+} arrival;
+
+static arrival arrivals[MAX_ARRIVALS];
+static size_t arrival_count;
+static size_t next_arrival;
+static jmp_buf script_done;
+static int requests_live;
+
+/* the stand-in server and what it saw */
+typedef struct
+{
+    int64_t latency_us; /* a round trip, added to the clock by every perform */
+    bool close_after_answer; /* answers with Connection: close */
+    int stale_after; /* the socket dies without notice after this many answers, 0 never */
+    size_t chunk; /* body bytes per data event, 0 for one event */
+    bool no_batch; /* answers batch/ with a 404 page like a server without it */
+    unsigned int batch_skip; /* bits of the request IDs left out of batch answers */
+    const char *etag; /* sent with reserve/ answers, a matching If-None-Match gets a 304 */
+    int not_modified;
+    int answers;
+    int connects;
+    int performs;
+    int failures;
+    char urls[MAX_ANSWERS][URL_SZ];
+} stand_in_server;
+
+static stand_in_server server;
+
+struct esp_http_client
+{
+    http_event_handle_cb handler;
+    char url[URL_SZ];
+    const char *body;
+    int body_len;
+    bool connected;
+    bool stale;
+    char if_none_match[ETAG_LEN];
+    int status;
+    int64_t content_length;
+};
+
+static int client_inits;
+static int client_cleanups;
+static esp_http_client_handle_t last_client; /* xHttpTask never lets go of its client, reset() does */
+
+/* responses the task put on xQueueUartTx */
+static respData uart[MAX_ANSWERS];
+static size_t uart_count;
+
+/* timers restarted by the task, indexed by request ID */
+static int timer_restarts[POST_STATE_SZ];
+
+/* esp_random() hands out random_value when random_scripted is set */
+static bool random_scripted;
+static uint32_t random_value;
+
+static int failures;
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+static void check(int passed, const char *what, int line)
+{
+    if (!passed)
+    {
+        fprintf(stderr, "check failed at line %d: %s\n", line, what);
+        failures++;
+    }
+}
+
+/* ESP-IDF */
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    return (code == ESP_OK) ? "ESP_OK" : "ESP_ERR";
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return now_us;
+}
+
+uint32_t esp_random(void)
+{
+    static uint32_t state = 2463534242UL;
+
+    if (random_scripted)
+    {
+        return random_value;
+    }
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+    /* the handle is the timerArgsStruct of the timer, which knows its request ID */
+    *out_handle = (esp_timer_handle_t)create_args->arg;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    (void)timer;
+    (void)timeout_us;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_restart(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    const timerArgsStruct *args = (const timerArgsStruct*)(void*)timer;
+
+    (void)timeout_us;
+    if ((args != NULL) && (args->timerNum < POST_STATE_SZ))
+    {
+        timer_restarts[args->timerNum]++;
+    }
+    return ESP_OK;
+}
+
+/* FreeRTOS */
+
+static struct queue_stub
+{
+    int unused;
+} http_queue, uart_queue;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    (void)length;
+    return (item_size == sizeof(respData)) ? &uart_queue : &http_queue;
+}
+
+/* a request as the xParsingTask would have queued it */
+static requestBodyData *make_request(uint8_t id)
+{
+    static const char * const paths[POST_STATE_SZ] = { "time/", "reserve/", "value/" };
+    static const char * const bodies[POST_STATE_SZ] = { "{\"unixTime\":0}", "{\"room\":214}", "{\"accessCode\":123456}" };
+    requestBodyData *request = (requestBodyData*)calloc(1, sizeof(requestBodyData));
+
+    if (request == NULL)
+    {
+        return NULL;
+    }
+    request->id = id;
+    request->urlLen = strlen("http://stand-in/") + strlen(paths[id]) + 1;
+    request->url = (char*)malloc(request->urlLen);
+    request->jsonStr = strdup(bodies[id]);
+    if ((request->url == NULL) || (request->jsonStr == NULL))
+    {
+        free(request->url);
+        free(request->jsonStr);
+        free(request);
+        return NULL;
+    }
+    snprintf(request->url, request->urlLen, "http://stand-in/%s", paths[id]);
+    request->jsonStrLen = strlen(request->jsonStr) + 1;
+    requests_live++;
+
+    return request;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks_to_wait)
+{
+    (void)queue;
+
+    if ((next_arrival >= arrival_count) || (arrivals[next_arrival].at_us > now_us))
+    {
+        if (ticks_to_wait == 0)
+        {
+            return pdFALSE;
+        }
+        if (ticks_to_wait == portMAX_DELAY)
+        {
+            if (next_arrival >= arrival_count)
+            {
+                longjmp(script_done, 1);
+            }
+            now_us = arrivals[next_arrival].at_us;
+        }
+        else
+        {
+            int64_t until = now_us + ((int64_t)ticks_to_wait * (1000000 / configTICK_RATE_HZ));
+
+            if ((next_arrival >= arrival_count) || (arrivals[next_arrival].at_us > until))
+            {
+                now_us = until;
+                return pdFALSE;
+            }
+            now_us = arrivals[next_arrival].at_us;
+        }
+    }
+
+    *(requestBodyData**)item = make_request(arrivals[next_arrival++].id);
+    return pdTRUE;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait)
+{
+    (void)ticks_to_wait;
+    if ((queue != &uart_queue) || (uart_count >= MAX_ANSWERS))
+    {
+        return pdFALSE;
+    }
+    uart[uart_count++] = *(const respData*)item;
+    return pdTRUE;
+}
+
+static struct semaphore_stub
+{
+    int unused;
+} semaphore;
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count)
+{
+    (void)max_count;
+    (void)initial_count;
+    return &semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait)
+{
+    (void)semaphore;
+    (void)ticks_to_wait;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    (void)semaphore;
+    return pdTRUE;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stack_depth, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *created_task, BaseType_t core_id)
+{
+    /* the scenarios run xHttpTask themselves */
+    (void)task;
+    (void)name;
+    (void)stack_depth;
+    (void)parameters;
+    (void)priority;
+    (void)created_task;
+    (void)core_id;
+    return pdTRUE;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    (void)task;
+    return 0;
+}
+
+/* the other tasks */
+
+void giveSemHttpGuard(void)
+{
+}
+
+void mallocCleanup(requestBodyData *reqPtr, int8_t mallocCnt)
+{
+    (void)mallocCnt;
+    free(reqPtr->url);
+    free(reqPtr->jsonStr);
+    free(reqPtr);
+    requests_live--;
+}
+
+char *batchUrlToString(void)
+{
+    return strdup("http://stand-in/batch/");
+}
+
+void queuingParseData(uint8_t idVal)
+{
+    (void)idVal;
+}
+
+UBaseType_t wifiCheckStatus(void)
+{
+    return 0;
+}
+
+/* the stand-in server */
+
+static void emit(esp_http_client_handle_t client, esp_http_client_event_id_t id, const char *data, int data_len,
+                 const char *key, const char *value)
+{
+    esp_http_client_event_t event;
+
+    memset(&event, 0, sizeof(event));
+    event.event_id = id;
+    event.client = client;
+    event.data = (void*)(uintptr_t)data;
+    event.data_len = data_len;
+    event.header_key = (char*)(uintptr_t)key;
+    event.header_value = (char*)(uintptr_t)value;
+    client->handler(&event);
+}
+
+static int answer_request(const char *path, const char *body, int body_len, char *answer, size_t size);
+
+/* a batch answer, an {"id", "body"} entry per request with the answer it would have had alone */
+static int answer_batch(const char *body, int body_len, char *answer, size_t size)
+{
+    static const char * const paths[POST_STATE_SZ] = { "time/", "reserve/", "value/" };
+    cJSON *batch = cJSON_ParseWithLength(body, (size_t)body_len);
+    const cJSON *entry = NULL;
+    int length = snprintf(answer, size, "[");
+
+    if (!cJSON_IsArray(batch))
+    {
+        cJSON_Delete(batch);
+        return -1;
+    }
+    cJSON_ArrayForEach(entry, batch)
+    {
+        const cJSON *id = cJSON_GetObjectItemCaseSensitive(entry, "id");
+        char single[ANSWER_SZ];
+
+        if (!cJSON_IsNumber(id) || (id->valueint < 0) || (id->valueint >= POST_STATE_SZ)
+            || (server.batch_skip & (1U << id->valueint)))
+        {
+            continue;
+        }
+        if ((answer_request(paths[id->valueint], NULL, 0, single, sizeof(single)) < 0) || ((size_t)length >= size))
+        {
+            length = -1;
+            break;
+        }
+        length += snprintf(answer + length, size - (size_t)length, "%s{\"id\": %d, \"body\": %s}", (length > 1) ? ", " : "", id->valueint, single);
+    }
+    cJSON_Delete(batch);
+
+    return ((length < 0) || ((size_t)length >= size)) ? -1 : (length + snprintf(answer + length, size - (size_t)length, "]"));
+}
+
+/* the answer of the Django views to a request, the response code says it went through */
+static int answer_request(const char *path, const char *body, int body_len, char *answer, size_t size)
+{
+    if ((strcmp(path, "batch/") == 0) && !server.no_batch)
+    {
+        return answer_batch(body, body_len, answer, size);
+    }
+    if (strcmp(path, "time/") == 0)
+    {
+        return snprintf(answer, size, "{\"id\": 0, \"responseCode\": 1, \"serverTime\": %lld}", (long long)(1712347200 + (now_us / 1000000)));
+    }
+    if (strcmp(path, "reserve/") == 0)
+    {
+        return snprintf(answer, size, "{\"id\": 1, \"responseCode\": 1, \"firstName\": \"Ann\", \"unixStartTime\": 1712347200, \"unixEndTime\": 1712350800}");
+    }
+    if (strcmp(path, "value/") == 0)
+    {
+        return snprintf(answer, size, "{\"id\": 2, \"responseCode\": 1}");
+    }
+    return -1;
+}
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config)
+{
+    esp_http_client_handle_t client = (esp_http_client_handle_t)calloc(1, sizeof(struct esp_http_client));
+
+    if (client != NULL)
+    {
+        client->handler = config->event_handler;
+        snprintf(client->url, sizeof(client->url), "%s", config->url);
+        client_inits++;
+        free(last_client);
+        last_client = client;
+    }
+    return client;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client)
+{
+    if (client == last_client)
+    {
+        last_client = NULL;
+    }
+    free(client);
+    client_cleanups++;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char *url)
+{
+    snprintf(client->url, sizeof(client->url), "%s", url);
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_post_field(esp_http_client_handle_t client, const char *data, int len)
+{
+    client->body = data;
+    client->body_len = len;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char *key, const char *value)
+{
+    if (strcmp(key, "If-None-Match") == 0)
+    {
+        snprintf(client->if_none_match, sizeof(client->if_none_match), "%s", value);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_delete_header(esp_http_client_handle_t client, const char *key)
+{
+    if (strcmp(key, "If-None-Match") == 0)
+    {
+        client->if_none_match[0] = '\0';
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_close(esp_http_client_handle_t client)
+{
+    client->connected = false;
+    client->stale = false;
+    return ESP_OK;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t client)
+{
+    return client->status;
+}
+
+int64_t esp_http_client_get_content_length(esp_http_client_handle_t client)
+{
+    return client->content_length;
+}
+
+bool esp_http_client_is_chunked_response(esp_http_client_handle_t client)
+{
+    (void)client;
+    return false;
+}
+
+esp_err_t esp_http_client_perform(esp_http_client_handle_t client)
+{
+    const char *path = strstr(client->url, "://");
+    char answer[ANSWER_SZ];
+    int length = 0;
+    int offset = 0;
+
+    path = (path != NULL) ? strchr(path + 3, '/') : NULL;
+    path = (path != NULL) ? path + 1 : client->url;
+    now_us += server.latency_us;
+    server.performs++;
+
+    if (client->stale)
+    {
+        /* the request goes out on a socket the server already let go of */
+        server.failures++;
+        emit(client, HTTP_EVENT_ERROR, NULL, 0, NULL, NULL);
+        return ESP_ERR_HTTP_FETCH_HEADER;
+    }
+    if (!client->connected)
+    {
+        client->connected = true;
+        server.connects++;
+        emit(client, HTTP_EVENT_ON_CONNECTED, NULL, 0, NULL, NULL);
+    }
+    emit(client, HTTP_EVENT_HEADERS_SENT, NULL, 0, NULL, NULL);
+
+    if (server.answers < MAX_ANSWERS)
+    {
+        snprintf(server.urls[server.answers], URL_SZ, "%s", path);
+    }
+    server.answers++;
+    length = answer_request(path, client->body, client->body_len, answer, sizeof(answer));
+    if ((length < 0) || ((size_t)length >= sizeof(answer)))
+    {
+        client->status = 404;
+        client->content_length = 0;
+    }
+    else if ((server.etag != NULL) && (strcmp(path, "reserve/") == 0) && (strcmp(client->if_none_match, server.etag) == 0))
+    {
+        client->status = 304;
+        client->content_length = 0;
+        server.not_modified++;
+    }
+    else
+    {
+        client->status = 200;
+        client->content_length = length;
+        emit(client, HTTP_EVENT_ON_HEADER, NULL, 0, "Content-Type", "application/json");
+        if ((server.etag != NULL) && (strcmp(path, "reserve/") == 0))
+        {
+            emit(client, HTTP_EVENT_ON_HEADER, NULL, 0, "ETag", server.etag);
+        }
+        for (offset = 0; offset < length; offset += (server.chunk > 0) ? (int)server.chunk : length)
+        {
+            int chunk = ((server.chunk > 0) && ((size_t)(length - offset) > server.chunk)) ? (int)server.chunk : (length - offset);
+            emit(client, HTTP_EVENT_ON_DATA, answer + offset, chunk, NULL, NULL);
+        }
+    }
+    emit(client, HTTP_EVENT_ON_FINISH, NULL, 0, NULL, NULL);
+
+    if (server.close_after_answer)
+    {
+        client->connected = false;
+        emit(client, HTTP_EVENT_DISCONNECTED, NULL, 0, NULL, NULL);
+    }
+    else if ((server.stale_after > 0) && (server.answers == server.stale_after))
+    {
+        client->stale = true;
+    }
+
+    return ESP_OK;
+}
+
+/* scenarios */
+
+/* forget what the last scenario left behind, in the task as well as here */
+static void reset(void)
+{
+    memset(&server, 0, sizeof(server));
+    server.latency_us = 40000;
+    memset(arrivals, 0, sizeof(arrivals));
+    arrival_count = 0;
+    next_arrival = 0;
+    now_us = 0;
+    client_inits = 0;
+    client_cleanups = 0;
+    uart_count = 0;
+    free(last_client);
+    last_client = NULL;
+    memset(timer_restarts, 0, sizeof(timer_restarts));
+    random_scripted = false;
+
+    memset(retryArr, 0, sizeof(retryArr));
+    memset(retryStatsArr, 0, sizeof(retryStatsArr));
+    memset(condArr, 0, sizeof(condArr));
+    batchSupported = true;
+    free(batchUrl);
+    batchUrl = NULL;
+}
+
+static void arrive(int64_t at_ms, uint8_t id)
+{
+    arrivals[arrival_count].at_us = at_ms * 1000;
+    arrivals[arrival_count].id = id;
+    arrival_count++;
+}
+
+/* play the script through xHttpTask */
+static void run_task(void)
+{
+    if (!setjmp(script_done))
+    {
+        xHttpTask(NULL);
+    }
+}
+
+static void keep_alive(void)
+{
+    reset();
+    arrive(0, TIME_ID);
+    arrive(1000, RSV_ID);
+    arrive(2000, CODE_ID);
+    run_task();
+
+    CHECK(client_inits == 1);
+    CHECK(client_cleanups == 0);
+    CHECK(server.connects == 1);
+    CHECK(server.performs == 3);
+    CHECK(strcmp(server.urls[0], "time/") == 0);
+    CHECK(strcmp(server.urls[1], "reserve/") == 0);
+    CHECK(strcmp(server.urls[2], "value/") == 0);
+    CHECK(uart_count == 3);
+    CHECK((uart[0].id == TIME_ID) && (uart[0].serverTime == 1712347200));
+    CHECK((uart[1].id == RSV_ID) && (strcmp(uart[1].firstName, "Ann") == 0));
+    CHECK((uart[2].id == CODE_ID) && (uart[2].responseCode == VALID_RESP));
+    CHECK(requests_live == 0);
+}
+
+static void server_closes(void)
+{
+    reset();
+    server.close_after_answer = true;
+    server.chunk = 16; /* bodies split across segments take the respBuf path */
+    arrive(0, CODE_ID);
+    arrive(1000, CODE_ID);
+    arrive(2000, RSV_ID);
+    run_task();
+
+    CHECK(client_inits == 1);
+    CHECK(server.connects == 3);
+    CHECK(server.performs == 3);
+    CHECK(uart_count == 3);
+    CHECK((uart[2].id == RSV_ID) && (uart[2].unixEndTime == 1712350800));
+    CHECK(requests_live == 0);
+}
+
+static void stale_connection(void)
+{
+    reset();
+    server.stale_after = 1;
+    arrive(0, CODE_ID);
+    arrive(5000, CODE_ID);
+    run_task();
+
+    CHECK(client_inits == 1);
+    CHECK(server.failures == 1);
+    CHECK(server.connects == 2);
+    CHECK(server.performs == 3);
+    CHECK(uart_count == 2);
+    CHECK(retryStatsArr[CODE_ID].retries == 1);
+    CHECK(retryStatsArr[CODE_ID].successes == 2);
+    CHECK(timer_restarts[CODE_ID] == 0);
+    CHECK(requests_live == 0);
+}
+
+static void batch(void)
+{
+    reset();
+    server.chunk = 64;
+    arrive(0, TIME_ID);
+    arrive(0, RSV_ID);
+    arrive(0, CODE_ID);
+    arrive(1000, CODE_ID);
+    run_task();
+
+    CHECK(server.performs == 2);
+    CHECK(strcmp(server.urls[0], "batch/") == 0);
+    CHECK(strcmp(server.urls[1], "value/") == 0);
+    CHECK(uart_count == 4);
+    CHECK((uart[0].id == TIME_ID) && (uart[0].serverTime == 1712347200));
+    CHECK((uart[1].id == RSV_ID) && (strcmp(uart[1].firstName, "Ann") == 0) && (uart[1].unixStartTime == 1712347200));
+    CHECK((uart[2].id == CODE_ID) && (uart[2].responseCode == VALID_RESP));
+    CHECK(uart[3].id == CODE_ID);
+    CHECK(batchSupported);
+    CHECK(batchPending == 0);
+    CHECK((timer_restarts[TIME_ID] == 0) && (timer_restarts[RSV_ID] == 0));
+    CHECK(requests_live == 0);
+}
+
+static void batch_skipped(void)
+{
+    reset();
+    server.batch_skip = 1U << RSV_ID;
+    arrive(0, TIME_ID);
+    arrive(0, RSV_ID);
+    run_task();
+
+    CHECK(server.performs == 1);
+    CHECK(uart_count == 1);
+    CHECK(uart[0].id == TIME_ID);
+    CHECK(retryStatsArr[RSV_ID].rejected == 1);
+    CHECK(timer_restarts[RSV_ID] == 1);
+    CHECK(timer_restarts[TIME_ID] == 0);
+    CHECK(requests_live == 0);
+}
+
+static void batch_unsupported(void)
+{
+    reset();
+    server.no_batch = true;
+    arrive(0, TIME_ID);
+    arrive(0, CODE_ID);
+    arrive(1000, RSV_ID);
+    arrive(1000, CODE_ID);
+    run_task();
+
+    CHECK(!batchSupported);
+    CHECK(server.performs == 5);
+    CHECK(strcmp(server.urls[0], "batch/") == 0);
+    CHECK(strcmp(server.urls[1], "time/") == 0);
+    CHECK(strcmp(server.urls[2], "value/") == 0);
+    CHECK(strcmp(server.urls[3], "reserve/") == 0);
+    CHECK(strcmp(server.urls[4], "value/") == 0);
+    CHECK(uart_count == 4);
+    CHECK((uart[0].id == TIME_ID) && (uart[1].id == CODE_ID) && (uart[2].id == RSV_ID) && (uart[3].id == CODE_ID));
+    CHECK(requests_live == 0);
+}
+
+/* the due time retryBackoff() sets for a random value, in ms from now (-1 if it rules out a retry) */
+static int64_t backoff_with(const retryPolicy *policy, uint8_t attempts, uint32_t random, int64_t deadline_ms)
+{
+    retryEntry entry = {0};
+
+    entry.atmptCnt = attempts;
+    entry.deadline = now_us + (deadline_ms * 1000);
+    random_scripted = true;
+    random_value = random;
+
+    return retryBackoff(&entry, policy) ? ((entry.dueTime - now_us) / 1000) : -1;
+}
+
+static void backoff_jitter(void)
+{
+    static const retryPolicy none = {"none", 0, 0, 60000, MAX_ATMPT};
+    static const retryPolicy widest = {"widest", UINT32_MAX, UINT32_MAX, 60000, MAX_ATMPT};
+    const retryPolicy *code = &retryPolicies[CODE_ID];
+    const int64_t never = INT64_C(1) << 40; /* no deadline in the way (ms) */
+
+    reset();
+    now_us = 5000000;
+
+    /* a zero backoff has no jitter to add, whatever the random value */
+    CHECK(backoff_with(&none, 1, 0, never) == 0);
+    CHECK(backoff_with(&none, 1, UINT32_MAX, never) == 0);
+    CHECK(backoff_with(&none, MAX_ATMPT - 1, 12345, never) == 0);
+
+    /* past its doublings the access code backoff sits at its 400 ms cap, the wait is 200 to 400 ms */
+    CHECK(backoff_with(code, MAX_ATMPT - 1, 0, never) == 200);
+    CHECK(backoff_with(code, MAX_ATMPT - 1, 200, never) == 400);
+    CHECK(backoff_with(code, MAX_ATMPT - 1, 201, never) == 200);
+    CHECK(backoff_with(code, MAX_ATMPT - 1, UINT32_MAX, never) == 200 + (UINT32_MAX % 201));
+    CHECK(backoff_with(code, 1, UINT32_MAX, never) == 50 + (UINT32_MAX % 51));
+    CHECK(backoff_with(code, MAX_ATMPT, 0, never) == -1);
+
+    /* the largest backoff a policy can ask for doesn't wrap */
+    CHECK(backoff_with(&widest, 1, 0, never) == UINT32_MAX / 2);
+    CHECK(backoff_with(&widest, 1, UINT32_MAX, never) == (int64_t)UINT32_MAX - 1);
+
+    /* a wait that would run past the deadline rules the retry out */
+    CHECK(backoff_with(code, MAX_ATMPT - 1, 0, 300) == 200);
+    CHECK(backoff_with(code, MAX_ATMPT - 1, 200, 300) == -1);
+}
+
+static void batch_deadline(void)
+{
+    reset();
+    server.latency_us = 2100000;
+    server.stale_after = 1;
+    arrive(0, TIME_ID);
+    arrive(5000, TIME_ID);
+    arrive(5000, CODE_ID);
+    run_task();
+
+    /* the failed batch took longer than the access code's whole deadline */
+    CHECK(server.performs == 3);
+    CHECK(strcmp(server.urls[1], "time/") == 0);
+    CHECK(server.failures == 1);
+    CHECK(retryStatsArr[CODE_ID].expired == 1);
+    CHECK(retryStatsArr[CODE_ID].retries == 0);
+    CHECK(retryStatsArr[TIME_ID].retries == 1);
+    CHECK(uart_count == 2);
+    CHECK((uart[0].id == TIME_ID) && (uart[1].id == TIME_ID));
+    CHECK(requests_live == 0);
+}
+
+static void batch_validators(void)
+{
+    reset();
+    server.etag = "\"r1\"";
+    arrive(0, RSV_ID);
+    arrive(1000, RSV_ID);
+    arrive(2000, TIME_ID);
+    arrive(2000, RSV_ID);
+    arrive(3000, RSV_ID);
+    run_task();
+
+    /* the poll at 1 s is a 304, the one after the batch is fetched in full again */
+    CHECK(server.performs == 4);
+    CHECK(server.not_modified == 1);
+    CHECK(strcmp(server.urls[2], "batch/") == 0);
+    CHECK(uart_count == 4);
+    CHECK((uart[0].id == RSV_ID) && (uart[3].id == RSV_ID));
+    CHECK(strcmp(condArr[RSV_ID].etag, server.etag) == 0);
+    CHECK(requests_live == 0);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct
+    {
+        const char *name;
+        void (*run)(void);
+    } scenarios[] =
+    {
+        {"keep_alive", keep_alive},
+        {"server_closes", server_closes},
+        {"stale_connection", stale_connection},
+        {"batch", batch},
+        {"batch_skipped", batch_skipped},
+        {"batch_unsupported", batch_unsupported},
+        {"backoff_jitter", backoff_jitter},
+        {"batch_deadline", batch_deadline},
+        {"batch_validators", batch_validators},
+    };
+    size_t i = 0;
+
+    if ((argc > 1) && (strcmp(argv[1], "-v") == 0))
+    {
+        stub_log_enabled = 1;
+    }
+
+    startHttpConfig();
+    for (i = 0; i < (sizeof(scenarios) / sizeof(scenarios[0])); i++)
+    {
+        int before = failures;
+
+        scenarios[i].run();
+        printf("%-20s %s\n", scenarios[i].name, (failures == before) ? "ok" : "FAILED");
+    }
+    reset();
+
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
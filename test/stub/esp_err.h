@@ -0,0 +1,15 @@
+/* Stand-in for the ESP-IDF header of the same name, only what the host test needs. */
+#ifndef ESP_ERR_H_STUB
+#define ESP_ERR_H_STUB
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_ARG 0x102
+
+#define ESP_ERROR_CHECK(x) ((void)(x))
+
+const char *esp_err_to_name(esp_err_t code);
+
+#endif
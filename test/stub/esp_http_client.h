@@ -0,0 +1,76 @@
+/* Stand-in for the ESP-IDF header of the same name, the host test plays the server behind it. */
+#ifndef ESP_HTTP_CLIENT_H_STUB
+#define ESP_HTTP_CLIENT_H_STUB
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef struct esp_http_client *esp_http_client_handle_t;
+
+typedef enum
+{
+    HTTP_EVENT_ERROR,
+    HTTP_EVENT_ON_CONNECTED,
+    HTTP_EVENT_HEADERS_SENT,
+    HTTP_EVENT_ON_HEADER,
+    HTTP_EVENT_ON_DATA,
+    HTTP_EVENT_ON_FINISH,
+    HTTP_EVENT_DISCONNECTED,
+} esp_http_client_event_id_t;
+
+typedef struct esp_http_client_event
+{
+    esp_http_client_event_id_t event_id;
+    esp_http_client_handle_t client;
+    void *data;
+    int data_len;
+    void *user_data;
+    char *header_key;
+    char *header_value;
+} esp_http_client_event_t;
+
+typedef esp_http_client_event_t *esp_http_client_event_handle_t;
+
+typedef esp_err_t (*http_event_handle_cb)(esp_http_client_event_t *event);
+
+typedef enum
+{
+    HTTP_METHOD_GET,
+    HTTP_METHOD_POST,
+} esp_http_client_method_t;
+
+typedef struct
+{
+    const char *url;
+    esp_http_client_method_t method;
+    const char *cert_pem;
+    http_event_handle_cb event_handler;
+    int timeout_ms;
+    bool keep_alive_enable;
+} esp_http_client_config_t;
+
+#define ESP_ERR_HTTP_BASE (0x7000)
+#define ESP_ERR_HTTP_MAX_REDIRECT (ESP_ERR_HTTP_BASE + 1)
+#define ESP_ERR_HTTP_CONNECT (ESP_ERR_HTTP_BASE + 2)
+#define ESP_ERR_HTTP_WRITE_DATA (ESP_ERR_HTTP_BASE + 3)
+#define ESP_ERR_HTTP_FETCH_HEADER (ESP_ERR_HTTP_BASE + 4)
+#define ESP_ERR_HTTP_INVALID_TRANSPORT (ESP_ERR_HTTP_BASE + 5)
+#define ESP_ERR_HTTP_CONNECTING (ESP_ERR_HTTP_BASE + 6)
+#define ESP_ERR_HTTP_EAGAIN (ESP_ERR_HTTP_BASE + 7)
+#define ESP_ERR_HTTP_CONNECTION_CLOSED (ESP_ERR_HTTP_BASE + 8)
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config);
+esp_err_t esp_http_client_perform(esp_http_client_handle_t client);
+esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char *url);
+esp_err_t esp_http_client_set_post_field(esp_http_client_handle_t client, const char *data, int len);
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char *key, const char *value);
+esp_err_t esp_http_client_delete_header(esp_http_client_handle_t client, const char *key);
+esp_err_t esp_http_client_close(esp_http_client_handle_t client);
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client);
+int esp_http_client_get_status_code(esp_http_client_handle_t client);
+int64_t esp_http_client_get_content_length(esp_http_client_handle_t client);
+bool esp_http_client_is_chunked_response(esp_http_client_handle_t client);
+
+#endif
@@ -0,0 +1,15 @@
+/* Stand-in for the ESP-IDF header of the same name: logs go to stdout when stub_log_enabled is set (-v). */
+#ifndef ESP_LOG_H_STUB
+#define ESP_LOG_H_STUB
+
+#include <stdio.h>
+
+extern int stub_log_enabled;
+
+#define STUB_LOG(tag, format, ...) do { if (stub_log_enabled) { printf("%s: " format, tag, ##__VA_ARGS__); } } while (0)
+#define ESP_LOGE(tag, format, ...) STUB_LOG(tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) STUB_LOG(tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) STUB_LOG(tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) STUB_LOG(tag, format, ##__VA_ARGS__)
+
+#endif
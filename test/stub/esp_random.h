@@ -0,0 +1,9 @@
+/* Stand-in for the ESP-IDF header of the same name. */
+#ifndef ESP_RANDOM_H_STUB
+#define ESP_RANDOM_H_STUB
+
+#include <stdint.h>
+
+uint32_t esp_random(void);
+
+#endif
@@ -0,0 +1,23 @@
+/* Stand-in for the ESP-IDF header of the same name, time is simulated by the host test. */
+#ifndef ESP_TIMER_H_STUB
+#define ESP_TIMER_H_STUB
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef struct esp_timer *esp_timer_handle_t;
+
+typedef struct
+{
+    void (*callback)(void *arg);
+    void *arg;
+    const char *name;
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+esp_err_t esp_timer_restart(esp_timer_handle_t timer, uint64_t timeout_us);
+int64_t esp_timer_get_time(void);
+
+#endif
@@ -0,0 +1,17 @@
+/* Stand-in for the FreeRTOS header of the same name, only what the host test needs. */
+#ifndef FREERTOS_H_STUB
+#define FREERTOS_H_STUB
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define configTICK_RATE_HZ 100
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((TickType_t)(ms) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+#define pdTRUE 1
+#define pdFALSE 0
+
+#endif
@@ -0,0 +1,13 @@
+/* Stand-in for the FreeRTOS header of the same name. */
+#ifndef QUEUE_H_STUB
+#define QUEUE_H_STUB
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct queue_stub *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks_to_wait);
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait);
+
+#endif
@@ -0,0 +1,13 @@
+/* Stand-in for the FreeRTOS header of the same name. */
+#ifndef SEMPHR_H_STUB
+#define SEMPHR_H_STUB
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct semaphore_stub *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+
+#endif
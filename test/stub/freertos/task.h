@@ -0,0 +1,15 @@
+/* Stand-in for the FreeRTOS header of the same name. */
+#ifndef TASK_H_STUB
+#define TASK_H_STUB
+
+#include "freertos/FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *parameters);
+typedef void *TaskHandle_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stack_depth, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *created_task, BaseType_t core_id);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+
+#endif
@@ -0,0 +1 @@
+/* Stand-in for the generated ESP-IDF header, nothing in it is used by the host test. */